@@ -0,0 +1,273 @@
+#include "Agents.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Benchmark.h"
+#include "Jobs.h"
+#include "GpuMemory.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define AGENTS_SSE 1
+#endif
+
+using namespace std;
+
+namespace
+{
+	// Coloca u no intervalo [0, length) - a curva é percorrida em laço
+	inline float wrapParam(float u, float length)
+	{
+		return u - length * floor(u / length);
+	}
+
+	// Matriz T * Ry * S do agente i, com a mesma convenção de ângulo do móvel original:
+	// ângulo = atan2(dy, dx) - 90 graus, rotação em torno de Y
+	void evaluateAgentScalar(AgentGroup& group, float timeOffset, size_t i, float* out)
+	{
+		float distance = wrapParam(group.param[i] + group.speed[i] * timeOffset, group.path.length());
+		float t = arcLengthToParameter(group.path, distance, group.segmentHint[i]);
+		const float* c = &group.path.coeffs[(size_t)group.segmentHint[i] * CUBIC_SEGMENT_FLOATS];
+
+		float p[3], d[3];
+		for (int k = 0; k < 3; k++)
+		{
+			p[k] = ((c[k] * t + c[3 + k]) * t + c[6 + k]) * t + c[9 + k];
+			d[k] = (3.0f * c[k] * t + 2.0f * c[3 + k]) * t + c[6 + k];
+		}
+
+		// cos(atan2(dy, dx) - 90) = dy / len e sin(atan2(dy, dx) - 90) = -dx / len
+		float len2 = d[0] * d[0] + d[1] * d[1];
+		float cosA = 1.0f, sinA = 0.0f;
+		if (len2 > 1e-12f)
+		{
+			float invLen = 1.0f / sqrt(len2);
+			cosA = d[1] * invLen;
+			sinA = -d[0] * invLen;
+		}
+
+		float s = group.scale[i];
+		out[0] = s * cosA;  out[1] = 0.0f; out[2] = -s * sinA; out[3] = 0.0f;
+		out[4] = 0.0f;      out[5] = s;    out[6] = 0.0f;      out[7] = 0.0f;
+		out[8] = s * sinA;  out[9] = 0.0f; out[10] = s * cosA; out[11] = 0.0f;
+		out[12] = p[0] + group.offsetX[i];
+		out[13] = p[1] + group.offsetY[i];
+		out[14] = p[2] + group.offsetZ[i];
+		out[15] = 1.0f;
+	}
+
+#ifdef AGENTS_SSE
+	inline __m128 floor4(__m128 x)
+	{
+		__m128 trunc = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+		return _mm_sub_ps(trunc, _mm_and_ps(_mm_cmpgt_ps(trunc, x), _mm_set1_ps(1.0f)));
+	}
+#endif
+}
+
+void setAgentCurve(AgentGroup& group, const Curve& curve, int stride)
+{
+	if (curve.arcLength.segments > 0)
+		group.path = curve.arcLength;
+	else
+		buildArcLengthTable(curve, stride, group.path);
+	fill(group.segmentHint.begin(), group.segmentHint.end(), -1);
+}
+
+void addAgent(AgentGroup& group, float speed, float phase, const glm::vec3& offset, float scale)
+{
+	float length = group.path.length();
+	group.param.push_back(length > 0.0f ? wrapParam(phase, length) : 0.0f);
+	group.segmentHint.push_back(-1);
+	group.speed.push_back(speed);
+	group.offsetX.push_back(offset.x);
+	group.offsetY.push_back(offset.y);
+	group.offsetZ.push_back(offset.z);
+	group.scale.push_back(scale);
+}
+
+void updateAgents(AgentGroup& group, float dt)
+{
+	// Laço simples sobre SoA: o compilador vetoriza
+	const float length = group.path.length();
+	float* param = group.param.data();
+	const float* speed = group.speed.data();
+	const size_t n = group.size();
+	for (size_t i = 0; i < n; i++)
+	{
+		float u = param[i] + speed[i] * dt;
+		if (u >= length) u -= length;
+		else if (u < 0.0f) u += length;
+		param[i] = u;
+	}
+}
+
+void evaluateAgents(AgentGroup& group, float timeOffset, float* matrices, size_t begin, size_t end)
+{
+	if (group.path.segments == 0) return;
+
+	size_t i = begin;
+#ifdef AGENTS_SSE
+	const __m128 length = _mm_set1_ps(group.path.length());
+	const __m128 rcpLength = _mm_set1_ps(1.0f / group.path.length());
+	const __m128 offset = _mm_set1_ps(timeOffset);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 two = _mm_set1_ps(2.0f);
+	const __m128 three = _mm_set1_ps(3.0f);
+	const float* coeffs = group.path.coeffs.data();
+	int* hint = group.segmentHint.data();
+
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 u = _mm_add_ps(_mm_loadu_ps(&group.param[i]), _mm_mul_ps(_mm_loadu_ps(&group.speed[i]), offset));
+		u = _mm_sub_ps(u, _mm_mul_ps(length, floor4(_mm_mul_ps(u, rcpLength))));
+
+		// Distância -> (segmento, t) pela tabela, um agente por vez; a dica torna a busca O(1) em regime.
+		// O passo de Newton fica para depois, nos 4 agentes de uma vez
+		alignas(16) float distance[4], param[4], sampleT[4], sampleLength[4];
+		_mm_store_ps(distance, u);
+		int seg[4];
+		for (int k = 0; k < 4; k++)
+		{
+			param[k] = arcLengthLookup(group.path, distance[k], hint[i + k], sampleT[k], sampleLength[k]);
+			seg[k] = hint[i + k];
+		}
+		__m128 t = _mm_load_ps(param);
+
+		// Busca os 12 coeficientes de cada agente e transpõe para SoA
+		const float* c0 = coeffs + seg[0] * CUBIC_SEGMENT_FLOATS;
+		const float* c1 = coeffs + seg[1] * CUBIC_SEGMENT_FLOATS;
+		const float* c2 = coeffs + seg[2] * CUBIC_SEGMENT_FLOATS;
+		const float* c3 = coeffs + seg[3] * CUBIC_SEGMENT_FLOATS;
+		__m128 ax = _mm_loadu_ps(c0), ay = _mm_loadu_ps(c1), az = _mm_loadu_ps(c2), bx = _mm_loadu_ps(c3);
+		_MM_TRANSPOSE4_PS(ax, ay, az, bx);
+		__m128 by = _mm_loadu_ps(c0 + 4), bz = _mm_loadu_ps(c1 + 4), cx = _mm_loadu_ps(c2 + 4), cy = _mm_loadu_ps(c3 + 4);
+		_MM_TRANSPOSE4_PS(by, bz, cx, cy);
+		__m128 cz = _mm_loadu_ps(c0 + 8), dx = _mm_loadu_ps(c1 + 8), dy = _mm_loadu_ps(c2 + 8), dz = _mm_loadu_ps(c3 + 8);
+		_MM_TRANSPOSE4_PS(cz, dx, dy, dz);
+
+		// Newton em L(t) - distance como em arcLengthToParameter: L(t) - L(t0) por Simpson, L'(t) = |P'(t)|
+		auto speed4 = [&](__m128 t)
+		{
+			__m128 vx = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(three, ax), t), _mm_mul_ps(two, bx)), t), cx);
+			__m128 vy = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(three, ay), t), _mm_mul_ps(two, by)), t), cy);
+			__m128 vz = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(three, az), t), _mm_mul_ps(two, bz)), t), cz);
+			return _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz)));
+		};
+		__m128 t0 = _mm_load_ps(sampleT);
+		__m128 v = speed4(t);
+		__m128 simpson = _mm_add_ps(_mm_add_ps(speed4(t0), v), _mm_mul_ps(_mm_set1_ps(4.0f), speed4(_mm_mul_ps(_mm_set1_ps(0.5f), _mm_add_ps(t0, t)))));
+		__m128 L = _mm_add_ps(_mm_load_ps(sampleLength), _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(t, t0), _mm_set1_ps(1.0f / 6.0f)), simpson));
+		__m128 moving = _mm_cmpgt_ps(v, _mm_set1_ps(1e-6f));
+		__m128 step = _mm_and_ps(moving, _mm_div_ps(_mm_sub_ps(L, u), _mm_max_ps(v, _mm_set1_ps(1e-6f))));
+		t = _mm_min_ps(_mm_max_ps(_mm_sub_ps(t, step), t0), _mm_add_ps(t0, _mm_set1_ps(1.0f / ARC_LENGTH_SAMPLES)));
+
+		// Posição por Horner e derivada em x e y para a direção
+		__m128 px = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(ax, t), bx), t), cx), t), dx);
+		__m128 py = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(ay, t), by), t), cy), t), dy);
+		__m128 pz = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(az, t), bz), t), cz), t), dz);
+		__m128 tx = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(three, ax), t), _mm_mul_ps(two, bx)), t), cx);
+		__m128 ty = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(three, ay), t), _mm_mul_ps(two, by)), t), cy);
+
+		__m128 len2 = _mm_add_ps(_mm_mul_ps(tx, tx), _mm_mul_ps(ty, ty));
+		__m128 valid = _mm_cmpgt_ps(len2, _mm_set1_ps(1e-12f));
+		__m128 invLen = _mm_div_ps(one, _mm_sqrt_ps(_mm_max_ps(len2, _mm_set1_ps(1e-12f))));
+		__m128 cosA = _mm_or_ps(_mm_and_ps(valid, _mm_mul_ps(ty, invLen)), _mm_andnot_ps(valid, one));
+		__m128 sinA = _mm_and_ps(valid, _mm_sub_ps(zero, _mm_mul_ps(tx, invLen)));
+
+		__m128 s = _mm_loadu_ps(&group.scale[i]);
+		__m128 m00 = _mm_mul_ps(s, cosA);
+		__m128 m20 = _mm_mul_ps(s, sinA);
+		__m128 m02 = _mm_sub_ps(zero, m20);
+
+		// Cada coluna em SoA vira, após a transposição, a coluna de cada um dos 4 agentes
+		__m128 col0a = m00, col0b = zero, col0c = m02, col0d = zero;
+		_MM_TRANSPOSE4_PS(col0a, col0b, col0c, col0d);
+		__m128 col1a = zero, col1b = s, col1c = zero, col1d = zero;
+		_MM_TRANSPOSE4_PS(col1a, col1b, col1c, col1d);
+		__m128 col2a = m20, col2b = zero, col2c = m00, col2d = zero;
+		_MM_TRANSPOSE4_PS(col2a, col2b, col2c, col2d);
+		__m128 col3a = _mm_add_ps(px, _mm_loadu_ps(&group.offsetX[i]));
+		__m128 col3b = _mm_add_ps(py, _mm_loadu_ps(&group.offsetY[i]));
+		__m128 col3c = _mm_add_ps(pz, _mm_loadu_ps(&group.offsetZ[i]));
+		__m128 col3d = one;
+		_MM_TRANSPOSE4_PS(col3a, col3b, col3c, col3d);
+
+		float* out = matrices + i * 16;
+		_mm_storeu_ps(out + 0, col0a);  _mm_storeu_ps(out + 4, col1a);  _mm_storeu_ps(out + 8, col2a);  _mm_storeu_ps(out + 12, col3a);
+		_mm_storeu_ps(out + 16, col0b); _mm_storeu_ps(out + 20, col1b); _mm_storeu_ps(out + 24, col2b); _mm_storeu_ps(out + 28, col3b);
+		_mm_storeu_ps(out + 32, col0c); _mm_storeu_ps(out + 36, col1c); _mm_storeu_ps(out + 40, col2c); _mm_storeu_ps(out + 44, col3c);
+		_mm_storeu_ps(out + 48, col0d); _mm_storeu_ps(out + 52, col1d); _mm_storeu_ps(out + 56, col2d); _mm_storeu_ps(out + 60, col3d);
+	}
+#endif
+
+	// Resto do lote (ou tudo, sem SSE)
+	for (; i < end; i++)
+		evaluateAgentScalar(group, timeOffset, i, matrices + i * 16);
+}
+
+void setupAgentInstancing(AgentGroup& group)
+{
+	glGenBuffers(1, &group.instanceVBO);
+
+	glBindVertexArray(group.VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, group.instanceVBO);
+	glBufferData(GL_ARRAY_BUFFER, group.size() * 16 * sizeof(GLfloat), NULL, GL_STREAM_DRAW);
+	gpuTrack(GPU_INSTANCES, group.instanceVBO, "matrizes dos agentes", group.size() * 16 * sizeof(GLfloat));
+
+	// Atributo matriz de modelo por instância - uma coluna (vec4) por localização
+	for (int k = 0; k < 4; k++)
+	{
+		glVertexAttribPointer(4 + k, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(GLfloat), (GLvoid*)(k * 4 * sizeof(GLfloat)));
+		glEnableVertexAttribArray(4 + k);
+		glVertexAttribDivisor(4 + k, 1);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+}
+
+void uploadAgentMatrices(AgentGroup& group, float timeOffset)
+{
+	if (group.size() == 0) return;
+
+	GLsizeiptr bytes = group.size() * 16 * sizeof(GLfloat);
+	glBindBuffer(GL_ARRAY_BUFFER, group.instanceVBO);
+
+	// Descarta o conteúdo anterior (orphaning) para não esperar a GPU terminar o quadro passado
+	glBufferData(GL_ARRAY_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+	float* matrices = (float*)glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	vector<float> staging;
+	if (!matrices)
+	{
+		staging.resize(group.size() * 16);
+		matrices = staging.data();
+	}
+
+	// Blocos múltiplos de 4 para manter os lotes SSE inteiros; as threads escrevem direto no buffer mapeado
+	parallelFor(group.size(), AGENT_BATCH, [&](size_t begin, size_t end)
+	{
+		evaluateAgents(group, timeOffset, matrices, begin, end);
+	}, "agentes");
+
+	if (staging.empty())
+	{
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+	}
+	else
+	{
+		glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, staging.data());
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void drawAgents(const AgentGroup& group)
+{
+	if (group.size() == 0) return;
+
+	glBindVertexArray(group.VAO);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, group.nVertices, (GLsizei)group.size());
+	countDraw(group.nVertices, (int)group.size());
+}
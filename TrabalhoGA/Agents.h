@@ -0,0 +1,66 @@
+// Sistema de agentes que seguem curvas
+//
+// Cada grupo de agentes segue uma curva (Catmull-Rom ou Bézier por partes) e usa uma malha.
+// A posição é a distância percorrida, convertida em (segmento, t) pela tabela de comprimento de
+// arco, então a velocidade em unidades por segundo é a mesma em toda a curva.
+// Os agentes ficam em SoA; posição e direção são avaliadas em lotes de 4 com SSE, divididas
+// entre as threads do sistema de jobs, e as matrizes de modelo são escritas direto no buffer
+// de instâncias mapeado.
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+//GLAD
+#include <glad/glad.h>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Curve.h"
+
+// Agentes avaliados por job (múltiplo de 4)
+const size_t AGENT_BATCH = 4096;
+
+struct AgentGroup
+{
+	// Curva seguida, com a tabela de comprimento de arco (coeficientes na base de potências)
+	ArcLengthTable path;
+
+	// Estado dos agentes (SoA)
+	std::vector<float> param;      // Distância percorrida na curva [0, comprimento)
+	std::vector<float> speed;      // Unidades por segundo
+	std::vector<int> segmentHint;  // Último segmento encontrado na tabela (dica para a próxima busca)
+	std::vector<float> offsetX, offsetY, offsetZ; // Deslocamento em relação à curva
+	std::vector<float> scale;
+
+	// Renderização instanciada
+	GLuint VAO = 0;
+	int texture = -1; // Handle no TextureCache
+	GLuint meshVBO = 0; // Buffer de vértices da malha (do VAO), marcado como usado a cada desenho
+	GLuint instanceVBO = 0;
+	int nVertices = 0;
+
+	size_t size() const { return param.size(); }
+};
+
+// stride = 1 para Catmull-Rom (segmentos sobrepostos) e 3 para Bézier por partes.
+// Usa curve.arcLength se já foi construída; phase em addAgent é uma distância
+void setAgentCurve(AgentGroup& group, const Curve& curve, int stride);
+void addAgent(AgentGroup& group, float speed, float phase, const glm::vec3& offset, float scale);
+
+// Avança a simulação de todos os agentes do grupo (passo fixo)
+void updateAgents(AgentGroup& group, float dt);
+
+// Escreve uma mat4 (16 floats, por coluna) por agente no intervalo [begin, end), avaliando
+// a curva em param + speed * timeOffset (timeOffset negativo interpola com o passo anterior).
+// Atualiza só as dicas de segmento do intervalo, então lotes disjuntos podem rodar em paralelo
+void evaluateAgents(AgentGroup& group, float timeOffset, float* matrices, size_t begin, size_t end);
+
+// Cria o buffer de instâncias e liga as colunas da matriz aos atributos 4-7 do VAO da malha
+void setupAgentInstancing(AgentGroup& group);
+
+// Avalia todos os agentes direto no buffer de instâncias e desenha o grupo
+void uploadAgentMatrices(AgentGroup& group, float timeOffset);
+void drawAgents(const AgentGroup& group);
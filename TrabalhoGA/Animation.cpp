@@ -0,0 +1,532 @@
+#include "Animation.h"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <json.hpp>
+
+#include "Jobs.h"
+
+using namespace std;
+using json = nlohmann::json;
+
+namespace
+{
+	// Trilhas amostradas por job
+	const size_t ANIMATION_GRAIN = 2048;
+	// Passos lineares a partir do cursor antes de desistir e fazer a busca binária
+	const int CURSOR_STEPS = 4;
+
+	double elapsedMs(chrono::high_resolution_clock::time_point start)
+	{
+		return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+	}
+
+	// Tangentes da Catmull-Rom com tempos não uniformes: diferença centrada nas chaves internas,
+	// unilateral nas pontas
+	float keyTangent(const float* times, const float* values, int n, int w, int k, int c)
+	{
+		int a = max(k - 1, 0), b = min(k + 1, n - 1);
+		return (values[b * w + c] - values[a * w + c]) / (times[b] - times[a]);
+	}
+
+	// Logaritmo e exponencial de quatérnios unitários (só a parte vetorial)
+	glm::vec3 quatLog(const glm::quat& q)
+	{
+		float angle = acos(glm::clamp(q.w, -1.0f, 1.0f));
+		float s = sin(angle);
+		glm::vec3 v(q.x, q.y, q.z);
+		return s > 1e-6f ? v * (angle / s) : v;
+	}
+
+	glm::quat quatExp(const glm::vec3& v)
+	{
+		float angle = glm::length(v);
+		float s = angle > 1e-6f ? sin(angle) / angle : 1.0f;
+		return glm::quat(cos(angle), v * s);
+	}
+
+	// Slerp pelo menor arco, como o glm::slerp: as chaves já estão no mesmo hemisfério na construção,
+	// mas os controles s0 e s1 do squad (e o par externo) podem não estar
+	inline glm::vec4 slerp4(const glm::vec4& a, glm::vec4 b, float u)
+	{
+		float d = glm::dot(a, b);
+		if (d < 0.0f)
+		{
+			b = -b;
+			d = -d;
+		}
+		if (d > 0.9995f) return glm::normalize(a + (b - a) * u);
+		float angle = acos(max(d, -1.0f));
+		float invSin = 1.0f / sin(angle);
+		return (a * sin((1.0f - u) * angle) + b * sin(u * angle)) * invSin;
+	}
+
+	// Trecho k e fração u do tempo t nas n chaves; cursor é a dica do quadro anterior
+	inline int locateKey(const float* times, int n, float t, int& cursor, float& u)
+	{
+		if (n == 1 || t <= times[0]) { u = 0.0f; cursor = 0; return 0; }
+		if (t >= times[n - 1]) { u = 1.0f; cursor = n - 2; return n - 2; }
+
+		int k = cursor;
+		bool found = false;
+		if (k <= n - 2 && t >= times[k])
+		{
+			for (int step = 0; step < CURSOR_STEPS; step++)
+			{
+				if (t < times[k + 1]) { found = true; break; }
+				k++;
+			}
+		}
+		if (!found)
+			k = (int)(upper_bound(times, times + n, t) - times) - 1;
+
+		cursor = k;
+		u = (t - times[k]) / (times[k + 1] - times[k]);
+		return k;
+	}
+
+	AnimationChannel parseChannel(const string& name)
+	{
+		if (name == "translation") return ANIM_TRANSLATION;
+		if (name == "rotation") return ANIM_ROTATION;
+		if (name == "scale") return ANIM_SCALE;
+		if (name == "ka") return ANIM_KA;
+		if (name == "kd") return ANIM_KD;
+		if (name == "ks") return ANIM_KS;
+		if (name == "q") return ANIM_SHININESS;
+		return ANIM_CHANNEL_COUNT;
+	}
+
+	AnimationInterpolation parseInterpolation(const string& name)
+	{
+		if (name == "linear" || name == "slerp") return ANIM_LINEAR;
+		if (name == "bezier") return ANIM_BEZIER;
+		return ANIM_CATMULL_ROM; // "catmullRom" e "squad"
+	}
+
+	// Um valor da chave: número nos canais escalares, [x, y, z] na translação e, na rotação,
+	// ângulos de Euler em graus (mesma ordem de objectModel: X, depois Y, depois Z) ou [x, y, z, w]
+	bool readKeyValue(const json& item, AnimationChannel channel, float* out)
+	{
+		if (channel == ANIM_ROTATION)
+		{
+			if (!item.is_array() || (item.size() != 3 && item.size() != 4)) return false;
+			glm::quat q;
+			if (item.size() == 4)
+				q = glm::normalize(glm::quat((float)item[3], (float)item[0], (float)item[1], (float)item[2]));
+			else
+				q = glm::angleAxis(glm::radians((float)item[0]), glm::vec3(1.0f, 0.0f, 0.0f)) *
+					glm::angleAxis(glm::radians((float)item[1]), glm::vec3(0.0f, 1.0f, 0.0f)) *
+					glm::angleAxis(glm::radians((float)item[2]), glm::vec3(0.0f, 0.0f, 1.0f));
+			out[0] = q.x; out[1] = q.y; out[2] = q.z; out[3] = q.w;
+			return true;
+		}
+
+		int w = animationChannelWidth(channel);
+		if (w == 1 && item.is_number()) { out[0] = item; return true; }
+		if (!item.is_array() || (int)item.size() != w) return false;
+		for (int c = 0; c < w; c++) out[c] = item[c];
+		return true;
+	}
+}
+
+int animationChannelWidth(AnimationChannel channel)
+{
+	if (channel == ANIM_TRANSLATION) return 3;
+	if (channel == ANIM_ROTATION) return 4;
+	return 1;
+}
+
+int addAnimationClip(AnimationSet& set, const string& name, bool loop, float speed)
+{
+	AnimationClip clip;
+	clip.name = name;
+	clip.loop = loop;
+	clip.speed = speed;
+	clip.trackFirst = clip.trackEnd = (int)set.size();
+	set.clips.push_back(clip);
+	return (int)set.clips.size() - 1;
+}
+
+int addAnimationTrack(AnimationSet& set, int target, AnimationChannel channel, AnimationInterpolation interpolation,
+	const float* times, const float* values, int keyCount, const float* handles)
+{
+	if (keyCount < 1) return -1;
+	for (int k = 1; k < keyCount; k++)
+		if (!(times[k] > times[k - 1])) return -1;
+
+	if (set.clips.empty()) addAnimationClip(set, "default");
+	AnimationClip& clip = set.clips.back();
+
+	int w = animationChannelWidth(channel);
+	int segments = max(keyCount - 1, 1);
+
+	set.clip.push_back((int)set.clips.size() - 1);
+	set.target.push_back(target);
+	set.channel.push_back((unsigned char)channel);
+	set.keyFirst.push_back((int)set.times.size());
+	set.keyCount.push_back(keyCount);
+	set.dataFirst.push_back((int)set.data.size());
+	set.outFirst.push_back((int)set.output.size());
+	set.cursor.push_back(0);
+
+	set.times.insert(set.times.end(), times, times + keyCount);
+	set.output.resize(set.output.size() + w, 0.0f);
+	size_t base = set.data.size();
+
+	if (channel == ANIM_ROTATION)
+	{
+		// Chaves no mesmo hemisfério da anterior, para o slerp seguir o menor arco
+		vector<glm::quat> q(keyCount);
+		for (int k = 0; k < keyCount; k++)
+		{
+			q[k] = glm::normalize(glm::quat(values[k * 4 + 3], values[k * 4], values[k * 4 + 1], values[k * 4 + 2]));
+			if (k > 0 && glm::dot(q[k], q[k - 1]) < 0.0f) q[k] = -q[k];
+		}
+
+		// Quatérnios de controle do squad: s_i = q_i exp(-(log(q_i^-1 q_i+1) + log(q_i^-1 q_i-1)) / 4).
+		// No slerp eles são as próprias chaves, e o squad se reduz ao slerp
+		vector<glm::quat> s(q);
+		if (interpolation != ANIM_LINEAR)
+			for (int k = 1; k < keyCount - 1; k++)
+			{
+				glm::quat inv = glm::conjugate(q[k]);
+				s[k] = glm::normalize(q[k] * quatExp(-0.25f * (quatLog(inv * q[k + 1]) + quatLog(inv * q[k - 1]))));
+			}
+
+		set.data.resize(base + (size_t)segments * 16);
+		for (int k = 0; k < segments; k++)
+		{
+			int next = min(k + 1, keyCount - 1);
+			const glm::quat* parts[4] = { &q[k], &s[k], &s[next], &q[next] };
+			float* out = &set.data[base + (size_t)k * 16];
+			for (int p = 0; p < 4; p++)
+			{
+				out[p * 4] = parts[p]->x; out[p * 4 + 1] = parts[p]->y;
+				out[p * 4 + 2] = parts[p]->z; out[p * 4 + 3] = parts[p]->w;
+			}
+		}
+	}
+	else
+	{
+		set.data.resize(base + (size_t)segments * 4 * w, 0.0f);
+		for (int k = 0; k < segments; k++)
+		{
+			float* out = &set.data[base + (size_t)k * 4 * w];
+			for (int c = 0; c < w; c++)
+			{
+				float p0 = values[k * w + c];
+				if (keyCount == 1) { out[3 * w + c] = p0; continue; }
+
+				float p1 = values[(k + 1) * w + c];
+				float h = times[k + 1] - times[k];
+				if (interpolation == ANIM_LINEAR)
+				{
+					out[2 * w + c] = p1 - p0;
+					out[3 * w + c] = p0;
+					continue;
+				}
+
+				// Pontos de controle de Bézier do trecho: alças dadas ou as da Catmull-Rom (p +- h m / 3)
+				float c0, c1;
+				if (interpolation == ANIM_BEZIER && handles)
+				{
+					c0 = handles[(2 * k + 1) * w + c];
+					c1 = handles[(2 * k + 2) * w + c];
+				}
+				else
+				{
+					c0 = p0 + h * keyTangent(times, values, keyCount, w, k, c) / 3.0f;
+					c1 = p1 - h * keyTangent(times, values, keyCount, w, k + 1, c) / 3.0f;
+				}
+				out[c] = -p0 + 3.0f * c0 - 3.0f * c1 + p1;
+				out[w + c] = 3.0f * p0 - 6.0f * c0 + 3.0f * c1;
+				out[2 * w + c] = 3.0f * (c0 - p0);
+				out[3 * w + c] = p0;
+			}
+		}
+	}
+
+	clip.trackEnd = (int)set.size();
+	clip.duration = max(clip.duration, times[keyCount - 1]);
+	return (int)set.size() - 1;
+}
+
+void loadAnimationConfig(const string& configFile, AnimationSet& set, int objectCount)
+{
+	ifstream file(configFile);
+	if (!file.is_open()) return;
+
+	json jsonData;
+	file >> jsonData;
+	if (!jsonData.contains("animations")) return;
+
+	for (const auto& item : jsonData["animations"])
+	{
+		string name = item.contains("name") ? (string)item["name"] : "clipe" + to_string(set.clips.size());
+		bool loop = item.contains("loop") ? (bool)item["loop"] : true;
+		float speed = item.contains("speed") ? (float)item["speed"] : 1.0f;
+		int clip = addAnimationClip(set, name, loop, speed);
+		if (item.contains("playing")) set.clips[clip].playing = item["playing"];
+
+		if (!item.contains("tracks")) continue;
+		for (const auto& track : item["tracks"])
+		{
+			int target = track.contains("object") ? (int)track["object"] : -1;
+			AnimationChannel channel = track.contains("channel") ? parseChannel(track["channel"]) : ANIM_CHANNEL_COUNT;
+			AnimationInterpolation interpolation = track.contains("interpolation") ? parseInterpolation(track["interpolation"]) : ANIM_CATMULL_ROM;
+			if (target < 0 || target >= objectCount || channel == ANIM_CHANNEL_COUNT)
+			{
+				cout << "Animacao " << name << ": trilha com objeto ou canal invalido ignorada" << endl;
+				continue;
+			}
+			if (!track.contains("times") || !track.contains("values") || track["times"].size() != track["values"].size())
+			{
+				cout << "Animacao " << name << ": trilha sem o mesmo nro de tempos e valores ignorada" << endl;
+				continue;
+			}
+
+			int w = animationChannelWidth(channel);
+			int keyCount = (int)track["times"].size();
+			vector<float> times(keyCount), values((size_t)keyCount * w), handles;
+			bool ok = true;
+			for (int k = 0; k < keyCount; k++)
+			{
+				times[k] = track["times"][k];
+				ok = ok && readKeyValue(track["values"][k], channel, &values[(size_t)k * w]);
+			}
+
+			// Bézier: "handles" com alça de entrada e de saída por chave, no formato dos valores
+			if (ok && interpolation == ANIM_BEZIER && channel != ANIM_ROTATION && track.contains("handles"))
+			{
+				if ((int)track["handles"].size() == 2 * keyCount)
+				{
+					handles.resize((size_t)2 * keyCount * w);
+					for (int h = 0; h < 2 * keyCount; h++)
+						ok = ok && readKeyValue(track["handles"][h], channel, &handles[(size_t)h * w]);
+				}
+				else ok = false;
+			}
+
+			if (!ok || addAnimationTrack(set, target, channel, interpolation, times.data(), values.data(), keyCount,
+				handles.empty() ? nullptr : handles.data()) < 0)
+				cout << "Animacao " << name << ": chaves invalidas (tempos devem ser crescentes)" << endl;
+		}
+	}
+}
+
+void advanceAnimations(AnimationSet& set, float dt)
+{
+	for (AnimationClip& clip : set.clips)
+	{
+		if (!clip.playing) continue;
+		clip.time += dt * clip.speed;
+		if (clip.loop && clip.duration > 0.0f)
+			clip.time -= clip.duration * floor(clip.time / clip.duration);
+		else
+			clip.time = glm::clamp(clip.time, 0.0f, clip.duration);
+	}
+}
+
+void sampleAnimationTracks(AnimationSet& set, size_t begin, size_t end)
+{
+	const float* times = set.times.data();
+	const float* data = set.data.data();
+	float* output = set.output.data();
+
+	for (size_t i = begin; i < end; i++)
+	{
+		const AnimationClip& clip = set.clips[set.clip[i]];
+		if (!clip.playing) continue;
+
+		float u;
+		int k = locateKey(times + set.keyFirst[i], set.keyCount[i], clip.time, set.cursor[i], u);
+		float* out = output + set.outFirst[i];
+
+		if (set.channel[i] == ANIM_ROTATION)
+		{
+			// squad(q0, q1, s0, s1, u) = slerp(slerp(q0, q1, u), slerp(s0, s1, u), 2u(1 - u))
+			const float* c = data + set.dataFirst[i] + (size_t)k * 16;
+			glm::vec4 q0(c[0], c[1], c[2], c[3]), s0(c[4], c[5], c[6], c[7]);
+			glm::vec4 s1(c[8], c[9], c[10], c[11]), q1(c[12], c[13], c[14], c[15]);
+			glm::vec4 q = slerp4(q0, q1, u);
+			if (s0 != q0 || s1 != q1)
+				q = slerp4(q, slerp4(s0, s1, u), 2.0f * u * (1.0f - u));
+			out[0] = q.x; out[1] = q.y; out[2] = q.z; out[3] = q.w;
+		}
+		else if (set.channel[i] == ANIM_TRANSLATION)
+		{
+			const float* c = data + set.dataFirst[i] + (size_t)k * 12;
+			for (int j = 0; j < 3; j++)
+				out[j] = ((c[j] * u + c[3 + j]) * u + c[6 + j]) * u + c[9 + j];
+		}
+		else
+		{
+			const float* c = data + set.dataFirst[i] + (size_t)k * 4;
+			out[0] = ((c[0] * u + c[1]) * u + c[2]) * u + c[3];
+		}
+	}
+}
+
+void sampleAnimations(AnimationSet& set)
+{
+	parallelFor(set.size(), ANIMATION_GRAIN, [&](size_t begin, size_t end)
+	{
+		sampleAnimationTracks(set, begin, end);
+	}, "animacoes");
+}
+
+void benchmarkAnimation()
+{
+	cout << fixed << setprecision(3);
+	cout << "==== Trilhas de animacao ====" << endl;
+
+	// Referência: uma trilha por objeto com o vetor das suas chaves (AoS), busca binária a cada
+	// amostra e tangentes/controles calculados na hora, como num sistema de animação ingênuo
+	struct NaiveKey { float time; glm::vec4 value; glm::vec4 in, out; };
+	struct NaiveTrack { AnimationChannel channel; AnimationInterpolation interpolation; vector<NaiveKey> keys; };
+
+	auto naiveSample = [](const NaiveTrack& track, float t) -> glm::vec4
+	{
+		const vector<NaiveKey>& keys = track.keys;
+		int n = (int)keys.size();
+		if (t <= keys[0].time) return keys[0].value;
+		if (t >= keys[n - 1].time) return keys[n - 1].value;
+		int k = (int)(upper_bound(keys.begin(), keys.end(), t, [](float v, const NaiveKey& key) { return v < key.time; }) - keys.begin()) - 1;
+		float h = keys[k + 1].time - keys[k].time;
+		float u = (t - keys[k].time) / h;
+
+		if (track.channel == ANIM_ROTATION)
+		{
+			auto toQuat = [](const glm::vec4& v) { return glm::quat(v.w, v.x, v.y, v.z); };
+			auto control = [&](int i)
+			{
+				glm::quat q = toQuat(keys[i].value);
+				if (track.interpolation == ANIM_LINEAR || i == 0 || i == n - 1) return q;
+				glm::quat inv = glm::conjugate(q);
+				return glm::normalize(q * quatExp(-0.25f * (quatLog(inv * toQuat(keys[i + 1].value)) + quatLog(inv * toQuat(keys[i - 1].value)))));
+			};
+			glm::quat q0 = toQuat(keys[k].value), q1 = toQuat(keys[k + 1].value);
+			glm::quat q = glm::slerp(q0, q1, u);
+			if (track.interpolation != ANIM_LINEAR)
+				q = glm::slerp(q, glm::slerp(control(k), control(k + 1), u), 2.0f * u * (1.0f - u));
+			return glm::vec4(q.x, q.y, q.z, q.w);
+		}
+
+		glm::vec4 p0 = keys[k].value, p1 = keys[k + 1].value;
+		if (track.interpolation == ANIM_LINEAR) return p0 + (p1 - p0) * u;
+		glm::vec4 c0, c1;
+		if (track.interpolation == ANIM_BEZIER) { c0 = keys[k].out; c1 = keys[k + 1].in; }
+		else
+		{
+			auto tangent = [&](int i) { int a = max(i - 1, 0), b = min(i + 1, n - 1); return (keys[b].value - keys[a].value) / (keys[b].time - keys[a].time); };
+			c0 = p0 + h * tangent(k) / 3.0f;
+			c1 = p1 - h * tangent(k + 1) / 3.0f;
+		}
+		float v = 1.0f - u;
+		return v * v * v * p0 + 3.0f * v * v * u * c0 + 3.0f * v * u * u * c1 + u * u * u * p1;
+	};
+
+	int objectCounts[] = { 2500, 25000 };
+	for (int objects : objectCounts)
+	{
+		// Por objeto: translação Catmull-Rom, rotação squad, escala Bézier e ka linear, 8 a 24 chaves
+		AnimationSet set;
+		addAnimationClip(set, "benchmark");
+		vector<NaiveTrack> naive;
+		unsigned state = 777u;
+		auto next = [&state]() { state = state * 1664525u + 1013904223u; return (state >> 8) * (1.0f / 16777216.0f); };
+
+		const AnimationChannel channels[] = { ANIM_TRANSLATION, ANIM_ROTATION, ANIM_SCALE, ANIM_KA };
+		const AnimationInterpolation interpolations[] = { ANIM_CATMULL_ROM, ANIM_CATMULL_ROM, ANIM_BEZIER, ANIM_LINEAR };
+		for (int o = 0; o < objects; o++)
+			for (int c = 0; c < 4; c++)
+			{
+				int w = animationChannelWidth(channels[c]);
+				int keyCount = 8 + (int)(next() * 16.0f);
+				vector<float> times(keyCount), values((size_t)keyCount * w), handles((size_t)2 * keyCount * w);
+				NaiveTrack track;
+				track.channel = channels[c];
+				track.interpolation = interpolations[c];
+				float t = 0.0f;
+				for (int k = 0; k < keyCount; k++)
+				{
+					times[k] = t;
+					t += 0.2f + 0.6f * next();
+					NaiveKey key;
+					key.time = times[k];
+					if (channels[c] == ANIM_ROTATION)
+					{
+						glm::quat q = glm::angleAxis(6.2831853f * next(), glm::normalize(glm::vec3(next(), next(), next()) + 0.1f));
+						if (k > 0 && glm::dot(q, glm::quat(values[(k - 1) * 4 + 3], values[(k - 1) * 4], values[(k - 1) * 4 + 1], values[(k - 1) * 4 + 2])) < 0.0f) q = -q;
+						values[k * 4] = q.x; values[k * 4 + 1] = q.y; values[k * 4 + 2] = q.z; values[k * 4 + 3] = q.w;
+					}
+					else
+						for (int j = 0; j < w; j++)
+						{
+							values[k * w + j] = 10.0f * next() - 5.0f;
+							handles[(2 * k) * w + j] = values[k * w + j] - next();
+							handles[(2 * k + 1) * w + j] = values[k * w + j] + next();
+						}
+					for (int j = 0; j < w; j++)
+					{
+						key.value[j] = values[k * w + j];
+						key.in[j] = handles[(2 * k) * w + j];
+						key.out[j] = handles[(2 * k + 1) * w + j];
+					}
+					track.keys.push_back(key);
+				}
+				addAnimationTrack(set, o, channels[c], interpolations[c], times.data(), values.data(), keyCount, handles.data());
+				naive.push_back(track);
+			}
+
+		// 4 s de animação a 60 quadros por segundo
+		const int frames = 240;
+		const float dt = 1.0f / 60.0f;
+		size_t tracks = set.size();
+		vector<glm::vec4> naiveOut(tracks);
+
+		auto start = chrono::high_resolution_clock::now();
+		for (int f = 0; f < frames; f++)
+		{
+			float t = f * dt;
+			for (size_t i = 0; i < tracks; i++) naiveOut[i] = naiveSample(naive[i], t);
+		}
+		double naiveMs = elapsedMs(start) / frames;
+
+		start = chrono::high_resolution_clock::now();
+		for (int f = 0; f < frames; f++)
+		{
+			set.clips[0].time = f * dt;
+			sampleAnimationTracks(set, 0, tracks);
+		}
+		double soaMs = elapsedMs(start) / frames;
+
+		// Mesmo tempo final nas três versões, para comparar os valores
+		start = chrono::high_resolution_clock::now();
+		for (int f = 0; f < frames; f++)
+		{
+			set.clips[0].time = f * dt;
+			sampleAnimations(set);
+		}
+		double parallelMs = elapsedMs(start) / frames;
+
+		double maxErr = 0.0;
+		for (size_t i = 0; i < tracks; i++)
+		{
+			int w = animationChannelWidth((AnimationChannel)set.channel[i]);
+			for (int j = 0; j < w; j++)
+				maxErr = max(maxErr, (double)fabs(set.output[set.outFirst[i] + j] - naiveOut[i][j]));
+		}
+
+		cout << tracks << " trilhas (" << set.times.size() << " chaves, " << (set.data.size() * sizeof(float)) / 1024 << " KB de coeficientes)" << endl;
+		cout << "  AoS com busca binaria: " << naiveMs << " ms/quadro  SoA com cursor: " << soaMs << " ms (" << naiveMs / soaMs
+			<< "x)  em paralelo: " << parallelMs << " ms (" << parallelMs * 1e6 / tracks << " ns/trilha)" << endl;
+		cout << "  diferenca maxima para a referencia: " << scientific << maxErr << fixed << endl;
+	}
+	cout << defaultfloat;
+}
@@ -0,0 +1,101 @@
+// Animação por quadros-chave: trilhas de translação, rotação, escala e material agrupadas em clipes
+//
+// As trilhas ficam em SoA e as chaves de todas elas em dois vetores contíguos, na ordem das
+// trilhas: os tempos e os coeficientes de cada trecho, calculados uma vez na construção. Trilhas
+// escalares e vetoriais (Catmull-Rom, Bézier ou linear) viram cúbicas na base de potências, como os
+// segmentos das curvas; as de rotação guardam os quatérnios do trecho e os de controle do squad.
+// A amostragem percorre as trilhas em ordem, continuando a busca da chave de onde parou no quadro
+// anterior (O(1) por trilha com o tempo avançando), e escreve todos os valores num único vetor,
+// dividida entre as threads do sistema de jobs. Quem usa os valores (Source.cpp) só lê output.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+enum AnimationChannel
+{
+	ANIM_TRANSLATION, // vec3
+	ANIM_ROTATION,    // Quatérnio (x, y, z, w)
+	ANIM_SCALE,       // Escala uniforme
+	ANIM_KA,          // Coeficientes do material (phong.fs)
+	ANIM_KD,
+	ANIM_KS,
+	ANIM_SHININESS,   // Expoente q
+	ANIM_CHANNEL_COUNT
+};
+
+enum AnimationInterpolation
+{
+	ANIM_LINEAR,      // Rotação: slerp
+	ANIM_CATMULL_ROM, // Tangentes pelas chaves vizinhas (tempos não uniformes); rotação: squad
+	ANIM_BEZIER       // Alças explícitas de entrada e saída por chave; rotação: squad
+};
+
+// Floats amostrados por trilha, por canal
+int animationChannelWidth(AnimationChannel channel);
+
+struct AnimationClip
+{
+	std::string name;
+	float duration = 0.0f;  // Tempo da última chave entre as trilhas do clipe
+	float speed = 1.0f;
+	bool loop = true;
+	bool playing = true;
+	float time = 0.0f;
+	int trackFirst = 0, trackEnd = 0; // Trilhas do clipe: [trackFirst, trackEnd)
+};
+
+struct AnimationSet
+{
+	std::vector<AnimationClip> clips;
+
+	// Trilhas (SoA), contíguas por clipe
+	std::vector<int> clip;
+	std::vector<int> target;            // Índice do objeto animado
+	std::vector<unsigned char> channel; // AnimationChannel
+	std::vector<int> keyFirst;          // Primeira chave em times
+	std::vector<int> keyCount;
+	std::vector<int> dataFirst;         // Primeiro coeficiente em data
+	std::vector<int> outFirst;          // Primeiro valor em output
+	std::vector<int> cursor;            // Trecho amostrado no último quadro (dica para a busca)
+
+	// Chaves de todas as trilhas
+	std::vector<float> times;
+	// Por trecho: 4 * largura floats (a, b, c, d de ((a u + b) u + c) u + d, u de 0 a 1 no trecho),
+	// ou 16 na rotação (q0, s0, s1, q1 do squad). Uma chave só vira um trecho constante
+	std::vector<float> data;
+
+	std::vector<float> output;
+
+	size_t size() const { return target.size(); }
+};
+
+// Novo clipe; as trilhas seguintes são acrescentadas a ele
+int addAnimationClip(AnimationSet& set, const std::string& name, bool loop = true, float speed = 1.0f);
+// values: keyCount * largura floats (rotação em quatérnios x, y, z, w). handles, só na Bézier:
+// alça de entrada e de saída de cada chave, 2 * keyCount * largura floats (nulo = alças da
+// Catmull-Rom). Retorna o índice da trilha ou -1 se as chaves são inválidas
+int addAnimationTrack(AnimationSet& set, int target, AnimationChannel channel, AnimationInterpolation interpolation,
+	const float* times, const float* values, int keyCount, const float* handles = nullptr);
+
+// Seção "animations" do config.json. Trilhas com objeto fora de [0, objectCount) são ignoradas
+void loadAnimationConfig(const std::string& configFile, AnimationSet& set, int objectCount);
+
+// Avança o tempo dos clipes tocando (em laço ou parando na última chave)
+void advanceAnimations(AnimationSet& set, float dt);
+// Amostra as trilhas [begin, end) dos clipes tocando no tempo do clipe
+void sampleAnimationTracks(AnimationSet& set, size_t begin, size_t end);
+// Todas as trilhas, em paralelo
+void sampleAnimations(AnimationSet& set);
+
+inline glm::vec3 animationVec3(const AnimationSet& set, size_t track) { const float* v = &set.output[set.outFirst[track]]; return glm::vec3(v[0], v[1], v[2]); }
+inline glm::quat animationQuat(const AnimationSet& set, size_t track) { const float* v = &set.output[set.outFirst[track]]; return glm::quat(v[3], v[0], v[1], v[2]); }
+inline float animationFloat(const AnimationSet& set, size_t track) { return set.output[set.outFirst[track]]; }
+
+// Dezenas de milhares de propriedades: SoA com cursor contra chaves AoS com busca binária
+void benchmarkAnimation();
@@ -0,0 +1,577 @@
+// BVH de triângulos por malha - implementação
+// Referências: "How to build a BVH" (J. Bikker) e Wald, "On fast Construction of SAH-based BVHs"
+
+#include "BVH.h"
+#include "Jobs.h"
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#define BVH_SSE 1
+#endif
+
+using namespace std;
+
+namespace
+{
+	const int BINS = 16;                     // Nro de bins do SAH por eixo
+	const size_t PARALLEL_MIN_TRIS = 8192;   // Abaixo disso não compensa abrir um job
+	const int PARALLEL_MAX_DEPTH = 4;        // Até 2^4 subárvores construídas em paralelo
+	const int MAX_DEPTH = 64;                // Limita a pilha de travessia
+	const uint32_t INVALID_CHILD = UINT32_MAX;
+
+	struct AABB
+	{
+		glm::vec3 bmin = glm::vec3(FLT_MAX);
+		glm::vec3 bmax = glm::vec3(-FLT_MAX);
+
+		void grow(const glm::vec3& p) { bmin = glm::min(bmin, p); bmax = glm::max(bmax, p); }
+		void grow(const AABB& b) { if (b.bmin.x != FLT_MAX) { grow(b.bmin); grow(b.bmax); } }
+		float area() const
+		{
+			glm::vec3 e = bmax - bmin;
+			return e.x * e.y + e.y * e.z + e.z * e.x;
+		}
+	};
+
+	struct Bin
+	{
+		AABB bounds;
+		uint32_t count = 0;
+	};
+
+	struct Builder
+	{
+		const vector<glm::vec3>& verts;  // Triângulos na ordem original
+		vector<glm::vec3> centroids;
+		vector<uint32_t>& idx;
+		vector<BVHNode>& nodes;
+		atomic<uint32_t> nodesUsed;
+
+		Builder(const vector<glm::vec3>& v, vector<uint32_t>& i, vector<BVHNode>& n)
+			: verts(v), idx(i), nodes(n), nodesUsed(2) {}
+	};
+
+	float nodeArea(const BVHNode& node)
+	{
+		glm::vec3 e = node.bmax - node.bmin;
+		return e.x * e.y + e.y * e.z + e.z * e.x;
+	}
+
+	void updateNodeBounds(Builder& b, uint32_t nodeIdx)
+	{
+		BVHNode& node = b.nodes[nodeIdx];
+		AABB box;
+		for (uint32_t i = 0; i < node.count; i++)
+		{
+			uint32_t tri = b.idx[node.leftFirst + i];
+			box.grow(b.verts[tri * 3]);
+			box.grow(b.verts[tri * 3 + 1]);
+			box.grow(b.verts[tri * 3 + 2]);
+		}
+		node.bmin = box.bmin;
+		node.bmax = box.bmax;
+	}
+
+	// Avalia BINS-1 planos de corte por eixo e devolve o custo SAH do melhor
+	float findBestSplit(const Builder& b, const BVHNode& node, int& axis, float& splitPos)
+	{
+		float bestCost = FLT_MAX;
+
+		// Os bins são distribuídos sobre a caixa dos centróides, não dos triângulos
+		AABB centroidBox;
+		for (uint32_t i = 0; i < node.count; i++)
+			centroidBox.grow(b.centroids[b.idx[node.leftFirst + i]]);
+
+		for (int a = 0; a < 3; a++)
+		{
+			float boundsMin = centroidBox.bmin[a], boundsMax = centroidBox.bmax[a];
+			if (boundsMin == boundsMax) continue;
+
+			Bin bins[BINS];
+			float scale = BINS / (boundsMax - boundsMin);
+			for (uint32_t i = 0; i < node.count; i++)
+			{
+				uint32_t tri = b.idx[node.leftFirst + i];
+				int binIdx = min(BINS - 1, (int)((b.centroids[tri][a] - boundsMin) * scale));
+				bins[binIdx].count++;
+				bins[binIdx].bounds.grow(b.verts[tri * 3]);
+				bins[binIdx].bounds.grow(b.verts[tri * 3 + 1]);
+				bins[binIdx].bounds.grow(b.verts[tri * 3 + 2]);
+			}
+
+			// Varredura da esquerda e da direita acumulando área e contagem
+			float leftArea[BINS - 1], rightArea[BINS - 1];
+			uint32_t leftCount[BINS - 1], rightCount[BINS - 1];
+			AABB leftBox, rightBox;
+			uint32_t leftSum = 0, rightSum = 0;
+			for (int i = 0; i < BINS - 1; i++)
+			{
+				leftSum += bins[i].count;
+				leftCount[i] = leftSum;
+				leftBox.grow(bins[i].bounds);
+				leftArea[i] = leftBox.area();
+
+				rightSum += bins[BINS - 1 - i].count;
+				rightCount[BINS - 2 - i] = rightSum;
+				rightBox.grow(bins[BINS - 1 - i].bounds);
+				rightArea[BINS - 2 - i] = rightBox.area();
+			}
+
+			float binWidth = (boundsMax - boundsMin) / BINS;
+			for (int i = 0; i < BINS - 1; i++)
+			{
+				if (leftCount[i] == 0 || rightCount[i] == 0) continue;
+				float cost = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
+				if (cost < bestCost)
+				{
+					axis = a;
+					splitPos = boundsMin + binWidth * (i + 1);
+					bestCost = cost;
+				}
+			}
+		}
+		return bestCost;
+	}
+
+	void subdivide(Builder& b, uint32_t nodeIdx, int depth)
+	{
+		BVHNode& node = b.nodes[nodeIdx];
+		if (node.count <= 2 || depth >= MAX_DEPTH) return;
+
+		int axis = 0;
+		float splitPos = 0.0f;
+		float splitCost = findBestSplit(b, node, axis, splitPos);
+		float noSplitCost = node.count * nodeArea(node);
+		if (splitCost >= noSplitCost) return;
+
+		// Particiona os índices no lugar (quicksort in-place)
+		int64_t i = node.leftFirst;
+		int64_t j = i + node.count - 1;
+		while (i <= j)
+		{
+			if (b.centroids[b.idx[i]][axis] < splitPos)
+				i++;
+			else
+				swap(b.idx[i], b.idx[j--]);
+		}
+
+		uint32_t leftCount = (uint32_t)(i - node.leftFirst);
+		if (leftCount == 0 || leftCount == node.count) return;
+
+		// Os filhos são alocados em pares; o contador é atômico por causa das threads
+		uint32_t leftIdx = b.nodesUsed.fetch_add(2);
+		uint32_t rightIdx = leftIdx + 1;
+		b.nodes[leftIdx].leftFirst = node.leftFirst;
+		b.nodes[leftIdx].count = leftCount;
+		b.nodes[rightIdx].leftFirst = (uint32_t)i;
+		b.nodes[rightIdx].count = node.count - leftCount;
+		node.leftFirst = leftIdx;
+		node.count = 0;
+		updateNodeBounds(b, leftIdx);
+		updateNodeBounds(b, rightIdx);
+
+		// Subárvores disjuntas podem ser construídas em paralelo sem sincronização
+		bool parallel = depth < PARALLEL_MAX_DEPTH &&
+			b.nodes[leftIdx].count >= PARALLEL_MIN_TRIS && b.nodes[rightIdx].count >= PARALLEL_MIN_TRIS;
+		if (parallel)
+		{
+			// Enquanto espera o job da esquerda, a thread ajuda executando outros jobs
+			JobCounter left;
+			runJob([&b, leftIdx, depth] { subdivide(b, leftIdx, depth + 1); }, &left, "bvh");
+			subdivide(b, rightIdx, depth + 1);
+			waitForCounter(left);
+		}
+		else
+		{
+			subdivide(b, leftIdx, depth + 1);
+			subdivide(b, rightIdx, depth + 1);
+		}
+	}
+
+	// Converte uma subárvore binária em nós de 4 filhos, puxando para cima os netos
+	// do filho interno de maior área até preencher os 4 espaços
+	uint32_t collapseToWide(const vector<BVHNode>& nodes, vector<BVH4Node>& wide, uint32_t nodeIdx)
+	{
+		uint32_t children[4];
+		int n = 0;
+		const BVHNode& node = nodes[nodeIdx];
+		if (node.isLeaf())
+		{
+			children[n++] = nodeIdx;
+		}
+		else
+		{
+			children[n++] = node.leftFirst;
+			children[n++] = node.leftFirst + 1;
+			while (n < 4)
+			{
+				int best = -1;
+				float bestArea = -1.0f;
+				for (int i = 0; i < n; i++)
+				{
+					const BVHNode& c = nodes[children[i]];
+					if (!c.isLeaf() && nodeArea(c) > bestArea)
+					{
+						bestArea = nodeArea(c);
+						best = i;
+					}
+				}
+				if (best < 0) break;
+				uint32_t first = nodes[children[best]].leftFirst;
+				children[best] = first;
+				children[n++] = first + 1;
+			}
+		}
+
+		uint32_t me = (uint32_t)wide.size();
+		wide.push_back(BVH4Node());
+		for (int i = 0; i < 4; i++)
+		{
+			BVH4Node& w = wide[me];
+			if (i >= n)
+			{
+				w.minX[i] = w.minY[i] = w.minZ[i] = FLT_MAX;
+				w.maxX[i] = w.maxY[i] = w.maxZ[i] = -FLT_MAX;
+				w.child[i] = INVALID_CHILD;
+				w.count[i] = 0;
+				continue;
+			}
+			const BVHNode& c = nodes[children[i]];
+			w.minX[i] = c.bmin.x; w.minY[i] = c.bmin.y; w.minZ[i] = c.bmin.z;
+			w.maxX[i] = c.bmax.x; w.maxY[i] = c.bmax.y; w.maxZ[i] = c.bmax.z;
+			if (c.isLeaf())
+			{
+				w.child[i] = c.leftFirst;
+				w.count[i] = c.count;
+			}
+			else
+			{
+				// A chamada recursiva pode realocar o vetor, então a referência é refeita depois
+				uint32_t childIdx = collapseToWide(nodes, wide, children[i]);
+				wide[me].child[i] = childIdx;
+				wide[me].count[i] = 0;
+			}
+		}
+		return me;
+	}
+
+	// Möller-Trumbore
+	bool intersectTriangle(const glm::vec3* v, const Ray& ray, float& t, float& u, float& w)
+	{
+		const glm::vec3 edge1 = v[1] - v[0];
+		const glm::vec3 edge2 = v[2] - v[0];
+		const glm::vec3 h = glm::cross(ray.dir, edge2);
+		const float a = glm::dot(edge1, h);
+		if (a > -1e-8f && a < 1e-8f) return false; // Raio paralelo ao triângulo
+		const float f = 1.0f / a;
+		const glm::vec3 s = ray.origin - v[0];
+		u = f * glm::dot(s, h);
+		if (u < 0.0f || u > 1.0f) return false;
+		const glm::vec3 q = glm::cross(s, edge1);
+		w = f * glm::dot(ray.dir, q);
+		if (w < 0.0f || u + w > 1.0f) return false;
+		t = f * glm::dot(edge2, q);
+		return t > 1e-6f;
+	}
+
+	void intersectLeaf(const BVH& bvh, uint32_t first, uint32_t count, const Ray& ray, RayHit& hit, bool& found)
+	{
+		for (uint32_t i = first; i < first + count; i++)
+		{
+			float t, u, v;
+			if (intersectTriangle(&bvh.vertices[i * 3], ray, t, u, v) && t < hit.t)
+			{
+				hit.t = t;
+				hit.u = u;
+				hit.v = v;
+				hit.tri = bvh.triIndices[i];
+				found = true;
+			}
+		}
+	}
+
+	// Teste de slab; devolve a distância de entrada ou FLT_MAX se não atingiu
+	float intersectAABB(const Ray& ray, const glm::vec3& rcpDir, float tMax, const glm::vec3& bmin, const glm::vec3& bmax)
+	{
+		glm::vec3 t1 = (bmin - ray.origin) * rcpDir;
+		glm::vec3 t2 = (bmax - ray.origin) * rcpDir;
+		glm::vec3 tNear = glm::min(t1, t2);
+		glm::vec3 tFar = glm::max(t1, t2);
+		float enter = max(max(tNear.x, tNear.y), tNear.z);
+		float exit = min(min(tFar.x, tFar.y), tFar.z);
+		if (exit >= enter && exit > 0.0f && enter < tMax) return enter;
+		return FLT_MAX;
+	}
+
+	template <typename T>
+	void putArray(vector<char>& out, const vector<T>& v)
+	{
+		uint64_t count = v.size();
+		const char* c = (const char*)&count;
+		out.insert(out.end(), c, c + sizeof(count));
+		const char* d = (const char*)v.data();
+		out.insert(out.end(), d, d + v.size() * sizeof(T));
+	}
+
+	template <typename T>
+	bool getArray(const char*& data, const char* end, vector<T>& v)
+	{
+		uint64_t count;
+		if (end - data < (ptrdiff_t)sizeof(count)) return false;
+		memcpy(&count, data, sizeof(count));
+		data += sizeof(count);
+		if ((uint64_t)(end - data) < count * sizeof(T)) return false;
+		v.resize((size_t)count);
+		memcpy(v.data(), data, (size_t)count * sizeof(T));
+		data += count * sizeof(T);
+		return true;
+	}
+
+	// Confere os índices de uma BVH lida do disco antes de ela ser percorrida: filhos dentro do vetor e
+	// sempre depois do pai (sem ciclos), profundidade dentro das pilhas de travessia, folhas dentro dos
+	// triângulos e índices originais válidos
+	bool validBVH(const BVH& bvh)
+	{
+		if (bvh.vertices.size() % 3 != 0) return false;
+		uint64_t triCount = bvh.triangleCount();
+		if (bvh.triIndices.size() != triCount) return false;
+		for (uint32_t tri : bvh.triIndices)
+			if (tri >= triCount) return false;
+		if (bvh.nodes.empty()) return bvh.nodes4.empty() && triCount == 0;
+
+		vector<pair<uint32_t, int>> pending = { { 0u, 1 } };
+		while (!pending.empty())
+		{
+			uint32_t i = pending.back().first;
+			int depth = pending.back().second;
+			pending.pop_back();
+			const BVHNode& node = bvh.nodes[i];
+			if (node.isLeaf())
+			{
+				if ((uint64_t)node.leftFirst + node.count > triCount) return false;
+				continue;
+			}
+			if (depth > MAX_DEPTH || node.leftFirst <= i || (uint64_t)node.leftFirst + 1 >= bvh.nodes.size()) return false;
+			pending.push_back({ node.leftFirst, depth + 1 });
+			pending.push_back({ node.leftFirst + 1, depth + 1 });
+		}
+
+		if (bvh.nodes4.empty()) return true;
+		pending.push_back({ 0u, 1 });
+		while (!pending.empty())
+		{
+			uint32_t i = pending.back().first;
+			int depth = pending.back().second;
+			pending.pop_back();
+			if (depth > MAX_DEPTH) return false;
+			const BVH4Node& node = bvh.nodes4[i];
+			for (int c = 0; c < 4; c++)
+			{
+				if (node.child[c] == INVALID_CHILD) continue;
+				if (node.count[c] > 0)
+				{
+					if ((uint64_t)node.child[c] + node.count[c] > triCount) return false;
+					continue;
+				}
+				if (node.child[c] <= i || node.child[c] >= bvh.nodes4.size()) return false;
+				pending.push_back({ node.child[c], depth + 1 });
+			}
+		}
+		return true;
+	}
+}
+
+size_t BVH::memoryBytes() const
+{
+	return nodes.size() * sizeof(BVHNode) + nodes4.size() * sizeof(BVH4Node) +
+		vertices.size() * sizeof(glm::vec3) + triIndices.size() * sizeof(uint32_t);
+}
+
+void buildBVH(BVH& bvh, const vector<glm::vec3>& triangleVertices, bool buildWide)
+{
+	auto start = chrono::high_resolution_clock::now();
+
+	uint32_t triCount = (uint32_t)(triangleVertices.size() / 3);
+	bvh.nodes.clear();
+	bvh.nodes4.clear();
+	bvh.vertices.clear();
+	bvh.triIndices.clear();
+	if (triCount == 0) return;
+
+	vector<uint32_t> idx(triCount);
+	for (uint32_t i = 0; i < triCount; i++) idx[i] = i;
+
+	// Uma BVH binária tem no máximo 2N - 1 nós (+1 pelo índice vago)
+	bvh.nodes.resize(triCount * 2);
+
+	Builder b(triangleVertices, idx, bvh.nodes);
+	b.centroids.resize(triCount);
+	for (uint32_t i = 0; i < triCount; i++)
+		b.centroids[i] = (triangleVertices[i * 3] + triangleVertices[i * 3 + 1] + triangleVertices[i * 3 + 2]) * (1.0f / 3.0f);
+
+	BVHNode& root = bvh.nodes[0];
+	root.leftFirst = 0;
+	root.count = triCount;
+	updateNodeBounds(b, 0);
+	subdivide(b, 0, 0);
+	bvh.nodes.resize(b.nodesUsed.load());
+	bvh.nodes.shrink_to_fit();
+
+	// Reordena os triângulos na ordem das folhas para acesso contíguo na travessia
+	bvh.vertices.resize(triangleVertices.size());
+	for (uint32_t i = 0; i < triCount; i++)
+	{
+		bvh.vertices[i * 3] = triangleVertices[idx[i] * 3];
+		bvh.vertices[i * 3 + 1] = triangleVertices[idx[i] * 3 + 1];
+		bvh.vertices[i * 3 + 2] = triangleVertices[idx[i] * 3 + 2];
+	}
+	bvh.triIndices.swap(idx);
+
+	if (buildWide)
+		collapseToWide(bvh.nodes, bvh.nodes4, 0);
+
+	bvh.buildMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+}
+
+bool intersectBVH(const BVH& bvh, const Ray& ray, RayHit& hit)
+{
+	if (bvh.empty()) return false;
+
+	bool found = false;
+	glm::vec3 rcpDir = 1.0f / ray.dir;
+	float tMax = min(ray.tMax, hit.t);
+	if (intersectAABB(ray, rcpDir, tMax, bvh.nodes[0].bmin, bvh.nodes[0].bmax) == FLT_MAX) return false;
+
+	uint32_t stack[MAX_DEPTH];
+	uint32_t stackPtr = 0;
+	const BVHNode* node = &bvh.nodes[0];
+	while (true)
+	{
+		if (node->isLeaf())
+		{
+			intersectLeaf(bvh, node->leftFirst, node->count, ray, hit, found);
+			if (stackPtr == 0) break;
+			node = &bvh.nodes[stack[--stackPtr]];
+			continue;
+		}
+
+		// Visita primeiro o filho mais próximo e empilha o outro
+		tMax = min(ray.tMax, hit.t);
+		uint32_t c1 = node->leftFirst, c2 = node->leftFirst + 1;
+		float d1 = intersectAABB(ray, rcpDir, tMax, bvh.nodes[c1].bmin, bvh.nodes[c1].bmax);
+		float d2 = intersectAABB(ray, rcpDir, tMax, bvh.nodes[c2].bmin, bvh.nodes[c2].bmax);
+		if (d1 > d2) { swap(d1, d2); swap(c1, c2); }
+		if (d1 == FLT_MAX)
+		{
+			if (stackPtr == 0) break;
+			node = &bvh.nodes[stack[--stackPtr]];
+		}
+		else
+		{
+			node = &bvh.nodes[c1];
+			if (d2 != FLT_MAX) stack[stackPtr++] = c2;
+		}
+	}
+	return found;
+}
+
+bool intersectBVH4(const BVH& bvh, const Ray& ray, RayHit& hit)
+{
+	if (bvh.nodes4.empty()) return intersectBVH(bvh, ray, hit);
+
+	bool found = false;
+	glm::vec3 rcpDir = 1.0f / ray.dir;
+
+#ifdef BVH_SSE
+	const __m128 ox = _mm_set1_ps(ray.origin.x), oy = _mm_set1_ps(ray.origin.y), oz = _mm_set1_ps(ray.origin.z);
+	const __m128 rx = _mm_set1_ps(rcpDir.x), ry = _mm_set1_ps(rcpDir.y), rz = _mm_set1_ps(rcpDir.z);
+	const __m128 zero = _mm_setzero_ps();
+#endif
+
+	uint32_t stack[MAX_DEPTH * 3 + 4];
+	uint32_t stackPtr = 0;
+	stack[stackPtr++] = 0;
+	while (stackPtr > 0)
+	{
+		const BVH4Node& node = bvh.nodes4[stack[--stackPtr]];
+		float tMax = min(ray.tMax, hit.t);
+		float tEnter[4];
+		int hitMask = 0;
+
+#ifdef BVH_SSE
+		// Teste de slab das 4 caixas ao mesmo tempo
+		__m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minX), ox), rx);
+		__m128 t2x = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxX), ox), rx);
+		__m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minY), oy), ry);
+		__m128 t2y = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxY), oy), ry);
+		__m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minZ), oz), rz);
+		__m128 t2z = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxZ), oz), rz);
+		__m128 enter = _mm_max_ps(_mm_max_ps(_mm_min_ps(t1x, t2x), _mm_min_ps(t1y, t2y)), _mm_min_ps(t1z, t2z));
+		__m128 exit = _mm_min_ps(_mm_min_ps(_mm_max_ps(t1x, t2x), _mm_max_ps(t1y, t2y)), _mm_max_ps(t1z, t2z));
+		__m128 mask = _mm_and_ps(_mm_cmpge_ps(exit, enter),
+			_mm_and_ps(_mm_cmpgt_ps(exit, zero), _mm_cmplt_ps(enter, _mm_set1_ps(tMax))));
+		hitMask = _mm_movemask_ps(mask);
+		_mm_storeu_ps(tEnter, enter);
+#else
+		for (int i = 0; i < 4; i++)
+		{
+			glm::vec3 bmin(node.minX[i], node.minY[i], node.minZ[i]);
+			glm::vec3 bmax(node.maxX[i], node.maxY[i], node.maxZ[i]);
+			tEnter[i] = intersectAABB(ray, rcpDir, tMax, bmin, bmax);
+			if (tEnter[i] != FLT_MAX) hitMask |= 1 << i;
+		}
+#endif
+
+		// Empilha os filhos internos do mais distante para o mais próximo
+		int order[4];
+		int n = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			if (!(hitMask & (1 << i)) || node.child[i] == INVALID_CHILD) continue;
+			if (node.count[i] > 0)
+			{
+				intersectLeaf(bvh, node.child[i], node.count[i], ray, hit, found);
+				continue;
+			}
+			int k = n++;
+			while (k > 0 && tEnter[order[k - 1]] < tEnter[i])
+			{
+				order[k] = order[k - 1];
+				k--;
+			}
+			order[k] = i;
+		}
+		for (int k = 0; k < n; k++)
+			stack[stackPtr++] = node.child[order[k]];
+	}
+	return found;
+}
+
+void writeBVH(vector<char>& out, const BVH& bvh)
+{
+	putArray(out, bvh.nodes);
+	putArray(out, bvh.nodes4);
+	putArray(out, bvh.vertices);
+	putArray(out, bvh.triIndices);
+}
+
+// Falha (e a malha é cozida de novo) se o arquivo estiver truncado ou com índices fora do lugar
+bool readBVH(const char*& data, const char* end, BVH& bvh)
+{
+	return getArray(data, end, bvh.nodes) && getArray(data, end, bvh.nodes4) &&
+		getArray(data, end, bvh.vertices) && getArray(data, end, bvh.triIndices) && validBVH(bvh);
+}
+
+void reportBVH(const string& name, const BVH& bvh, bool fromCache)
+{
+	cout << "BVH " << name << ": " << bvh.triangleCount() << " triangulos, "
+		<< bvh.nodes.size() << " nos (" << bvh.nodes4.size() << " nos de 4), "
+		<< bvh.memoryBytes() / 1024.0 << " KB, "
+		<< bvh.buildMs << " ms" << (fromCache ? " (cache)" : "") << endl;
+}
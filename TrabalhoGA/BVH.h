@@ -0,0 +1,85 @@
+// BVH de triângulos por malha - estrutura de aceleração para consultas de raio
+// (picking, ray tracing na CPU, baking de lightmaps, colisão)
+//
+// Construção com SAH em bins (binned SAH), paralela entre subárvores,
+// nó compacto de 32 bytes e variante opcional de 4 filhos para SIMD (SSE).
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cfloat>
+
+//GLM
+#include <glm/glm.hpp>
+
+// Nó binário compacto (32 bytes): dois por linha de cache
+// Nó interno: leftFirst = índice do filho esquerdo (o direito é leftFirst + 1), count = 0
+// Folha: leftFirst = primeiro triângulo, count = nro de triângulos
+struct BVHNode
+{
+	glm::vec3 bmin;
+	uint32_t leftFirst;
+	glm::vec3 bmax;
+	uint32_t count;
+
+	bool isLeaf() const { return count > 0; }
+};
+static_assert(sizeof(BVHNode) == 32, "BVHNode deve ter 32 bytes");
+
+// Nó de 4 filhos com as caixas em SoA, para testar as 4 de uma vez com SSE (128 bytes)
+// child[i] = índice do nó filho (count[i] = 0) ou primeiro triângulo (count[i] > 0)
+// Filhos vazios têm caixa invertida (min = +inf, max = -inf) e nunca são atingidos
+struct BVH4Node
+{
+	float minX[4], minY[4], minZ[4];
+	float maxX[4], maxY[4], maxZ[4];
+	uint32_t child[4];
+	uint32_t count[4];
+};
+static_assert(sizeof(BVH4Node) == 128, "BVH4Node deve ter 128 bytes");
+
+struct Ray
+{
+	glm::vec3 origin;
+	glm::vec3 dir;
+	float tMax = FLT_MAX;
+};
+
+struct RayHit
+{
+	float t = FLT_MAX;
+	float u = 0.0f, v = 0.0f; // Coordenadas baricêntricas
+	uint32_t tri = UINT32_MAX; // Índice do triângulo na ordem original da malha
+};
+
+struct BVH
+{
+	std::vector<BVHNode> nodes;        // Raiz no índice 0 (o índice 1 fica vago para alinhar os pares)
+	std::vector<BVH4Node> nodes4;      // Variante de 4 filhos (vazia se não foi pedida)
+	std::vector<glm::vec3> vertices;   // 3 vértices por triângulo, já na ordem das folhas
+	std::vector<uint32_t> triIndices;  // Índice original de cada triângulo reordenado
+
+	double buildMs = 0.0;              // Tempo de construção (ou de leitura do cache)
+
+	size_t triangleCount() const { return vertices.size() / 3; }
+	bool empty() const { return nodes.empty(); }
+	size_t memoryBytes() const;
+};
+
+// Constrói a BVH a partir de uma lista de triângulos (3 vértices consecutivos por triângulo)
+// Se buildWide for verdadeiro, também gera os nós de 4 filhos
+void buildBVH(BVH& bvh, const std::vector<glm::vec3>& triangleVertices, bool buildWide = true);
+
+// Consultas de raio (em espaço de objeto). Retornam true se houve interseção mais próxima que hit.t
+bool intersectBVH(const BVH& bvh, const Ray& ray, RayHit& hit);
+bool intersectBVH4(const BVH& bvh, const Ray& ray, RayHit& hit);
+
+// Serialização para o cache da malha cozida
+void writeBVH(std::vector<char>& out, const BVH& bvh);
+bool readBVH(const char*& data, const char* end, BVH& bvh);
+
+// Imprime tempo de construção e memória da BVH de um asset
+void reportBVH(const std::string& name, const BVH& bvh, bool fromCache);
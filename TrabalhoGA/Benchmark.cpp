@@ -0,0 +1,292 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <mutex>
+#include <map>
+#include <json.hpp>
+
+using namespace std;
+using json = nlohmann::json;
+
+FrameStats frameStats;
+
+namespace
+{
+	const char* SECTION_NAMES[PROFILE_SECTION_COUNT] = { "events", "simulation", "render", "swap" };
+
+	vector<FrameStats> recordedFrames;
+	chrono::high_resolution_clock::time_point frameStart;
+	chrono::high_resolution_clock::time_point sectionStart[PROFILE_SECTION_COUNT];
+
+	// Intervalo de um job, escrito pela thread que o executou
+	struct JobSpan
+	{
+		const char* name;
+		int worker;
+		double startMs, durationMs;
+	};
+
+	struct JobTotals
+	{
+		int count = 0;
+		double ms = 0.0;
+	};
+
+	// Os jobs do quadro corrente, de todas as threads
+	mutex frameSpansMutex;
+	vector<JobSpan> frameSpans;
+	// Somas dos quadros gravados
+	map<string, JobTotals> jobsByName;
+	vector<double> workerJobMs;
+
+	// Percentil pelo método do posto mais próximo (valores já ordenados)
+	double percentile(const vector<double>& sorted, double p)
+	{
+		if (sorted.empty()) return 0.0;
+		size_t rank = (size_t)ceil(p / 100.0 * sorted.size());
+		return sorted[min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+	}
+}
+
+BenchmarkConfig loadBenchmarkConfig(const string& configFile, int argc, char** argv)
+{
+	BenchmarkConfig config;
+
+	ifstream file(configFile);
+	if (file.is_open())
+	{
+		json jsonData;
+		file >> jsonData;
+
+		if (jsonData.contains("benchmark"))
+		{
+			const json& item = jsonData["benchmark"];
+			if (item.contains("copies")) config.copies = item["copies"];
+			if (item.contains("agents")) config.agents = item["agents"];
+			if (item.contains("frames")) config.frames = item["frames"];
+			if (item.contains("warmupFrames")) config.warmupFrames = item["warmupFrames"];
+			if (item.contains("seed")) config.seed = item["seed"];
+			if (item.contains("radius")) config.radius = item["radius"];
+			if (item.contains("report")) config.reportPath = item["report"];
+
+			if (item.contains("meshes"))
+				for (const auto& m : item["meshes"])
+				{
+					BenchmarkMesh mesh;
+					if (m.contains("modelPath")) mesh.modelPath = m["modelPath"];
+					if (m.contains("texturePath")) mesh.texturePath = m["texturePath"];
+					if (m.contains("weight")) mesh.weight = m["weight"];
+					if (m.contains("scale")) mesh.scale = m["scale"];
+					config.meshes.push_back(mesh);
+				}
+		}
+	}
+
+	// A linha de comando tem precedência sobre o config.json
+	for (int i = 1; i < argc; i++)
+	{
+		bool hasValue = i + 1 < argc;
+		if (strcmp(argv[i], "--benchmark") == 0) config.enabled = true;
+		else if (strcmp(argv[i], "--headless") == 0) config.headless = true;
+		else if (strcmp(argv[i], "--copies") == 0 && hasValue) config.copies = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--agents") == 0 && hasValue) config.agents = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--frames") == 0 && hasValue) config.frames = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--seed") == 0 && hasValue) config.seed = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--report") == 0 && hasValue) config.reportPath = argv[++i];
+		else if (strcmp(argv[i], "--workers") == 0 && hasValue) config.jobWorkers = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--job-benchmark") == 0) config.jobBenchmark = true;
+		else if (strcmp(argv[i], "--jobs") == 0 && hasValue) config.jobBenchmarkJobs = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--curve-benchmark") == 0) config.curveBenchmark = true;
+		else if (strcmp(argv[i], "--animation-benchmark") == 0) config.animationBenchmark = true;
+		else if (strcmp(argv[i], "--texture-benchmark") == 0) config.textureBenchmark = true;
+	}
+
+	if (config.enabled && config.meshes.empty())
+	{
+		cout << "Benchmark sem malhas na secao \"benchmark\" do " << configFile << endl;
+		config.enabled = false;
+	}
+	return config;
+}
+
+vector<StressInstance> generateStressScene(const BenchmarkConfig& config)
+{
+	vector<StressInstance> instances;
+	instances.reserve(config.copies);
+
+	// Mesma semente => mesma cena, para comparar execuções entre builds
+	mt19937 rng(config.seed);
+	vector<float> weights;
+	for (const BenchmarkMesh& m : config.meshes) weights.push_back(m.weight);
+	discrete_distribution<int> pickMesh(weights.begin(), weights.end());
+	uniform_real_distribution<float> position(-config.radius, config.radius);
+	uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+	uniform_real_distribution<float> scale(0.5f, 1.5f);
+
+	for (int i = 0; i < config.copies; i++)
+	{
+		StressInstance inst;
+		inst.mesh = pickMesh(rng);
+		inst.translation = glm::vec3(position(rng), position(rng), position(rng));
+		inst.rotation = glm::vec3(angle(rng), angle(rng), angle(rng));
+		inst.scale = config.meshes[inst.mesh].scale * scale(rng);
+		instances.push_back(inst);
+	}
+	return instances;
+}
+
+void benchmarkCamera(const BenchmarkConfig& config, int frame, glm::vec3& cameraPos, glm::vec3& cameraFront)
+{
+	// Uma volta completa durante os quadros medidos, subindo e descendo uma vez
+	float t = (float)frame / (float)max(1, config.frames);
+	float theta = t * 6.2831853f;
+	float orbit = config.radius * 1.5f;
+	cameraPos = glm::vec3(orbit * cos(theta), config.radius * 0.5f * sin(theta), orbit * sin(theta));
+	cameraFront = glm::normalize(-cameraPos);
+}
+
+void beginFrame()
+{
+	frameStats = FrameStats();
+	{
+		lock_guard<mutex> lock(frameSpansMutex);
+		frameSpans.clear();
+	}
+	frameStart = chrono::high_resolution_clock::now();
+}
+
+void endFrame(bool record)
+{
+	frameStats.frameMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - frameStart).count();
+	{
+		lock_guard<mutex> lock(frameSpansMutex);
+		double first = 0.0, last = 0.0;
+		for (const JobSpan& span : frameSpans)
+		{
+			frameStats.jobMs += span.durationMs;
+			first = frameStats.jobs == 0 ? span.startMs : min(first, span.startMs);
+			last = max(last, span.startMs + span.durationMs);
+			frameStats.jobs++;
+			if (!record) continue;
+			JobTotals& totals = jobsByName[span.name];
+			totals.count++;
+			totals.ms += span.durationMs;
+			if ((size_t)span.worker >= workerJobMs.size()) workerJobMs.resize(span.worker + 1, 0.0);
+			workerJobMs[span.worker] += span.durationMs;
+		}
+		frameStats.jobSpanMs = frameStats.jobs > 0 ? last - first : 0.0;
+	}
+	if (record) recordedFrames.push_back(frameStats);
+}
+
+void countDraw(int vertices, int instances)
+{
+	frameStats.drawCalls++;
+	frameStats.triangles += (long long)(vertices / 3) * instances;
+}
+
+void countTextureBind()
+{
+	frameStats.textureBinds++;
+}
+
+void profileBegin(ProfileSection section)
+{
+	sectionStart[section] = chrono::high_resolution_clock::now();
+}
+
+void profileEnd(ProfileSection section)
+{
+	frameStats.cpuMs[section] += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - sectionStart[section]).count();
+}
+
+void profileJob(const char* name, int worker, double startMs, double durationMs)
+{
+	lock_guard<mutex> lock(frameSpansMutex);
+	frameSpans.push_back({ name, worker, startMs, durationMs });
+}
+
+void writeBenchmarkReport(const BenchmarkConfig& config, const string& renderer)
+{
+	if (recordedFrames.empty()) return;
+
+	vector<double> frameTimes;
+	double total = 0.0;
+	double sections[PROFILE_SECTION_COUNT] = {};
+	double drawCalls = 0.0, triangles = 0.0, textureBinds = 0.0, jobs = 0.0, jobMs = 0.0, jobSpanMs = 0.0;
+	for (const FrameStats& f : recordedFrames)
+	{
+		frameTimes.push_back(f.frameMs);
+		total += f.frameMs;
+		for (int s = 0; s < PROFILE_SECTION_COUNT; s++) sections[s] += f.cpuMs[s];
+		drawCalls += f.drawCalls;
+		triangles += (double)f.triangles;
+		textureBinds += f.textureBinds;
+		jobs += f.jobs;
+		jobMs += f.jobMs;
+		jobSpanMs += f.jobSpanMs;
+	}
+	sort(frameTimes.begin(), frameTimes.end());
+	double n = (double)recordedFrames.size();
+
+	json report;
+	report["renderer"] = renderer;
+	report["copies"] = config.copies;
+	report["agents"] = config.agents;
+	report["frames"] = recordedFrames.size();
+	report["seed"] = config.seed;
+	report["frameMs"] = {
+		{ "avg", total / n },
+		{ "p50", percentile(frameTimes, 50.0) },
+		{ "p95", percentile(frameTimes, 95.0) },
+		{ "p99", percentile(frameTimes, 99.0) },
+		{ "max", frameTimes.back() }
+	};
+	report["drawCallsPerFrame"] = drawCalls / n;
+	report["trianglesPerFrame"] = triangles / n;
+	report["textureBindsPerFrame"] = textureBinds / n;
+	report["jobsPerFrame"] = jobs / n;
+	report["jobMsPerFrame"] = jobMs / n;
+	report["jobSpanMsPerFrame"] = jobSpanMs / n;
+	for (const auto& item : jobsByName)
+		report["jobsByName"][item.first] = { { "countPerFrame", item.second.count / n }, { "msPerFrame", item.second.ms / n } };
+	for (double ms : workerJobMs)
+		report["workerJobMsPerFrame"].push_back(ms / n);
+	for (int s = 0; s < PROFILE_SECTION_COUNT; s++)
+		report["cpuMs"][SECTION_NAMES[s]] = sections[s] / n;
+
+	cout << fixed << setprecision(3);
+	cout << "==== Benchmark (" << renderer << ") ====" << endl;
+	cout << "Instancias: " << config.copies << "  Agentes: " << config.agents << "  Quadros: " << recordedFrames.size() << endl;
+	cout << "Quadro (ms): media " << total / n << "  p50 " << percentile(frameTimes, 50.0)
+		<< "  p95 " << percentile(frameTimes, 95.0) << "  p99 " << percentile(frameTimes, 99.0) << endl;
+	cout << "Chamadas de desenho/quadro: " << drawCalls / n << "  Triangulos/quadro: " << triangles / n
+		<< "  Trocas de textura/quadro: " << textureBinds / n << endl;
+	cout << "Jobs/quadro: " << jobs / n << "  Tempo em jobs/quadro (ms): " << jobMs / n << "  Intervalo dos jobs/quadro (ms): " << jobSpanMs / n << endl;
+	for (const auto& item : jobsByName)
+		cout << "  " << item.first << ": " << item.second.count / n << " jobs, " << item.second.ms / n << " ms/quadro" << endl;
+	for (size_t w = 0; w < workerJobMs.size(); w++)
+		cout << "  thread " << w << ": " << workerJobMs[w] / n << " ms/quadro em jobs" << endl;
+	for (int s = 0; s < PROFILE_SECTION_COUNT; s++)
+		cout << "CPU " << SECTION_NAMES[s] << " (ms): " << sections[s] / n << endl;
+	cout << defaultfloat;
+
+	ofstream out(config.reportPath);
+	if (out.is_open())
+	{
+		out << report.dump(4) << endl;
+		cout << "Relatorio gravado em " << config.reportPath << endl;
+	}
+	else
+	{
+		cerr << "Erro ao gravar o relatorio do benchmark: " << config.reportPath << endl;
+	}
+}
@@ -0,0 +1,102 @@
+// Modo de benchmark: cena de estresse gerada a partir dos assets de Modelos3D,
+// câmera roteirizada e relatório de tempos de quadro (média, p50/p95/p99),
+// chamadas de desenho, triângulos e tempo de CPU por subsistema
+//
+// Uso: Hello3D --benchmark [--headless] [--copies N] [--agents N] [--frames N] [--seed N] [--report arquivo.json]
+//      Hello3D --job-benchmark [--jobs N] [--workers N]   (custo de agendamento do sistema de jobs)
+//      Hello3D --curve-benchmark                          (avaliação e tesselação de curvas)
+//      Hello3D --animation-benchmark                      (amostragem das trilhas de animação)
+//      Hello3D --texture-benchmark                        (mipmaps e compressão BC1/BC3/BC7 das texturas de Modelos3D)
+// Os demais parâmetros (mistura de malhas, raio da cena) ficam na seção "benchmark" do config.json
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+// Seções de CPU medidas por quadro
+enum ProfileSection
+{
+	PROFILE_EVENTS,      // glfwPollEvents e callbacks
+	PROFILE_SIMULATION,  // Atualização de transformações e animações
+	PROFILE_RENDER,      // Submissão das chamadas de desenho
+	PROFILE_SWAP,        // Troca de buffers (inclui a espera pela GPU)
+	PROFILE_SECTION_COUNT
+};
+
+struct BenchmarkMesh
+{
+	std::string modelPath;
+	std::string texturePath;
+	float weight = 1.0f;  // Peso na mistura de malhas
+	float scale = 1.0f;   // Escala base da malha
+};
+
+struct BenchmarkConfig
+{
+	bool enabled = false;
+	bool headless = false;     // Sem janela: plataforma nula da GLFW + contexto OSMesa (GL por software)
+	int copies = 1000;         // Nro de instâncias na cena
+	int agents = 0;            // Nro de agentes percorrendo a curva (primeira malha da mistura)
+	int frames = 600;          // Quadros medidos
+	int warmupFrames = 30;     // Quadros descartados no início
+	unsigned int seed = 1234;
+	float radius = 30.0f;      // Meia aresta do cubo onde as instâncias são espalhadas
+	std::vector<BenchmarkMesh> meshes;
+	std::string reportPath = "benchmark.json";
+
+	int jobWorkers = 0;          // Threads do sistema de jobs (0 = uma por núcleo)
+	bool jobBenchmark = false;   // Só mede o sistema de jobs e sai
+	int jobBenchmarkJobs = 100000;
+	bool curveBenchmark = false; // Só mede as curvas e sai
+	bool animationBenchmark = false; // Só mede a amostragem das trilhas de animação e sai
+	bool textureBenchmark = false;   // Só mede os mipmaps e a compressão das texturas e sai
+};
+
+struct StressInstance
+{
+	int mesh;               // Índice em BenchmarkConfig::meshes
+	glm::vec3 translation;
+	glm::vec3 rotation;     // Em radianos
+	float scale;
+};
+
+struct FrameStats
+{
+	double frameMs = 0.0;
+	double cpuMs[PROFILE_SECTION_COUNT] = {};
+	int drawCalls = 0;
+	long long triangles = 0;
+	int textureBinds = 0;  // Trocas de textura ligada (as de camada dentro do mesmo array não contam)
+	int jobs = 0;          // Jobs executados no quadro (todas as threads)
+	double jobMs = 0.0;    // Soma do tempo desses jobs
+	double jobSpanMs = 0.0; // Do início do primeiro job ao fim do último
+};
+
+// Estatísticas do quadro corrente (zeradas a cada beginFrame)
+extern FrameStats frameStats;
+
+BenchmarkConfig loadBenchmarkConfig(const std::string& configFile, int argc, char** argv);
+std::vector<StressInstance> generateStressScene(const BenchmarkConfig& config);
+
+// Câmera roteirizada: órbita em torno da cena, determinística pelo índice do quadro
+void benchmarkCamera(const BenchmarkConfig& config, int frame, glm::vec3& cameraPos, glm::vec3& cameraFront);
+
+void beginFrame();
+void endFrame(bool record);
+void countDraw(int vertices, int instances = 1);
+void countTextureBind();
+
+// Acumulam o tempo entre as duas chamadas na seção indicada do quadro corrente
+void profileBegin(ProfileSection section);
+void profileEnd(ProfileSection section);
+
+// Gancho de profiling do sistema de jobs: guarda o intervalo de cada job no quadro corrente; nos
+// quadros gravados os tempos são somados por nome de job e por thread para o relatório
+void profileJob(const char* name, int worker, double startMs, double durationMs);
+
+// Imprime o resumo e grava o relatório JSON para acompanhar regressões
+void writeBenchmarkReport(const BenchmarkConfig& config, const std::string& renderer);
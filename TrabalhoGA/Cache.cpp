@@ -0,0 +1,201 @@
+#include "Cache.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cctype>
+#include <algorithm>
+#include <atomic>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	uint64_t hash = seed;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+bool readFileBytes(const string& path, vector<char>& out)
+{
+	ifstream file(path, ios::binary | ios::ate);
+	if (!file.is_open()) return false;
+
+	streamsize size = file.tellg();
+	file.seekg(0, ios::beg);
+	out.resize((size_t)size);
+	return size == 0 || (bool)file.read(out.data(), size);
+}
+
+bool writeFileBytes(const string& path, const vector<char>& data)
+{
+	// Escreve num temporário só deste processo e desta chamada e troca pelo arquivo numa operação só:
+	// quem está lendo vê o arquivo antigo ou o novo, nunca a falta dele nem um cozido pela metade
+	static atomic<unsigned> counter(0);
+#ifdef _WIN32
+	int pid = _getpid();
+#else
+	int pid = (int)getpid();
+#endif
+	string tmpPath = path + "." + to_string(pid) + "-" + to_string(counter++) + ".tmp";
+	{
+		ofstream file(tmpPath, ios::binary | ios::trunc);
+		if (!file.is_open()) return false;
+		file.write(data.data(), data.size());
+		if (!file)
+		{
+			file.close();
+			remove(tmpPath.c_str());
+			return false;
+		}
+	}
+#ifdef _WIN32
+	bool replaced = MoveFileExA(tmpPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	bool replaced = rename(tmpPath.c_str(), path.c_str()) == 0;
+#endif
+	if (!replaced) remove(tmpPath.c_str());
+	return replaced;
+}
+
+bool mapFile(const string& path, MappedFile& mapped)
+{
+	mapped = MappedFile();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!data)
+	{
+		if (mapping) CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+	mapped.file = file;
+	mapped.mapping = mapping;
+	mapped.size = (size_t)size.QuadPart;
+	mapped.data = (const unsigned char*)data;
+#else
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		close(fd);
+		return false;
+	}
+	void* data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd); // O mapeamento continua válido
+	if (data == MAP_FAILED) return false;
+	mapped.size = (size_t)st.st_size;
+	mapped.data = (const unsigned char*)data;
+#endif
+	return true;
+}
+
+void unmapFile(MappedFile& mapped)
+{
+	if (!mapped.data) return;
+#ifdef _WIN32
+	UnmapViewOfFile(mapped.data);
+	CloseHandle(mapped.mapping);
+	CloseHandle(mapped.file);
+#else
+	munmap((void*)mapped.data, mapped.size);
+#endif
+	mapped = MappedFile();
+}
+
+string cachePath(const string& sourcePath, const string& extension)
+{
+#ifdef _WIN32
+	_mkdir(CACHE_DIR);
+#else
+	mkdir(CACHE_DIR, 0755);
+#endif
+
+	size_t slash = sourcePath.find_last_of("/\\");
+	string name = slash == string::npos ? sourcePath : sourcePath.substr(slash + 1);
+
+	ostringstream ss;
+	ss << CACHE_DIR << "/" << name << "-" << hex << setw(16) << setfill('0')
+		<< hashBytes(sourcePath.data(), sourcePath.size()) << "." << extension;
+	return ss.str();
+}
+
+namespace
+{
+	bool hasExtension(const string& name, const vector<string>& extensions)
+	{
+		size_t dot = name.find_last_of('.');
+		if (dot == string::npos) return false;
+		string ext = name.substr(dot);
+		for (char& c : ext) c = (char)tolower((unsigned char)c);
+		return find(extensions.begin(), extensions.end(), ext) != extensions.end();
+	}
+
+	void listFilesInto(const string& dir, const vector<string>& extensions, vector<string>& out)
+	{
+#ifdef _WIN32
+		WIN32_FIND_DATAA data;
+		HANDLE find = FindFirstFileA((dir + "/*").c_str(), &data);
+		if (find == INVALID_HANDLE_VALUE) return;
+		do
+		{
+			string name = data.cFileName;
+			if (name == "." || name == "..") continue;
+			if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) listFilesInto(dir + "/" + name, extensions, out);
+			else if (hasExtension(name, extensions)) out.push_back(dir + "/" + name);
+		} while (FindNextFileA(find, &data));
+		FindClose(find);
+#else
+		DIR* d = opendir(dir.c_str());
+		if (!d) return;
+		while (dirent* e = readdir(d))
+		{
+			string name = e->d_name;
+			if (name == "." || name == "..") continue;
+			string path = dir + "/" + name;
+			struct stat st;
+			if (stat(path.c_str(), &st) != 0) continue;
+			if (S_ISDIR(st.st_mode)) listFilesInto(path, extensions, out);
+			else if (hasExtension(name, extensions)) out.push_back(path);
+		}
+		closedir(d);
+#endif
+	}
+}
+
+vector<string> listFiles(const string& dir, const vector<string>& extensions)
+{
+	vector<string> files;
+	listFilesInto(dir, extensions, files);
+	return files;
+}
@@ -0,0 +1,39 @@
+// Utilitários do cache de assets cozidos (diretório ./cache)
+// Os arquivos cozidos são identificados pelo caminho do asset de origem e invalidados
+// pelo hash do seu conteúdo
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+const char* const CACHE_DIR = "./cache";
+
+// FNV-1a de 64 bits
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 14695981039346656037ull);
+
+bool readFileBytes(const std::string& path, std::vector<char>& out);
+bool writeFileBytes(const std::string& path, const std::vector<char>& data);
+
+// Arquivo mapeado só para leitura: as páginas são lidas sob demanda por quem tocar nelas e ficam
+// no cache de páginas do sistema, compartilhadas entre execuções e processos
+struct MappedFile
+{
+	const unsigned char* data = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	void* file = nullptr;    // HANDLE
+	void* mapping = nullptr; // HANDLE
+#endif
+};
+
+bool mapFile(const std::string& path, MappedFile& mapped);
+void unmapFile(MappedFile& mapped);
+
+// Caminho do arquivo cozido de um asset: ./cache/<nome do arquivo>-<hash do caminho>.<extensão>
+std::string cachePath(const std::string& sourcePath, const std::string& extension);
+
+// Arquivos de dir e das subpastas cuja extensão (em minúsculas, com o ponto) está na lista
+std::vector<std::string> listFiles(const std::string& dir, const std::vector<std::string>& extensions);
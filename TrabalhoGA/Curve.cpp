@@ -0,0 +1,1597 @@
+#include "Curve.h"
+
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <limits>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define CURVE_SSE 1
+#endif
+
+using namespace std;
+
+namespace
+{
+	// Potência inteira por quadrados sucessivos
+	float powi(float x, int n)
+	{
+		float result = 1.0f;
+		while (n > 0)
+		{
+			if (n & 1) result *= x;
+			x *= x;
+			n >>= 1;
+		}
+		return result;
+	}
+
+	glm::vec3 evaluateHorner(const BezierEvaluator& e, float t)
+	{
+		// B(t) = s^n * sum C(n,i) P_i (t/s)^i, com s = 1 - t. Para t > 0.5 a soma é feita ao contrário
+		// com a razão s/t, assim a razão nunca passa de 1 e não há cancelamento
+		const int n = e.degree;
+		float s = 1.0f - t;
+		float ax, ay, az, u, scale;
+		if (t <= 0.5f)
+		{
+			u = t / s;
+			ax = e.wx[n]; ay = e.wy[n]; az = e.wz[n];
+			for (int i = n - 1; i >= 0; i--)
+			{
+				ax = ax * u + e.wx[i];
+				ay = ay * u + e.wy[i];
+				az = az * u + e.wz[i];
+			}
+			scale = powi(s, n);
+		}
+		else
+		{
+			u = s / t;
+			ax = e.wx[0]; ay = e.wy[0]; az = e.wz[0];
+			for (int i = 1; i <= n; i++)
+			{
+				ax = ax * u + e.wx[i];
+				ay = ay * u + e.wy[i];
+				az = az * u + e.wz[i];
+			}
+			scale = powi(t, n);
+		}
+		return glm::vec3(ax, ay, az) * scale;
+	}
+
+	glm::vec3 evaluateBinomial(const BezierEvaluator& e, float t, vector<float>& sPow)
+	{
+		// Todos os termos são positivos: sem cancelamento, erro de poucos ulps
+		const int n = e.degree;
+		float s = 1.0f - t;
+		sPow[n] = 1.0f;
+		for (int i = n - 1; i >= 0; i--) sPow[i] = sPow[i + 1] * s;
+
+		float tPow = 1.0f;
+		glm::vec3 p(0.0f);
+		for (int i = 0; i <= n; i++)
+		{
+			float w = e.binomial[i] * tPow * sPow[i];
+			p.x += w * e.x[i];
+			p.y += w * e.y[i];
+			p.z += w * e.z[i];
+			tPow *= t;
+		}
+		return p;
+	}
+
+	glm::vec3 evaluateDeCasteljau(const BezierEvaluator& e, float t, vector<float>& scratch)
+	{
+		const int n = e.degree;
+		float s = 1.0f - t;
+		float* bx = scratch.data();
+		float* by = bx + n + 1;
+		float* bz = by + n + 1;
+		copy(e.x.begin(), e.x.end(), bx);
+		copy(e.y.begin(), e.y.end(), by);
+		copy(e.z.begin(), e.z.end(), bz);
+		for (int r = 1; r <= n; r++)
+		{
+			for (int i = 0; i <= n - r; i++)
+			{
+				bx[i] = s * bx[i] + t * bx[i + 1];
+				by[i] = s * by[i] + t * by[i + 1];
+				bz[i] = s * bz[i] + t * bz[i + 1];
+			}
+		}
+		return glm::vec3(bx[0], by[0], bz[0]);
+	}
+
+#ifdef CURVE_SSE
+	__m128 powi4(__m128 x, int n)
+	{
+		__m128 result = _mm_set1_ps(1.0f);
+		while (n > 0)
+		{
+			if (n & 1) result = _mm_mul_ps(result, x);
+			x = _mm_mul_ps(x, x);
+			n >>= 1;
+		}
+		return result;
+	}
+
+	// Quatro valores de t por vez; o resultado sai em SoA (x, y, z de cada lane).
+	// O Horner só vetoriza se as 4 lanes estiverem do mesmo lado de t = 0.5 (o normal com
+	// amostras ordenadas); caso contrário devolve false e o lote é feito no escalar
+	bool evaluateHorner4(const BezierEvaluator& e, __m128 t, __m128& px, __m128& py, __m128& pz)
+	{
+		const int n = e.degree;
+		__m128 s = _mm_sub_ps(_mm_set1_ps(1.0f), t);
+		int low = _mm_movemask_ps(_mm_cmple_ps(t, _mm_set1_ps(0.5f)));
+		if (low == 0xF)
+		{
+			__m128 u = _mm_div_ps(t, s);
+			px = _mm_set1_ps(e.wx[n]); py = _mm_set1_ps(e.wy[n]); pz = _mm_set1_ps(e.wz[n]);
+			for (int i = n - 1; i >= 0; i--)
+			{
+				px = _mm_add_ps(_mm_mul_ps(px, u), _mm_set1_ps(e.wx[i]));
+				py = _mm_add_ps(_mm_mul_ps(py, u), _mm_set1_ps(e.wy[i]));
+				pz = _mm_add_ps(_mm_mul_ps(pz, u), _mm_set1_ps(e.wz[i]));
+			}
+			__m128 scale = powi4(s, n);
+			px = _mm_mul_ps(px, scale); py = _mm_mul_ps(py, scale); pz = _mm_mul_ps(pz, scale);
+			return true;
+		}
+		if (low == 0)
+		{
+			__m128 u = _mm_div_ps(s, t);
+			px = _mm_set1_ps(e.wx[0]); py = _mm_set1_ps(e.wy[0]); pz = _mm_set1_ps(e.wz[0]);
+			for (int i = 1; i <= n; i++)
+			{
+				px = _mm_add_ps(_mm_mul_ps(px, u), _mm_set1_ps(e.wx[i]));
+				py = _mm_add_ps(_mm_mul_ps(py, u), _mm_set1_ps(e.wy[i]));
+				pz = _mm_add_ps(_mm_mul_ps(pz, u), _mm_set1_ps(e.wz[i]));
+			}
+			__m128 scale = powi4(t, n);
+			px = _mm_mul_ps(px, scale); py = _mm_mul_ps(py, scale); pz = _mm_mul_ps(pz, scale);
+			return true;
+		}
+		return false;
+	}
+
+	void evaluateBinomial4(const BezierEvaluator& e, __m128 t, __m128* sPow, __m128& px, __m128& py, __m128& pz)
+	{
+		const int n = e.degree;
+		const __m128 one = _mm_set1_ps(1.0f);
+		__m128 s = _mm_sub_ps(one, t);
+		sPow[n] = one;
+		for (int i = n - 1; i >= 0; i--) sPow[i] = _mm_mul_ps(sPow[i + 1], s);
+
+		__m128 tPow = one;
+		px = py = pz = _mm_setzero_ps();
+		for (int i = 0; i <= n; i++)
+		{
+			__m128 w = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(e.binomial[i]), tPow), sPow[i]);
+			px = _mm_add_ps(px, _mm_mul_ps(w, _mm_set1_ps(e.x[i])));
+			py = _mm_add_ps(py, _mm_mul_ps(w, _mm_set1_ps(e.y[i])));
+			pz = _mm_add_ps(pz, _mm_mul_ps(w, _mm_set1_ps(e.z[i])));
+			tPow = _mm_mul_ps(tPow, t);
+		}
+	}
+
+	void evaluateDeCasteljau4(const BezierEvaluator& e, __m128 t, __m128* scratch, __m128& px, __m128& py, __m128& pz)
+	{
+		const int n = e.degree;
+		__m128 s = _mm_sub_ps(_mm_set1_ps(1.0f), t);
+		__m128* bx = scratch;
+		__m128* by = bx + n + 1;
+		__m128* bz = by + n + 1;
+		for (int i = 0; i <= n; i++)
+		{
+			bx[i] = _mm_set1_ps(e.x[i]);
+			by[i] = _mm_set1_ps(e.y[i]);
+			bz[i] = _mm_set1_ps(e.z[i]);
+		}
+		for (int r = 1; r <= n; r++)
+		{
+			for (int i = 0; i <= n - r; i++)
+			{
+				bx[i] = _mm_add_ps(_mm_mul_ps(s, bx[i]), _mm_mul_ps(t, bx[i + 1]));
+				by[i] = _mm_add_ps(_mm_mul_ps(s, by[i]), _mm_mul_ps(t, by[i + 1]));
+				bz[i] = _mm_add_ps(_mm_mul_ps(s, bz[i]), _mm_mul_ps(t, bz[i + 1]));
+			}
+		}
+		px = bx[0]; py = by[0]; pz = bz[0];
+	}
+#endif
+
+#ifdef CURVE_SSE
+	// Grava (x, y, z) de v em dst; o quarto float invade o ponto seguinte, então só pode ser
+	// usado se ainda houver espaço no buffer depois de dst
+	inline void storePoint(glm::vec3* dst, __m128 v, bool hasRoom)
+	{
+		if (hasRoom)
+		{
+			_mm_storeu_ps(&dst->x, v);
+			return;
+		}
+		alignas(16) float f[4];
+		_mm_store_ps(f, v);
+		*dst = glm::vec3(f[0], f[1], f[2]);
+	}
+
+	// Um segmento: C[k] = (x, y, z, 0) do coeficiente de t^(3-k); room = pontos disponíveis a partir de dst
+	void tessellateSegment4(const __m128 C[4], float piece, int numPoints, glm::vec3* dst, size_t room)
+	{
+		const __m128 ax = _mm_shuffle_ps(C[0], C[0], 0x00), ay = _mm_shuffle_ps(C[0], C[0], 0x55), az = _mm_shuffle_ps(C[0], C[0], 0xAA);
+		const __m128 bx = _mm_shuffle_ps(C[1], C[1], 0x00), by = _mm_shuffle_ps(C[1], C[1], 0x55), bz = _mm_shuffle_ps(C[1], C[1], 0xAA);
+		const __m128 cx = _mm_shuffle_ps(C[2], C[2], 0x00), cy = _mm_shuffle_ps(C[2], C[2], 0x55), cz = _mm_shuffle_ps(C[2], C[2], 0xAA);
+		const __m128 dx = _mm_shuffle_ps(C[3], C[3], 0x00), dy = _mm_shuffle_ps(C[3], C[3], 0x55), dz = _mm_shuffle_ps(C[3], C[3], 0xAA);
+		const __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+		const __m128 pieces = _mm_set1_ps(piece);
+
+		// 4 valores de t por vez; a transposição devolve um ponto por registrador.
+		// O último grupo pode estar incompleto: calcula as 4 lanes e grava só as válidas
+		for (int j = 0; j < numPoints; j += 4)
+		{
+			__m128 t = _mm_mul_ps(_mm_add_ps(_mm_set1_ps((float)j), lane), pieces);
+			__m128 px = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(ax, t), bx), t), cx), t), dx);
+			__m128 py = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(ay, t), by), t), cy), t), dy);
+			__m128 pz = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(az, t), bz), t), cz), t), dz);
+			__m128 pw = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(px, py, pz, pw);
+
+			// Em ordem crescente, cada gravação sobrescreve o lixo da anterior
+			int valid = min(4, numPoints - j);
+			if (valid == 4)
+			{
+				_mm_storeu_ps(&dst[j].x, px);
+				_mm_storeu_ps(&dst[j + 1].x, py);
+				_mm_storeu_ps(&dst[j + 2].x, pz);
+				storePoint(dst + j + 3, pw, (size_t)(j + 4) < room);
+				continue;
+			}
+			__m128 rows[3] = { px, py, pz };
+			for (int k = 0; k < valid; k++)
+				storePoint(dst + j + k, rows[k], (size_t)(j + k + 1) < room);
+		}
+	}
+#endif
+
+	// Implementação original, mantida como referência de tempo no benchmark
+	void referenceGlobalBezierCurvePoints(Curve& curve, int numPoints)
+	{
+		curve.curvePoints.clear(); // Limpa quaisquer pontos antigos da curva
+
+		int n = curve.controlPoints.size() - 1; // Grau da curva
+		float t;
+		float piece = 1.0f / (float)numPoints;
+
+		for (int j = 0; j <= numPoints; ++j)
+		{
+			t = j * piece;
+			glm::vec3 point(0.0f); // Ponto na curva
+
+			// Calcula o ponto da curva usando a fórmula de Bernstein
+			for (int i = 0; i <= n; ++i)
+			{
+				// Coeficiente binomial
+				float binomialCoeff = (float)(tgamma(n + 1) / (tgamma(i + 1) * tgamma(n - i + 1)));
+				// Polinômio de Bernstein
+				float bernsteinPoly = binomialCoeff * pow(1 - t, n - i) * pow(t, i);
+				// Soma ponderada dos pontos de controle
+				point += bernsteinPoly * curve.controlPoints[i];
+			}
+
+			curve.curvePoints.push_back(point);
+		}
+	}
+
+	// Tesselação original (G * M * T por amostra, push_back), referência do benchmark
+	void referenceCubicCurvePoints(Curve& curve, int stride, int numPoints)
+	{
+		curve.curvePoints.clear(); // Limpa quaisquer pontos antigos da curva
+
+		float piece = 1.0 / (float)numPoints;
+		float t;
+		for (size_t i = 0; i + 3 < curve.controlPoints.size(); i += stride)
+		{
+
+			// Gera pontos para o segmento atual
+			for (int j = 0; j < numPoints; j++)
+			{
+				t = j * piece;
+
+				// Vetor t para o polinômio de Bernstein
+				glm::vec4 T(t * t * t, t * t, t, 1);
+
+				glm::vec3 P0 = curve.controlPoints[i];
+				glm::vec3 P1 = curve.controlPoints[i + 1];
+				glm::vec3 P2 = curve.controlPoints[i + 2];
+				glm::vec3 P3 = curve.controlPoints[i + 3];
+
+				glm::mat4x3 G(P0, P1, P2, P3);
+
+				// Calcula o ponto da curva multiplicando tVector, a matriz de Bernstein e os pontos de controle
+				glm::vec3 point = G * curve.M * T;
+				curve.curvePoints.push_back(point);
+			}
+		}
+	}
+
+	// Referência de precisão: de Casteljau em double
+	glm::dvec3 exactBezier(const vector<glm::vec3>& controlPoints, double t)
+	{
+		vector<glm::dvec3> b(controlPoints.begin(), controlPoints.end());
+		for (size_t r = 1; r < b.size(); r++)
+			for (size_t i = 0; i < b.size() - r; i++)
+				b[i] = (1.0 - t) * b[i] + t * b[i + 1];
+		return b.empty() ? glm::dvec3(0.0) : b[0];
+	}
+
+	double maxError(const vector<glm::vec3>& points, const vector<glm::dvec3>& exact)
+	{
+		double err = 0.0;
+		for (size_t i = 0; i < points.size() && i < exact.size(); i++)
+		{
+			double e = glm::length(glm::dvec3(points[i]) - exact[i]);
+			if (std::isnan(e)) return numeric_limits<double>::infinity(); // Binomial estourou
+			err = max(err, e);
+		}
+		return err;
+	}
+
+	double elapsedUs(chrono::high_resolution_clock::time_point start)
+	{
+		return chrono::duration<double, micro>(chrono::high_resolution_clock::now() - start).count();
+	}
+
+	// |P'(t)| do segmento c (base de potências)
+	inline float speedAt(const float* c, float t)
+	{
+		float dx = (3.0f * c[0] * t + 2.0f * c[3]) * t + c[6];
+		float dy = (3.0f * c[1] * t + 2.0f * c[4]) * t + c[7];
+		float dz = (3.0f * c[2] * t + 2.0f * c[5]) * t + c[8];
+		return sqrt(dx * dx + dy * dy + dz * dz);
+	}
+
+	inline glm::vec3 cubicPosition(const float* c, float t)
+	{
+		return glm::vec3(((c[0] * t + c[3]) * t + c[6]) * t + c[9], ((c[1] * t + c[4]) * t + c[7]) * t + c[10], ((c[2] * t + c[5]) * t + c[8]) * t + c[11]);
+	}
+
+	inline glm::vec3 cubicDerivative(const float* c, float t)
+	{
+		return glm::vec3((3.0f * c[0] * t + 2.0f * c[3]) * t + c[6], (3.0f * c[1] * t + 2.0f * c[4]) * t + c[7], (3.0f * c[2] * t + 2.0f * c[5]) * t + c[8]);
+	}
+
+	// Tangente unitária; onde a derivada se anula (cúspide) mantém a anterior
+	inline glm::vec3 unitTangent(const glm::vec3& derivative, const glm::vec3& previous)
+	{
+		float len2 = glm::dot(derivative, derivative);
+		return len2 > 1e-12f ? derivative / sqrt(len2) : previous;
+	}
+
+	// Normal inicial: perpendicular à tangente e o mais perto possível de Z, então curvas no
+	// plano XY ficam com a normal fora do plano (e a binormal no plano)
+	glm::vec3 initialNormal(const glm::vec3& tangent)
+	{
+		glm::vec3 reference = fabs(tangent.z) < 0.9f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+		return glm::normalize(reference - tangent * glm::dot(tangent, reference));
+	}
+
+	// Dupla reflexão (Wang et al., 2008): leva a normal r0 de x0 (tangente t0) para x1 (tangente t1)
+	// com rotação mínima. A primeira reflexão troca x0 por x1, a segunda alinha as tangentes
+	glm::vec3 reflectNormal(const glm::vec3& x0, const glm::vec3& t0, const glm::vec3& r0, const glm::vec3& x1, const glm::vec3& t1)
+	{
+		glm::vec3 v1 = x1 - x0;
+		float c1 = glm::dot(v1, v1);
+		glm::vec3 rL = r0, tL = t0;
+		if (c1 > 1e-12f)
+		{
+			rL = r0 - (2.0f / c1) * glm::dot(v1, r0) * v1;
+			tL = t0 - (2.0f / c1) * glm::dot(v1, t0) * v1;
+		}
+		glm::vec3 v2 = t1 - tL;
+		float c2 = glm::dot(v2, v2);
+		glm::vec3 r1 = c2 > 1e-12f ? rL - (2.0f / c2) * glm::dot(v2, rL) * v2 : rL;
+
+		// Reortogonaliza contra o erro de arredondamento acumulado
+		return glm::normalize(r1 - t1 * glm::dot(t1, r1));
+	}
+
+	// Estado da propagação do frame: último ponto da grade t = k / ARC_LENGTH_SAMPLES alcançado
+	struct FrameState
+	{
+		int segment = -1;
+		int k = 0;
+		glm::vec3 position, tangent, normal;
+	};
+
+	// Amostra do segmento s em t, propagando a normal pela grade de buildArcLengthTable (passos de
+	// 1 / ARC_LENGTH_SAMPLES, o último parcial até t): t = 1 reproduz a normal guardada para o
+	// segmento seguinte. Em lote, amostras crescentes no mesmo segmento continuam de onde a
+	// anterior parou, com o mesmo resultado de começar do início do segmento
+	CurveSample sampleSegment(const ArcLengthTable& table, int s, float t, FrameState& state)
+	{
+		const float* c = &table.coeffs[(size_t)s * CUBIC_SEGMENT_FLOATS];
+		const float step = 1.0f / ARC_LENGTH_SAMPLES;
+		if (state.segment != s || (float)state.k * step > t)
+		{
+			state.segment = s;
+			state.k = 0;
+			state.position = cubicPosition(c, 0.0f);
+			state.normal = table.startNormals[s];
+			state.tangent = unitTangent(cubicDerivative(c, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+		}
+		while (state.k < ARC_LENGTH_SAMPLES && (float)(state.k + 1) * step <= t)
+		{
+			state.k++;
+			glm::vec3 x1 = cubicPosition(c, (float)state.k * step);
+			glm::vec3 t1 = unitTangent(cubicDerivative(c, (float)state.k * step), state.tangent);
+			state.normal = reflectNormal(state.position, state.tangent, state.normal, x1, t1);
+			state.position = x1;
+			state.tangent = t1;
+		}
+
+		CurveSample sample;
+		sample.position = state.position;
+		sample.tangent = state.tangent;
+		sample.normal = state.normal;
+		if (t > (float)state.k * step)
+		{
+			sample.position = cubicPosition(c, t);
+			sample.tangent = unitTangent(cubicDerivative(c, t), state.tangent);
+			sample.normal = reflectNormal(state.position, state.tangent, state.normal, sample.position, sample.tangent);
+		}
+		sample.derivative = cubicDerivative(c, t);
+		sample.binormal = glm::cross(sample.tangent, sample.normal);
+		return sample;
+	}
+
+	// Gauss-Legendre de 3 pontos em [t0, t1]: exato para |P'| polinomial até grau 5
+	double integrateSpeed(const float* c, double t0, double t1)
+	{
+		const double x = 0.7745966692414834; // sqrt(3/5)
+		double h = 0.5 * (t1 - t0), m = 0.5 * (t1 + t0);
+		return h * (5.0 / 9.0 * speedAt(c, (float)(m - h * x)) + 8.0 / 9.0 * speedAt(c, (float)m) + 5.0 / 9.0 * speedAt(c, (float)(m + h * x)));
+	}
+
+	// Projeção para pixels; false se o ponto está atrás da câmera
+	inline bool toPixels(const AdaptiveTessellation& settings, const glm::vec3& p, glm::vec2& pixel)
+	{
+		glm::vec4 clip = settings.viewProjection * glm::vec4(p, 1.0f);
+		if (clip.w <= 1e-5f) return false;
+		pixel = (glm::vec2(clip) / clip.w * 0.5f + 0.5f) * settings.viewport;
+		return true;
+	}
+
+	template <typename V>
+	float distanceToChord(const V& p, const V& a, const V& b)
+	{
+		V ab = b - a;
+		float len2 = glm::dot(ab, ab);
+		float h = len2 > 0.0f ? glm::clamp(glm::dot(p - a, ab) / len2, 0.0f, 1.0f) : 0.0f;
+		return glm::length(p - (a + h * ab));
+	}
+
+	// Erro de corda do trecho com pontos p0 (início), q1, pm, q3 (1/4, 1/2, 3/4) e p1 (fim)
+	float chordError(const AdaptiveTessellation& settings, const glm::vec3& p0, const glm::vec3& q1, const glm::vec3& pm, const glm::vec3& q3, const glm::vec3& p1)
+	{
+		if (!settings.screenSpace)
+			return max(distanceToChord(pm, p0, p1), max(distanceToChord(q1, p0, p1), distanceToChord(q3, p0, p1)));
+
+		glm::vec2 s[5];
+		const glm::vec3* p[5] = { &p0, &q1, &pm, &q3, &p1 };
+		for (int k = 0; k < 5; k++)
+			if (!toPixels(settings, *p[k], s[k])) return 0.0f; // Trechos atrás da câmera não são refinados
+
+		// Trecho inteiro fora de um dos lados da tela: não aparece, não precisa de pontos
+		glm::vec2 lo = s[0], hi = s[0];
+		for (int k = 1; k < 5; k++)
+		{
+			lo = glm::min(lo, s[k]);
+			hi = glm::max(hi, s[k]);
+		}
+		if (hi.x < 0.0f || hi.y < 0.0f || lo.x > settings.viewport.x || lo.y > settings.viewport.y) return 0.0f;
+
+		return max(distanceToChord(s[2], s[0], s[4]), max(distanceToChord(s[1], s[0], s[4]), distanceToChord(s[3], s[0], s[4])));
+	}
+
+	// Divide [t0, t1] pelo erro de corda e acrescenta a out os pontos de (t0, t1], em ordem.
+	// Pilha explícita: o trecho da direita é empilhado antes, então a saída sai ordenada
+	template <typename Eval>
+	void subdivideAdaptive(Eval eval, const AdaptiveTessellation& settings, float t0, float t1, vector<glm::vec3>& out)
+	{
+		struct Piece
+		{
+			float t0, t1;
+			glm::vec3 p0, pm, p1;
+			int depth;
+		};
+		Piece stack[64];
+		int top = 0;
+		stack[top++] = { t0, t1, eval(t0), eval(0.5f * (t0 + t1)), eval(t1), 0 };
+		while (top > 0)
+		{
+			Piece piece = stack[--top];
+			float tm = 0.5f * (piece.t0 + piece.t1);
+			glm::vec3 q1 = eval(0.5f * (piece.t0 + tm));
+			glm::vec3 q3 = eval(0.5f * (tm + piece.t1));
+
+			if (piece.depth >= settings.maxDepth || top + 2 > 64 ||
+				(piece.depth >= settings.minDepth && chordError(settings, piece.p0, q1, piece.pm, q3, piece.p1) <= settings.tolerance))
+			{
+				out.push_back(piece.p1);
+				continue;
+			}
+			stack[top++] = { tm, piece.t1, piece.pm, q3, piece.p1, piece.depth + 1 };
+			stack[top++] = { piece.t0, tm, piece.p0, q1, piece.pm, piece.depth + 1 };
+		}
+	}
+
+	// Maior distância de pontos densos da curva até a poligonal (força bruta, só para o benchmark)
+	double polylineError(const vector<glm::vec3>& polyline, const vector<glm::vec3>& dense)
+	{
+		double err = 0.0;
+		for (const glm::vec3& p : dense)
+		{
+			float best = numeric_limits<float>::max();
+			for (size_t i = 0; i + 1 < polyline.size(); i++)
+				best = min(best, distanceToChord(p, polyline[i], polyline[i + 1]));
+			err = max(err, (double)best);
+		}
+		return err;
+	}
+
+	// Referência para o benchmark: comprimento exato (em double, 256 intervalos) até t no segmento
+	double exactArcLength(const ArcLengthTable& table, int segment, double t)
+	{
+		const float* c = &table.coeffs[(size_t)segment * CUBIC_SEGMENT_FLOATS];
+		double length = 0.0;
+		for (int s = 0; s < segment; s++)
+			for (int k = 0; k < 256; k++)
+				length += integrateSpeed(&table.coeffs[(size_t)s * CUBIC_SEGMENT_FLOATS], k / 256.0, (k + 1) / 256.0);
+		for (int k = 0; k < 256; k++)
+			length += integrateSpeed(c, t * k / 256.0, t * (k + 1) / 256.0);
+		return length;
+	}
+
+	// G * M do segmento s: coeficientes de t^3, t^2, t e 1 (base de potências)
+	void segmentCoefficients(const Curve& curve, int stride, int s, float* c)
+	{
+		size_t i = (size_t)s * stride;
+		glm::mat4x3 G(curve.controlPoints[i], curve.controlPoints[i + 1], curve.controlPoints[i + 2], curve.controlPoints[i + 3]);
+		glm::mat4x3 C = G * curve.M;
+		for (int k = 0; k < 4; k++)
+		{
+			c[3 * k] = C[k].x;
+			c[3 * k + 1] = C[k].y;
+			c[3 * k + 2] = C[k].z;
+		}
+	}
+
+	// Pontos do segmento em (0, 1]; o primeiro segmento da curva leva também o ponto em t = 0
+	void adaptiveSegmentPoints(const float* c, bool withStart, const AdaptiveTessellation& settings, vector<glm::vec3>& out)
+	{
+		auto eval = [c](float t) { return cubicPosition(c, t); };
+		if (withStart) out.push_back(eval(0.0f));
+		subdivideAdaptive(eval, settings, 0.0f, 1.0f, out);
+	}
+
+	void setFixedSegmentOffsets(Curve& curve, int segments, int numPoints)
+	{
+		numPoints = max(numPoints, 0);
+		curve.pointsPerSegment = numPoints;
+		curve.segmentOffsets.resize((size_t)segments + 1);
+		for (int s = 0; s <= segments; s++) curve.segmentOffsets[s] = s * numPoints;
+	}
+
+	// Segmentos [first, last] a partir de out (o espaço do segmento first). O SSE grava 4 floats
+	// por ponto, então o espaço livre é contado só até o fim do intervalo: os pontos vizinhos,
+	// numa re-tesselação parcial, não são tocados
+	void tessellateSegments(const Curve& curve, int stride, int numPoints, int first, int last, glm::vec3* out, TessellationMethod method)
+	{
+		// Coeficientes por segmento ficam na pilha: a tesselação não aloca nada
+		const float piece = 1.0f / (float)numPoints;
+		const size_t total = (size_t)(last - first + 1) * numPoints;
+		const glm::mat4& M = curve.M;
+		for (int s = first; s <= last; s++)
+		{
+			const glm::vec3* P = &curve.controlPoints[(size_t)s * stride];
+			glm::vec3* dst = out + (size_t)(s - first) * numPoints;
+
+#ifdef CURVE_SSE
+			if (method == TESSELLATE_SIMD)
+			{
+				// G * M com os pontos em registradores: coluna k = soma de P_m * M[k][m]
+				__m128 p0 = _mm_set_ps(0.0f, P[0].z, P[0].y, P[0].x);
+				__m128 p1 = _mm_set_ps(0.0f, P[1].z, P[1].y, P[1].x);
+				__m128 p2 = _mm_set_ps(0.0f, P[2].z, P[2].y, P[2].x);
+				__m128 p3 = _mm_set_ps(0.0f, P[3].z, P[3].y, P[3].x);
+				__m128 C[4];
+				for (int k = 0; k < 4; k++)
+				{
+					C[k] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p0, _mm_set1_ps(M[k][0])), _mm_mul_ps(p1, _mm_set1_ps(M[k][1]))),
+						_mm_add_ps(_mm_mul_ps(p2, _mm_set1_ps(M[k][2])), _mm_mul_ps(p3, _mm_set1_ps(M[k][3]))));
+				}
+				tessellateSegment4(C, piece, numPoints, dst, (size_t)(out + total - dst));
+				continue;
+			}
+#endif
+
+			glm::mat4x3 C = glm::mat4x3(P[0], P[1], P[2], P[3]) * M;
+			const glm::vec3 a = C[0], b = C[1], c = C[2], d = C[3];
+
+			if (method == TESSELLATE_FORWARD_DIFFERENCES)
+			{
+				// Diferenças progressivas de P(t) com passo h: a terceira diferença é constante
+				float h = piece, h2 = h * h, h3 = h2 * h;
+				glm::vec3 p = d;
+				glm::vec3 d1 = a * h3 + b * h2 + c * h;
+				glm::vec3 d2 = 6.0f * a * h3 + 2.0f * b * h2;
+				glm::vec3 d3 = 6.0f * a * h3;
+				for (int j = 0; j < numPoints; j++)
+				{
+					dst[j] = p;
+					p += d1;
+					d1 += d2;
+					d2 += d3;
+				}
+				continue;
+			}
+
+			// Sem SSE: Horner ponto a ponto
+			for (int j = 0; j < numPoints; j++)
+			{
+				float t = j * piece;
+				dst[j] = ((a * t + b) * t + c) * t + d;
+			}
+		}
+	}
+}
+
+void initializeBernsteinMatrix(glm::mat4& matrix)
+{
+	// matrix[0] = glm::vec4(1.0f, -3.0f, 3.0f, -1.0f);
+	// matrix[1] = glm::vec4(0.0f, 3.0f, -6.0f, 3.0f);
+	// matrix[2] = glm::vec4(0.0f, 0.0f, 3.0f, -3.0f);
+	// matrix[3] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+	matrix[0] = glm::vec4(-1.0f, 3.0f, -3.0f, 1.0f); // Primeira coluna
+	matrix[1] = glm::vec4(3.0f, -6.0f, 3.0f, 0.0f);  // Segunda coluna
+	matrix[2] = glm::vec4(-3.0f, 3.0f, 0.0f, 0.0f);  // Terceira coluna
+	matrix[3] = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);   // Quarta coluna
+}
+
+void initializeCatmullRomMatrix(glm::mat4& matrix)
+{
+	// matrix[0] = glm::vec4(-1.0f, 3.0f, -3.0f, 1.0f);
+	// matrix[1] = glm::vec4(2.0f, -5.0f, 4.0f, -1.0f);
+	// matrix[2] = glm::vec4(-1.0f, 0.0f, 1.0f, 0.0f);
+	// matrix[3] = glm::vec4(0.0f, 2.0f, 0.0f, 0.0f);
+
+	matrix[0] = glm::vec4(-0.5f, 1.5f, -1.5f, 0.5f); // Primeira linha
+	matrix[1] = glm::vec4(1.0f, -2.5f, 2.0f, -0.5f); // Segunda linha
+	matrix[2] = glm::vec4(-0.5f, 0.0f, 0.5f, 0.0f);  // Terceira linha
+	matrix[3] = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);   // Quarta linha
+}
+
+void generateBezierCurvePoints(Curve& curve, int numPoints)
+{
+	initializeBernsteinMatrix(curve.M);
+
+	// Bézier por partes: segmentos de 4 pontos que compartilham as pontas
+	curve.curvePoints.resize((size_t)cubicSegmentCount(curve, 3) * max(numPoints, 0));
+	tessellateCubicCurve(curve, 3, numPoints, curve.curvePoints.data());
+	setFixedSegmentOffsets(curve, cubicSegmentCount(curve, 3), numPoints);
+}
+
+void generateCatmullRomCurvePoints(Curve& curve, int numPoints)
+{
+	initializeCatmullRomMatrix(curve.M);
+
+	// Catmull-Rom: um segmento para cada janela de 4 pontos consecutivos
+	curve.curvePoints.resize((size_t)cubicSegmentCount(curve, 1) * max(numPoints, 0));
+	tessellateCubicCurve(curve, 1, numPoints, curve.curvePoints.data());
+	setFixedSegmentOffsets(curve, cubicSegmentCount(curve, 1), numPoints);
+}
+
+int cubicSegmentCount(const Curve& curve, int stride)
+{
+	int n = (int)curve.controlPoints.size();
+	return n < 4 ? 0 : (n - 4) / stride + 1;
+}
+
+int computeCubicCoefficients(const Curve& curve, int stride, vector<float>& coeffs)
+{
+	int segments = cubicSegmentCount(curve, stride);
+	coeffs.resize((size_t)segments * CUBIC_SEGMENT_FLOATS);
+
+	for (int s = 0; s < segments; s++)
+		segmentCoefficients(curve, stride, s, &coeffs[(size_t)s * CUBIC_SEGMENT_FLOATS]);
+	return segments;
+}
+
+void buildArcLengthTable(const Curve& curve, int stride, ArcLengthTable& table)
+{
+	const int K = ARC_LENGTH_SAMPLES;
+	table.segments = computeCubicCoefficients(curve, stride, table.coeffs);
+	table.segmentStart.assign((size_t)table.segments + 1, 0.0f);
+	table.samples.resize((size_t)table.segments * K);
+
+	// Acumula em double: com milhares de segmentos a soma em float perde os centésimos
+	double length = 0.0;
+	for (int s = 0; s < table.segments; s++)
+	{
+		const float* c = &table.coeffs[(size_t)s * CUBIC_SEGMENT_FLOATS];
+		for (int k = 0; k < K; k++)
+		{
+			length += integrateSpeed(c, (double)k / K, (double)(k + 1) / K);
+			table.samples[(size_t)s * K + k] = (float)length;
+		}
+		table.segmentStart[s + 1] = (float)length;
+	}
+
+	// Frames com rotação mínima: a normal de cada segmento é propagada até o fim dele
+	table.startNormals.assign((size_t)table.segments + 1, glm::vec3(0.0f, 0.0f, 1.0f));
+	if (table.segments == 0) return;
+	table.startNormals[0] = initialNormal(unitTangent(cubicDerivative(&table.coeffs[0], 0.0f), glm::vec3(1.0f, 0.0f, 0.0f)));
+	FrameState state;
+	for (int s = 0; s < table.segments; s++)
+		table.startNormals[s + 1] = sampleSegment(table, s, 1.0f, state).normal;
+}
+
+void updateArcLengthTable(const Curve& curve, int stride, ArcLengthTable& table, int first, int last)
+{
+	const int K = ARC_LENGTH_SAMPLES;
+	if (table.segments != cubicSegmentCount(curve, stride) || table.startNormals.size() != (size_t)table.segments + 1)
+	{
+		buildArcLengthTable(curve, stride, table);
+		return;
+	}
+	first = max(first, 0);
+	last = min(last, table.segments - 1);
+	if (first > last) return;
+
+	float oldEnd = table.segmentStart[last + 1];
+	glm::vec3 oldNormal = table.startNormals[last + 1];
+
+	double length = table.segmentStart[first];
+	for (int s = first; s <= last; s++)
+	{
+		float* c = &table.coeffs[(size_t)s * CUBIC_SEGMENT_FLOATS];
+		segmentCoefficients(curve, stride, s, c);
+		for (int k = 0; k < K; k++)
+		{
+			length += integrateSpeed(c, (double)k / K, (double)(k + 1) / K);
+			table.samples[(size_t)s * K + k] = (float)length;
+		}
+		table.segmentStart[s + 1] = (float)length;
+	}
+
+	// Os segmentos seguintes não mudaram de forma, só de posição no comprimento acumulado
+	float shift = (float)(length - oldEnd);
+	if (shift != 0.0f)
+	{
+		for (size_t i = (size_t)(last + 1) * K; i < table.samples.size(); i++) table.samples[i] += shift;
+		for (int s = last + 2; s <= table.segments; s++) table.segmentStart[s] += shift;
+	}
+
+	if (first == 0)
+		table.startNormals[0] = initialNormal(unitTangent(cubicDerivative(&table.coeffs[0], 0.0f), glm::vec3(1.0f, 0.0f, 0.0f)));
+	FrameState state;
+	for (int s = first; s <= last; s++)
+		table.startNormals[s + 1] = sampleSegment(table, s, 1.0f, state).normal;
+	if (last + 1 >= table.segments) return;
+
+	// As reflexões comutam com rotações em torno da tangente: depois do trecho editado cada frame
+	// é o antigo girado pelo ângulo que a edição introduziu no primeiro segmento intacto. Numa
+	// quina entre segmentos (Bézier só C0) isso deixa de valer e o resto é propagado de novo
+	glm::vec3 axis = unitTangent(cubicDerivative(&table.coeffs[(size_t)(last + 1) * CUBIC_SEGMENT_FLOATS], 0.0f), state.tangent);
+	glm::vec3 before = oldNormal - axis * glm::dot(axis, oldNormal);
+	glm::vec3 after = table.startNormals[last + 1] - axis * glm::dot(axis, table.startNormals[last + 1]);
+	float angle = atan2(glm::dot(axis, glm::cross(before, after)), glm::dot(before, after));
+	float cosAngle = cos(angle), sinAngle = sin(angle);
+	for (int s = last + 1; s < table.segments; s++)
+	{
+		const float* c = &table.coeffs[(size_t)s * CUBIC_SEGMENT_FLOATS];
+		if (s > last + 1 && glm::dot(unitTangent(cubicDerivative(c, 0.0f), axis), axis) < 0.99999f)
+		{
+			for (; s < table.segments; s++)
+				table.startNormals[s + 1] = sampleSegment(table, s, 1.0f, state).normal;
+			break;
+		}
+		axis = unitTangent(cubicDerivative(c, 1.0f), axis);
+		glm::vec3& normal = table.startNormals[s + 1];
+		normal = glm::normalize(normal * cosAngle + glm::cross(axis, normal) * sinAngle);
+	}
+}
+
+CurveSample sampleCurve(const ArcLengthTable& table, float t)
+{
+	if (table.segments == 0) return CurveSample();
+	float u = min(max(t, 0.0f), 1.0f) * table.segments;
+	int s = min((int)u, table.segments - 1);
+	FrameState state;
+	CurveSample sample = sampleSegment(table, s, u - s, state);
+	sample.derivative *= (float)table.segments; // dP/dt global = dP/du * segments
+	return sample;
+}
+
+CurveSample sampleCurveAtDistance(const ArcLengthTable& table, float distance)
+{
+	if (table.segments == 0) return CurveSample();
+	int s = -1;
+	float t = arcLengthToParameter(table, distance, s);
+	FrameState state;
+	CurveSample sample = sampleSegment(table, s, t, state);
+	sample.derivative = sample.tangent;
+	return sample;
+}
+
+void sampleCurveBatch(const ArcLengthTable& table, const float* t, size_t count, CurveSample* out)
+{
+	if (table.segments == 0) return;
+	FrameState state;
+	for (size_t i = 0; i < count; i++)
+	{
+		float u = min(max(t[i], 0.0f), 1.0f) * table.segments;
+		int s = min((int)u, table.segments - 1);
+		out[i] = sampleSegment(table, s, u - s, state);
+		out[i].derivative *= (float)table.segments;
+	}
+}
+
+void sampleCurveAtDistanceBatch(const ArcLengthTable& table, const float* distance, size_t count, CurveSample* out)
+{
+	if (table.segments == 0) return;
+	int s = -1;
+	FrameState state;
+	for (size_t i = 0; i < count; i++)
+	{
+		float t = arcLengthToParameter(table, distance[i], s);
+		out[i] = sampleSegment(table, s, t, state);
+		out[i].derivative = out[i].tangent;
+	}
+}
+
+float arcLengthLookup(const ArcLengthTable& table, float distance, int& segment, float& sampleT, float& sampleLength)
+{
+	sampleT = sampleLength = 0.0f;
+	if (table.segments == 0)
+	{
+		segment = 0;
+		return 0.0f;
+	}
+	const float* start = table.segmentStart.data();
+	distance = min(max(distance, 0.0f), start[table.segments]);
+
+	// Agentes andam pouco por quadro: a dica quase sempre é o segmento certo ou o vizinho
+	int s = segment;
+	bool found = s >= 0 && s < table.segments && start[s] <= distance && distance <= start[s + 1];
+	if (!found && s >= 0 && s < table.segments)
+	{
+		for (int step = 0; step < 4 && !found; step++)
+		{
+			if (distance < start[s]) { if (s == 0) break; s--; }
+			else if (distance > start[s + 1]) { if (s == table.segments - 1) break; s++; }
+			else found = true;
+		}
+	}
+	if (!found)
+	{
+		// Último segmento com início <= distance
+		s = (int)(upper_bound(start, start + table.segments, distance) - start) - 1;
+		s = min(max(s, 0), table.segments - 1);
+	}
+	segment = s;
+
+	// Amostras do segmento (contíguas): primeira com comprimento acumulado >= distance,
+	// contando sem desvios quantas ficam antes (a última é o fim do segmento, nunca conta)
+	const int K = ARC_LENGTH_SAMPLES;
+	const float* samples = &table.samples[(size_t)s * K];
+	int k = 0;
+#ifdef CURVE_SSE
+	__m128 d = _mm_set1_ps(distance);
+	__m128i count = _mm_setzero_si128();
+	for (int j = 0; j < K; j += 4)
+		count = _mm_sub_epi32(count, _mm_castps_si128(_mm_cmplt_ps(_mm_loadu_ps(samples + j), d)));
+	count = _mm_add_epi32(count, _mm_shuffle_epi32(count, _MM_SHUFFLE(1, 0, 3, 2)));
+	count = _mm_add_epi32(count, _mm_shuffle_epi32(count, _MM_SHUFFLE(2, 3, 0, 1)));
+	k = min(_mm_cvtsi128_si32(count), K - 1);
+#else
+	for (int j = 0; j < K - 1; j++) k += samples[j] < distance;
+#endif
+	float s0 = k == 0 ? start[s] : samples[k - 1];
+	float s1 = samples[k];
+	sampleT = (float)k / K;
+	sampleLength = s0;
+	return s1 > s0 ? sampleT + (distance - s0) / ((s1 - s0) * K) : sampleT;
+}
+
+float arcLengthToParameter(const ArcLengthTable& table, float distance, int& segment)
+{
+	float t0, s0;
+	float t = arcLengthLookup(table, distance, segment, t0, s0);
+	if (table.segments == 0) return t;
+	distance = min(max(distance, 0.0f), table.length());
+	const int s = segment;
+	const float t1 = t0 + 1.0f / ARC_LENGTH_SAMPLES;
+
+	// Um passo de Newton em f(t) = L(t) - distance, com L(t) - s0 por Simpson e f'(t) = |P'(t)|
+	const float* c = &table.coeffs[(size_t)s * CUBIC_SEGMENT_FLOATS];
+	float speed = speedAt(c, t);
+	if (speed > 1e-6f)
+	{
+		float L = s0 + (t - t0) / 6.0f * (speedAt(c, t0) + 4.0f * speedAt(c, 0.5f * (t0 + t)) + speed);
+		t = min(max(t - (L - distance) / speed, t0), t1);
+	}
+	return t;
+}
+
+float parameterToArcLength(const ArcLengthTable& table, int segment, float t)
+{
+	const int K = ARC_LENGTH_SAMPLES;
+	if (table.segments == 0) return 0.0f;
+	segment = min(max(segment, 0), table.segments - 1);
+	t = min(max(t, 0.0f), 1.0f);
+
+	// Amostra anterior da tabela mais a integral do pedaço que falta (menos de 1 / K do segmento)
+	int k = min((int)(t * K), K - 1);
+	float before = k == 0 ? table.segmentStart[segment] : table.samples[(size_t)segment * K + k - 1];
+	return before + (float)integrateSpeed(&table.coeffs[(size_t)segment * CUBIC_SEGMENT_FLOATS], (double)k / K, t);
+}
+
+void generateAdaptiveCurvePoints(Curve& curve, int stride, const AdaptiveTessellation& settings)
+{
+	vector<float> coeffs;
+	int segments = computeCubicCoefficients(curve, stride, coeffs);
+	curve.curvePoints.clear();
+	curve.pointsPerSegment = 0;
+	curve.segmentOffsets.assign((size_t)segments + 1, 0);
+	if (segments == 0) return;
+
+	for (int s = 0; s < segments; s++)
+	{
+		adaptiveSegmentPoints(&coeffs[(size_t)s * CUBIC_SEGMENT_FLOATS], s == 0, settings, curve.curvePoints);
+		curve.segmentOffsets[s + 1] = (int)curve.curvePoints.size();
+	}
+	curve.tessellationViewProjection = settings.viewProjection;
+}
+
+void generateAdaptiveGlobalBezierCurvePoints(Curve& curve, const AdaptiveTessellation& settings)
+{
+	curve.curvePoints.clear();
+	curve.segmentOffsets.clear();
+	curve.pointsPerSegment = 0;
+	if (curve.controlPoints.empty()) return;
+
+	BezierEvaluator evaluator;
+	initBezierEvaluator(evaluator, curve.controlPoints);
+	auto eval = [&evaluator](float t) { return evaluateBezier(evaluator, t); };
+
+	// O polinômio global varia muito mais que um segmento cúbico: começa com um trecho por ponto
+	// de controle para não perder voltas da curva
+	int pieces = max((int)curve.controlPoints.size() - 1, 1);
+	curve.curvePoints.push_back(eval(0.0f));
+	for (int k = 0; k < pieces; k++)
+		subdivideAdaptive(eval, settings, (float)k / pieces, (float)(k + 1) / pieces, curve.curvePoints);
+	curve.tessellationViewProjection = settings.viewProjection;
+}
+
+bool needsRetessellation(const Curve& curve, const AdaptiveTessellation& settings)
+{
+	if (!settings.screenSpace || curve.controlPoints.empty()) return false;
+	if (curve.curvePoints.empty()) return true;
+
+	glm::vec3 lo = curve.controlPoints[0], hi = curve.controlPoints[0];
+	for (const glm::vec3& p : curve.controlPoints)
+	{
+		lo = glm::min(lo, p);
+		hi = glm::max(hi, p);
+	}
+
+	// Diagonal da caixa projetada com cada câmera; um canto atrás da câmera força nova tesselação
+	AdaptiveTessellation previous = settings;
+	previous.viewProjection = curve.tessellationViewProjection;
+	float size[2];
+	const AdaptiveTessellation* cameras[2] = { &previous, &settings };
+	for (int c = 0; c < 2; c++)
+	{
+		glm::vec2 smin(numeric_limits<float>::max()), smax(-numeric_limits<float>::max());
+		for (int k = 0; k < 8; k++)
+		{
+			glm::vec3 corner((k & 1) ? hi.x : lo.x, (k & 2) ? hi.y : lo.y, (k & 4) ? hi.z : lo.z);
+			glm::vec2 pixel;
+			if (!toPixels(*cameras[c], corner, pixel)) return curve.tessellationViewProjection != settings.viewProjection;
+			smin = glm::min(smin, pixel);
+			smax = glm::max(smax, pixel);
+		}
+		size[c] = glm::length(smax - smin);
+	}
+	if (size[0] <= 0.0f) return size[1] > 0.0f;
+	float ratio = size[1] / size[0];
+	return ratio > 1.0f + settings.retessellateScale || ratio < 1.0f / (1.0f + settings.retessellateScale);
+}
+
+void dirtySegmentRange(const Curve& curve, int stride, int index, int& first, int& last)
+{
+	// O segmento s usa os pontos s * stride até s * stride + 3
+	int segments = cubicSegmentCount(curve, stride);
+	first = max((index - 3 + stride - 1) / stride, 0);
+	last = min(index / stride, segments - 1);
+}
+
+void moveControlPoint(Curve& curve, int stride, int index, const glm::vec3& point)
+{
+	if (index < 0 || index >= (int)curve.controlPoints.size()) return;
+	curve.controlPoints[index] = point;
+
+	int first, last;
+	dirtySegmentRange(curve, stride, index, first, last);
+	if (first > last) return;
+	if (curve.dirtyFirst > curve.dirtyLast)
+	{
+		curve.dirtyFirst = first;
+		curve.dirtyLast = last;
+		return;
+	}
+	curve.dirtyFirst = min(curve.dirtyFirst, first);
+	curve.dirtyLast = max(curve.dirtyLast, last);
+}
+
+bool takeDirtySegments(Curve& curve, int& first, int& last)
+{
+	first = curve.dirtyFirst;
+	last = curve.dirtyLast;
+	curve.dirtyFirst = 0;
+	curve.dirtyLast = -1;
+	return first <= last;
+}
+
+CurvePointsUpdate retessellateCurveSegments(Curve& curve, int stride, const AdaptiveTessellation& settings, int first, int last)
+{
+	CurvePointsUpdate update;
+	int segments = cubicSegmentCount(curve, stride);
+	first = max(first, 0);
+	last = min(last, segments - 1);
+	if (first > last) return update;
+
+	// Layout desconhecido (Bézier global, curva que mudou de tamanho): refaz tudo
+	vector<int>& offsets = curve.segmentOffsets;
+	if (offsets.size() != (size_t)segments + 1 || offsets.back() != (int)curve.curvePoints.size())
+	{
+		if (curve.pointsPerSegment > 0)
+		{
+			curve.curvePoints.resize((size_t)segments * curve.pointsPerSegment);
+			tessellateCubicCurve(curve, stride, curve.pointsPerSegment, curve.curvePoints.data());
+			setFixedSegmentOffsets(curve, segments, curve.pointsPerSegment);
+		}
+		else
+		{
+			glm::mat4 camera = curve.tessellationViewProjection;
+			generateAdaptiveCurvePoints(curve, stride, settings);
+			curve.tessellationViewProjection = camera;
+		}
+		update.count = curve.curvePoints.size();
+		update.resized = true;
+		return update;
+	}
+
+	// Nro fixo de pontos: o trecho é reescrito no lugar
+	update.first = (size_t)offsets[first];
+	if (curve.pointsPerSegment > 0)
+	{
+		update.count = (size_t)(last - first + 1) * curve.pointsPerSegment;
+		tessellateSegments(curve, stride, curve.pointsPerSegment, first, last, &curve.curvePoints[update.first], TESSELLATE_SIMD);
+		return update;
+	}
+
+	// Adaptativa: o trecho pode ganhar ou perder pontos. A câmera guardada para needsRetessellation
+	// continua a da última tesselação completa
+	vector<glm::vec3> points;
+	vector<int> ends(last - first + 1);
+	float c[CUBIC_SEGMENT_FLOATS];
+	for (int s = first; s <= last; s++)
+	{
+		segmentCoefficients(curve, stride, s, c);
+		adaptiveSegmentPoints(c, s == 0, settings, points);
+		ends[s - first] = (int)points.size();
+	}
+
+	size_t oldCount = (size_t)(offsets[last + 1] - offsets[first]);
+	if (points.size() == oldCount)
+	{
+		copy(points.begin(), points.end(), curve.curvePoints.begin() + update.first);
+		update.count = points.size();
+	}
+	else
+	{
+		curve.curvePoints.erase(curve.curvePoints.begin() + update.first, curve.curvePoints.begin() + update.first + oldCount);
+		curve.curvePoints.insert(curve.curvePoints.begin() + update.first, points.begin(), points.end());
+		int shift = (int)points.size() - (int)oldCount;
+		for (int s = last + 2; s <= segments; s++) offsets[s] += shift;
+		update.count = curve.curvePoints.size() - update.first;
+		update.resized = true;
+	}
+	for (int s = first; s <= last; s++) offsets[s + 1] = offsets[first] + ends[s - first];
+	return update;
+}
+
+void tessellateCubicCurve(const Curve& curve, int stride, int numPoints, glm::vec3* out, TessellationMethod method)
+{
+	int segments = cubicSegmentCount(curve, stride);
+	if (segments == 0 || numPoints <= 0) return;
+	tessellateSegments(curve, stride, numPoints, 0, segments - 1, out, method);
+}
+
+
+std::vector<glm::vec3> generateHeartControlPoints(int numPoints)
+{
+	std::vector<glm::vec3> controlPoints;
+
+	// Define o intervalo para t: de 0 a 2 * PI, dividido em numPoints
+	float step = 2 * 3.14159 / (numPoints - 1);
+
+	for (int i = 0; i < numPoints - 1; i++)
+	{
+		float t = i * step;
+
+		// Calcula x(t) e y(t) usando as fórmulas paramétricas
+		float x = 16 * pow(sin(t), 3);
+		float z = 13 * cos(t) - 5 * cos(2 * t) - 2 * cos(3 * t) - cos(4 * t);
+
+		// Normaliza os pontos para mantê-los dentro de [-1, 1] no espaço 3D
+		x /= 8.0f; // Dividir por 16 para normalizar x entre -1 e 1
+		z /= 8.0f; // Dividir por 16 para normalizar y aproximadamente entre -1 e 1
+		z += 0.15;
+		// Adiciona o ponto ao vetor de pontos de controle
+		//controlPoints.push_back(glm::vec3(x, y, 0.0f));
+		controlPoints.push_back(glm::vec3(x, z, 0.0f));
+	}
+	controlPoints.push_back(controlPoints[0]);
+
+	return controlPoints;
+}
+
+void generateGlobalBezierCurvePoints(Curve& curve, int numPoints)
+{
+	curve.curvePoints.clear(); // Limpa quaisquer pontos antigos da curva
+	curve.segmentOffsets.clear(); // Todo ponto de controle afeta a curva inteira: sem edição por segmento
+	curve.pointsPerSegment = 0;
+	if (curve.controlPoints.empty() || numPoints <= 0) return;
+
+	BezierEvaluator evaluator;
+	initBezierEvaluator(evaluator, curve.controlPoints);
+
+	// numPoints + 1 amostras uniformes em [0, 1], avaliadas em lote
+	vector<float> t(numPoints + 1);
+	float piece = 1.0f / (float)numPoints;
+	for (int j = 0; j <= numPoints; ++j) t[j] = j * piece;
+
+	curve.curvePoints.resize(t.size());
+	evaluateBezierBatch(evaluator, t.data(), t.size(), curve.curvePoints.data());
+}
+
+std::vector<glm::vec3> generateInfinityControlPoints(int numPoints) {
+	std::vector<glm::vec3> controlPoints;
+
+	// Define o intervalo para t: de 0 a 2 * PI, dividido em numPoints
+	float step = 2 * 3.14159f / numPoints;
+
+	// Constante que define o "tamanho" do símbolo
+	float a = 4.0f; // Ajuste para aumentar ou diminuir o símbolo
+
+	for (int i = 0; i < numPoints; ++i) {
+		float t = i * step;
+
+		// Fórmulas paramétricas para a lemniscata de Bernoulli
+		float x = (a * sqrt(2) * cos(t)) / (sin(t) * sin(t) + 1);
+		float y = (a * sqrt(2) * cos(t) * sin(t)) / (sin(t) * sin(t) + 1);
+
+		// Adiciona o ponto no plano XY
+		controlPoints.push_back(glm::vec3(x, y, 0.0f));
+	}
+
+	// Fecha o loop conectando o último ponto ao primeiro
+	controlPoints.push_back(controlPoints[0]);
+
+	return controlPoints;
+}
+
+void initBezierEvaluator(BezierEvaluator& evaluator, const vector<glm::vec3>& controlPoints, BezierMethod method)
+{
+	int n = (int)controlPoints.size() - 1;
+	evaluator.degree = n;
+	evaluator.x.resize(n + 1);
+	evaluator.y.resize(n + 1);
+	evaluator.z.resize(n + 1);
+	for (int i = 0; i <= n; i++)
+	{
+		evaluator.x[i] = controlPoints[i].x;
+		evaluator.y[i] = controlPoints[i].y;
+		evaluator.z[i] = controlPoints[i].z;
+	}
+
+	// Horner é o mais rápido enquanto os binomiais cabem no float; depois disso só de Casteljau
+	if (method == BEZIER_AUTO)
+		method = n <= BEZIER_MAX_BINOMIAL_DEGREE ? BEZIER_HORNER : BEZIER_DE_CASTELJAU;
+	else if (method != BEZIER_DE_CASTELJAU && n > BEZIER_MAX_BINOMIAL_DEGREE)
+	{
+		cout << "Bezier de grau " << n << ": binomiais estouram o float, usando de Casteljau" << endl;
+		method = BEZIER_DE_CASTELJAU;
+	}
+	evaluator.method = method;
+
+	// Linha n do triângulo de Pascal pela recorrência C(n, i) = C(n, i - 1) * (n - i + 1) / i
+	evaluator.binomial.assign(max(n + 1, 0), 1.0f);
+	double c = 1.0;
+	for (int i = 1; i <= n; i++)
+	{
+		c = c * (n - i + 1) / i;
+		evaluator.binomial[i] = (float)c;
+	}
+
+	evaluator.wx.resize(n + 1);
+	evaluator.wy.resize(n + 1);
+	evaluator.wz.resize(n + 1);
+	for (int i = 0; i <= n; i++)
+	{
+		evaluator.wx[i] = evaluator.binomial[i] * evaluator.x[i];
+		evaluator.wy[i] = evaluator.binomial[i] * evaluator.y[i];
+		evaluator.wz[i] = evaluator.binomial[i] * evaluator.z[i];
+	}
+}
+
+glm::vec3 evaluateBezier(const BezierEvaluator& evaluator, float t)
+{
+	if (evaluator.degree < 0) return glm::vec3(0.0f);
+	if (evaluator.degree == 0) return glm::vec3(evaluator.x[0], evaluator.y[0], evaluator.z[0]);
+
+	vector<float> scratch;
+	switch (evaluator.method)
+	{
+	case BEZIER_HORNER:
+		return evaluateHorner(evaluator, t);
+	case BEZIER_BINOMIAL:
+		scratch.resize(evaluator.degree + 1);
+		return evaluateBinomial(evaluator, t, scratch);
+	default:
+		scratch.resize(3 * (evaluator.degree + 1));
+		return evaluateDeCasteljau(evaluator, t, scratch);
+	}
+}
+
+void evaluateBezierBatch(const BezierEvaluator& evaluator, const float* t, size_t count, glm::vec3* out)
+{
+	const int n = evaluator.degree;
+	if (n <= 0)
+	{
+		for (size_t i = 0; i < count; i++) out[i] = evaluateBezier(evaluator, t[i]);
+		return;
+	}
+
+	const BezierMethod method = evaluator.method;
+	vector<float> scratch(method == BEZIER_DE_CASTELJAU ? 3 * (n + 1) : n + 1);
+	size_t i = 0;
+#ifdef CURVE_SSE
+	// Área de trabalho das 4 lanes (o malloc alinha em 16 bytes nas plataformas x64)
+	vector<float> scratchLanes(4 * scratch.size());
+	__m128* scratch4 = (__m128*)scratchLanes.data();
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 px, py, pz;
+		__m128 t4 = _mm_loadu_ps(t + i);
+		if (method == BEZIER_HORNER)
+		{
+			if (!evaluateHorner4(evaluator, t4, px, py, pz))
+			{
+				for (int k = 0; k < 4; k++) out[i + k] = evaluateHorner(evaluator, t[i + k]);
+				continue;
+			}
+		}
+		else if (method == BEZIER_BINOMIAL)
+			evaluateBinomial4(evaluator, t4, scratch4, px, py, pz);
+		else
+			evaluateDeCasteljau4(evaluator, t4, scratch4, px, py, pz);
+
+		alignas(16) float x[4], y[4], z[4];
+		_mm_store_ps(x, px);
+		_mm_store_ps(y, py);
+		_mm_store_ps(z, pz);
+		for (int k = 0; k < 4; k++) out[i + k] = glm::vec3(x[k], y[k], z[k]);
+	}
+#endif
+
+	// Resto do lote (ou tudo, sem SSE)
+	for (; i < count; i++)
+	{
+		if (method == BEZIER_HORNER) out[i] = evaluateHorner(evaluator, t[i]);
+		else if (method == BEZIER_BINOMIAL) out[i] = evaluateBinomial(evaluator, t[i], scratch);
+		else out[i] = evaluateDeCasteljau(evaluator, t[i], scratch);
+	}
+}
+
+void benchmarkCurves()
+{
+	cout << fixed << setprecision(3);
+	cout << "==== Benchmark de curvas ====" << endl;
+
+	// Bézier global sobre trechos da lemniscata: de grau 3 até além do limite dos binomiais em float
+	// (a cena usa 101 pontos => grau 100)
+	const int samples = 1000;
+	const int repeats = 20;
+	int sizes[] = { 4, 9, 33, 101, 161 };
+	vector<glm::vec3> lemniscate = generateInfinityControlPoints(200);
+	for (int numControl : sizes)
+	{
+		Curve curve;
+		curve.controlPoints.assign(lemniscate.begin(), lemniscate.begin() + min((size_t)numControl, lemniscate.size()));
+
+		vector<glm::dvec3> exact(samples + 1);
+		for (int j = 0; j <= samples; j++) exact[j] = exactBezier(curve.controlPoints, (double)j / samples);
+
+		auto start = chrono::high_resolution_clock::now();
+		for (int r = 0; r < repeats; r++) referenceGlobalBezierCurvePoints(curve, samples);
+		double referenceUs = elapsedUs(start) / repeats;
+		double referenceErr = maxError(curve.curvePoints, exact);
+
+		cout << "Grau " << numControl - 1 << ", " << samples + 1 << " amostras:" << endl;
+		cout << "  tgamma/pow (original): " << setw(10) << referenceUs << " us  erro max " << scientific << referenceErr << fixed << endl;
+
+		vector<float> t(samples + 1);
+		for (int j = 0; j <= samples; j++) t[j] = j * (1.0f / samples);
+		vector<glm::vec3> points(t.size());
+
+		const char* names[] = { "auto", "Horner", "binomiais", "de Casteljau" };
+		for (int m = BEZIER_AUTO; m <= BEZIER_DE_CASTELJAU; m++)
+		{
+			BezierEvaluator evaluator;
+			initBezierEvaluator(evaluator, curve.controlPoints, (BezierMethod)m);
+			start = chrono::high_resolution_clock::now();
+			for (int r = 0; r < repeats; r++) evaluateBezierBatch(evaluator, t.data(), t.size(), points.data());
+			double us = elapsedUs(start) / repeats;
+			cout << "  " << setw(22) << left << names[m] << right << setw(10) << us << " us  erro max " << scientific << maxError(points, exact) << fixed
+				<< "  (" << referenceUs / us << "x)" << endl;
+		}
+	}
+
+	// Tesselação de cúbicas por partes: trilho longo de Catmull-Rom (milhares de segmentos)
+	int pointsPerSegment[] = { 10, 100 };
+	for (int numPoints : pointsPerSegment)
+	{
+		Curve rail;
+		rail.controlPoints = generateInfinityControlPoints(4000);
+		initializeCatmullRomMatrix(rail.M);
+		int segments = cubicSegmentCount(rail, 1);
+
+		// Referência em double, direto da forma matricial
+		vector<glm::dvec3> exact;
+		exact.reserve((size_t)segments * numPoints);
+		glm::dmat4 M(rail.M);
+		for (int s = 0; s < segments; s++)
+		{
+			glm::dmat4x3 G(glm::dvec3(rail.controlPoints[s]), glm::dvec3(rail.controlPoints[s + 1]), glm::dvec3(rail.controlPoints[s + 2]), glm::dvec3(rail.controlPoints[s + 3]));
+			for (int j = 0; j < numPoints; j++)
+			{
+				double t = (double)(j * (1.0f / numPoints));
+				exact.push_back(G * M * glm::dvec4(t * t * t, t * t, t, 1.0));
+			}
+		}
+
+		auto start = chrono::high_resolution_clock::now();
+		for (int r = 0; r < repeats; r++) referenceCubicCurvePoints(rail, 1, numPoints);
+		double referenceUs = elapsedUs(start) / repeats;
+		double referenceErr = maxError(rail.curvePoints, exact);
+
+		cout << "Catmull-Rom, " << segments << " segmentos x " << numPoints << " pontos:" << endl;
+		cout << "  G*M*T (original):      " << setw(10) << referenceUs << " us  erro max " << scientific << referenceErr << fixed << endl;
+
+		vector<glm::vec3> points(exact.size());
+		const char* names[] = { "diferencas progressivas", "SIMD" };
+		for (int m = TESSELLATE_FORWARD_DIFFERENCES; m <= TESSELLATE_SIMD; m++)
+		{
+			start = chrono::high_resolution_clock::now();
+			for (int r = 0; r < repeats; r++) tessellateCubicCurve(rail, 1, numPoints, points.data(), (TessellationMethod)m);
+			double us = elapsedUs(start) / repeats;
+			cout << "  " << setw(22) << left << names[m] << right << setw(10) << us << " us  erro max " << scientific << maxError(points, exact) << fixed
+				<< "  (" << referenceUs / us << "x)" << endl;
+		}
+	}
+
+	// Comprimento de arco na lemniscata da cena (Catmull-Rom com as pontas duplicadas)
+	{
+		Curve scene;
+		vector<glm::vec3> points = generateInfinityControlPoints(100);
+		scene.controlPoints.push_back(points.front());
+		scene.controlPoints.insert(scene.controlPoints.end(), points.begin(), points.end());
+		scene.controlPoints.push_back(points.back());
+		initializeCatmullRomMatrix(scene.M);
+
+		auto start = chrono::high_resolution_clock::now();
+		buildArcLengthTable(scene, 1, scene.arcLength);
+		double buildUs = elapsedUs(start);
+		const ArcLengthTable& table = scene.arcLength;
+		float length = table.length();
+
+		// Velocidade em unidades por segundo andando 1 segmento/s em t uniforme, e a mesma medida
+		// andando length / segments unidades/s pela tabela
+		const int steps = 20000;
+		float minUniform = numeric_limits<float>::max(), maxUniform = 0.0f;
+		float minArc = numeric_limits<float>::max(), maxArc = 0.0f;
+		int hint = -1;
+		glm::vec3 previous(0.0f);
+		for (int j = 0; j <= steps; j++)
+		{
+			float u = (float)j * table.segments / steps;
+			int seg = min((int)u, table.segments - 1);
+			float v = speedAt(&table.coeffs[(size_t)seg * CUBIC_SEGMENT_FLOATS], u - seg);
+			minUniform = min(minUniform, v);
+			maxUniform = max(maxUniform, v);
+
+			float t = arcLengthToParameter(table, (float)j * length / steps, hint);
+			const float* c = &table.coeffs[(size_t)hint * CUBIC_SEGMENT_FLOATS];
+			glm::vec3 p(((c[0] * t + c[3]) * t + c[6]) * t + c[9], ((c[1] * t + c[4]) * t + c[7]) * t + c[10], ((c[2] * t + c[5]) * t + c[8]) * t + c[11]);
+			if (j > 0)
+			{
+				float step = glm::length(p - previous) * steps / length; // 1 = passo esperado
+				minArc = min(minArc, step);
+				maxArc = max(maxArc, step);
+			}
+			previous = p;
+		}
+
+		// Erro da inversão contra a integral em double
+		double arcErr = 0.0;
+		for (int j = 0; j <= 200; j++)
+		{
+			float d = (float)j * length / 200;
+			int seg = -1;
+			float t = arcLengthToParameter(table, d, seg);
+			arcErr = max(arcErr, fabs(exactArcLength(table, seg, t) - d));
+		}
+
+		cout << "Comprimento de arco, lemniscata da cena (" << table.segments << " segmentos, comprimento " << length << "):" << endl;
+		cout << "  tabela: " << buildUs << " us, " << (table.samples.size() + table.segmentStart.size()) * sizeof(float) << " bytes" << endl;
+		cout << "  t uniforme: velocidade de " << minUniform << " a " << maxUniform << " unidades por segmento (" << maxUniform / minUniform << "x)" << endl;
+		cout << "  pela tabela: passo de " << minArc << " a " << maxArc << " do esperado, erro max " << scientific << arcErr << fixed << endl;
+	}
+
+	// Tesselação adaptativa contra o nro fixo de pontos da cena, com o erro medido contra a curva densa
+	{
+		vector<glm::vec3> points = generateInfinityControlPoints(100);
+		Curve catmull, bezier;
+		catmull.controlPoints.push_back(points.front());
+		catmull.controlPoints.insert(catmull.controlPoints.end(), points.begin(), points.end());
+		catmull.controlPoints.push_back(points.back());
+		bezier.controlPoints = points;
+
+		generateCatmullRomCurvePoints(catmull, 100);
+		vector<glm::vec3> denseCatmull = catmull.curvePoints;
+		generateGlobalBezierCurvePoints(bezier, 10000);
+		vector<glm::vec3> denseBezier = bezier.curvePoints;
+
+		generateCatmullRomCurvePoints(catmull, 10);
+		generateGlobalBezierCurvePoints(bezier, 100);
+		cout << "Tesselacao adaptativa (erro de corda medido contra a curva densa):" << endl;
+		cout << "  Catmull-Rom fixa (10/segmento): " << setw(6) << catmull.curvePoints.size() << " pontos  erro " << scientific << polylineError(catmull.curvePoints, denseCatmull) << fixed << endl;
+		cout << "  Bezier global fixa (100):       " << setw(6) << bezier.curvePoints.size() << " pontos  erro " << scientific << polylineError(bezier.curvePoints, denseBezier) << fixed << endl;
+
+		float tolerances[] = { 1e-2f, 1e-3f, 1e-4f };
+		for (float tolerance : tolerances)
+		{
+			AdaptiveTessellation settings;
+			settings.tolerance = tolerance;
+			auto start = chrono::high_resolution_clock::now();
+			generateAdaptiveCurvePoints(catmull, 1, settings);
+			double catmullUs = elapsedUs(start);
+			start = chrono::high_resolution_clock::now();
+			generateAdaptiveGlobalBezierCurvePoints(bezier, settings);
+			double bezierUs = elapsedUs(start);
+			cout << "  tolerancia " << scientific << setprecision(0) << tolerance << fixed << setprecision(3) << ":" << endl;
+			cout << "    Catmull-Rom: " << setw(6) << catmull.curvePoints.size() << " pontos  erro " << scientific << polylineError(catmull.curvePoints, denseCatmull) << fixed << "  " << catmullUs << " us" << endl;
+			cout << "    Bezier:      " << setw(6) << bezier.curvePoints.size() << " pontos  erro " << scientific << polylineError(bezier.curvePoints, denseBezier) << fixed << "  " << bezierUs << " us" << endl;
+		}
+
+		// Em pixels, com a câmera da cena, e aproximando a câmera até pedir nova tesselação
+		AdaptiveTessellation settings;
+		settings.screenSpace = true;
+		settings.tolerance = 0.1f;
+		settings.viewport = glm::vec2(1000.0f);
+		glm::mat4 projection = glm::perspective(glm::radians(39.6f), 1.0f, 0.1f, 100.0f);
+		settings.viewProjection = projection * glm::lookAt(glm::vec3(0.0f, 0.0f, 15.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		initializeCatmullRomMatrix(catmull.M);
+		generateAdaptiveCurvePoints(catmull, 1, settings);
+		cout << "  0.1 pixel, camera a 15 unidades: " << catmull.curvePoints.size() << " pontos" << endl;
+		for (float z = 14.5f; z > 1.0f; z -= 0.5f)
+		{
+			settings.viewProjection = projection * glm::lookAt(glm::vec3(0.0f, 0.0f, z), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+			if (!needsRetessellation(catmull, settings)) continue;
+			generateAdaptiveCurvePoints(catmull, 1, settings);
+			cout << "  re-tesselada com a camera a " << z << " unidades: " << catmull.curvePoints.size() << " pontos" << endl;
+		}
+	}
+
+	// Custo da busca no trilho longo: binária a cada consulta e com dica (agentes andando)
+	{
+		Curve rail;
+		rail.controlPoints = generateInfinityControlPoints(4000);
+		initializeCatmullRomMatrix(rail.M);
+		buildArcLengthTable(rail, 1, rail.arcLength);
+		const ArcLengthTable& table = rail.arcLength;
+
+		const int lookups = 1000000;
+		vector<float> distances(lookups);
+		unsigned state = 12345u;
+		for (float& d : distances)
+		{
+			state = state * 1664525u + 1013904223u;
+			d = (state >> 8) * (1.0f / 16777216.0f) * table.length();
+		}
+
+		float sink = 0.0f;
+		auto start = chrono::high_resolution_clock::now();
+		for (float d : distances)
+		{
+			int seg = -1;
+			sink += arcLengthToParameter(table, d, seg);
+		}
+		double randomNs = elapsedUs(start) * 1000.0 / lookups;
+
+		int hint = 0;
+		start = chrono::high_resolution_clock::now();
+		for (int j = 0; j < lookups; j++)
+			sink += arcLengthToParameter(table, (float)j * table.length() / lookups, hint);
+		double sequentialNs = elapsedUs(start) * 1000.0 / lookups;
+
+		cout << "Busca no comprimento de arco (" << table.segments << " segmentos):" << endl;
+		cout << "  aleatoria (binaria): " << randomNs << " ns  sequencial (dica): " << sequentialNs << " ns  (" << (sink > 0.0f ? "ok" : "-") << ")" << endl;
+	}
+
+	// Edição de um ponto no trilho longo: só os segmentos vizinhos contra refazer a curva toda,
+	// conferindo que o resultado é o mesmo
+	{
+		Curve rail;
+		rail.controlPoints = generateInfinityControlPoints(4000);
+		AdaptiveTessellation settings;
+		settings.tolerance = 1e-3f;
+		initializeCatmullRomMatrix(rail.M);
+		generateAdaptiveCurvePoints(rail, 1, settings);
+		buildArcLengthTable(rail, 1, rail.arcLength);
+
+		const int edits = 100;
+		double incrementalUs = 0.0, fullUs = 0.0, pointErr = 0.0, lengthErr = 0.0;
+		size_t uploaded = 0;
+		for (int e = 0; e < edits; e++)
+		{
+			int index = 1 + (e * 397) % ((int)rail.controlPoints.size() - 2);
+			moveControlPoint(rail, 1, index, rail.controlPoints[index] + glm::vec3(0.0f, 0.0f, 0.1f));
+			int first, last;
+			takeDirtySegments(rail, first, last);
+
+			auto start = chrono::high_resolution_clock::now();
+			CurvePointsUpdate update = retessellateCurveSegments(rail, 1, settings, first, last);
+			updateArcLengthTable(rail, 1, rail.arcLength, first, last);
+			incrementalUs += elapsedUs(start);
+			uploaded += update.count;
+
+			Curve full = rail;
+			start = chrono::high_resolution_clock::now();
+			generateAdaptiveCurvePoints(full, 1, settings);
+			buildArcLengthTable(full, 1, full.arcLength);
+			fullUs += elapsedUs(start);
+
+			for (size_t i = 0; i < full.curvePoints.size() && full.curvePoints.size() == rail.curvePoints.size(); i++)
+				pointErr = max(pointErr, (double)glm::length(full.curvePoints[i] - rail.curvePoints[i]));
+			if (full.curvePoints.size() != rail.curvePoints.size()) pointErr = numeric_limits<double>::infinity();
+			lengthErr = max(lengthErr, (double)fabs(full.arcLength.length() - rail.arcLength.length()));
+		}
+
+		cout << "Edicao de um ponto (" << rail.arcLength.segments << " segmentos, " << rail.curvePoints.size() << " pontos):" << endl;
+		cout << "  incremental: " << incrementalUs / edits << " us  completa: " << fullUs / edits << " us" << endl;
+		cout << "  enviados por edicao: " << uploaded / edits << " pontos  diferenca: pontos " << scientific << pointErr << ", comprimento " << lengthErr << fixed << endl;
+	}
+	cout << defaultfloat;
+}
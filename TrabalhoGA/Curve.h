@@ -0,0 +1,169 @@
+// Curvas paramétricas (Bézier e Catmull-Rom) e geradores de pontos de controle
+
+#pragma once
+
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+// Floats por segmento cúbico na base de potências: a, b, c, d (xyz) de P(t) = ((a t + b) t + c) t + d
+const int CUBIC_SEGMENT_FLOATS = 12;
+
+// Amostras de comprimento por segmento: 16 floats = uma linha de cache, comparadas sem laço
+const int ARC_LENGTH_SAMPLES = 16;
+
+// Comprimento de arco acumulado de uma curva cúbica por partes, para percorrê-la com velocidade
+// constante. A busca é em dois níveis: binária no início dos segmentos e linear nas amostras
+// contíguas do segmento, seguida de um passo de Newton. Guarda também a normal do frame com
+// rotação mínima no início de cada segmento, para sampleCurve propagar só dentro do segmento.
+struct ArcLengthTable
+{
+	int segments = 0;
+	std::vector<float> coeffs;        // Base de potências, CUBIC_SEGMENT_FLOATS por segmento
+	std::vector<float> segmentStart;  // Comprimento acumulado no início de cada segmento (segments + 1 valores)
+	std::vector<float> samples;       // Comprimento acumulado em t = (k + 1) / ARC_LENGTH_SAMPLES, por segmento
+	std::vector<glm::vec3> startNormals; // Normal do frame no início de cada segmento (segments + 1 valores)
+
+	float length() const { return segmentStart.empty() ? 0.0f : segmentStart.back(); }
+};
+
+// Amostra analítica da curva: posição, derivada e frame com rotação mínima
+struct CurveSample
+{
+	glm::vec3 position;
+	glm::vec3 derivative; // dP/dt no parâmetro pedido (nas versões por distância, dP/ds: unitária)
+	glm::vec3 tangent;    // Frame ortonormal: tangente, normal e binormal = tangente x normal
+	glm::vec3 normal;
+	glm::vec3 binormal;
+};
+
+struct Curve
+{
+	std::vector<glm::vec3> controlPoints; // Pontos de controle da curva
+	std::vector<glm::vec3> curvePoints;   // Pontos da curva
+	glm::mat4 M;                          // Matriz dos coeficientes da curva
+	ArcLengthTable arcLength;             // Preenchida por buildArcLengthTable
+	std::vector<int> segmentOffsets;      // Primeiro ponto de cada segmento em curvePoints (segments + 1 valores; vazio na Bézier global)
+	int pointsPerSegment = 0;             // Tesselação fixa: pontos por segmento (0 = adaptativa)
+	int dirtyFirst = 0, dirtyLast = -1;   // Segmentos com pontos de controle movidos desde o último takeDirtySegments
+	glm::mat4 tessellationViewProjection = glm::mat4(0.0f); // Câmera da última tesselação adaptativa em pixels
+};
+
+// Tesselação de curvas cúbicas por partes (Bézier com stride 3, Catmull-Rom com stride 1)
+enum TessellationMethod
+{
+	TESSELLATE_FORWARD_DIFFERENCES, // 9 somas por ponto, erro cresce com o nro de passos
+	TESSELLATE_SIMD                 // Horner em 4 valores de t por vez
+};
+
+// Tesselação adaptativa: cada trecho é dividido ao meio até o erro de corda (distância da curva,
+// nos pontos 1/4, 1/2 e 3/4, até o segmento de reta) ficar abaixo da tolerância
+struct AdaptiveTessellation
+{
+	float tolerance = 0.005f;          // Unidades do mundo, ou pixels com screenSpace
+	bool screenSpace = false;          // Mede o erro projetado na tela
+	glm::mat4 viewProjection = glm::mat4(1.0f); // Usadas só com screenSpace
+	glm::vec2 viewport = glm::vec2(1.0f);
+	int minDepth = 1;                  // Divisões obrigatórias, para não aceitar curvas em S cortadas ao meio
+	int maxDepth = 10;                 // No máximo 2^maxDepth trechos por segmento
+	float retessellateScale = 0.1f;    // Variação relativa do tamanho na tela que pede nova tesselação
+};
+
+// Trecho de curvePoints reescrito por retessellateCurveSegments: [first, first + count). Com
+// resized o nro de pontos do trecho mudou, os seguintes se deslocaram e count vai até o fim
+struct CurvePointsUpdate
+{
+	size_t first = 0;
+	size_t count = 0;
+	bool resized = false;
+};
+
+// Avaliação da Bézier global (um único polinômio de grau n = nro de pontos - 1)
+enum BezierMethod
+{
+	BEZIER_AUTO,         // Escolhe pelo grau
+	BEZIER_HORNER,       // Horner na base de Bernstein com razão t/(1-t): O(n), o mais rápido
+	BEZIER_BINOMIAL,     // Linha de binomiais e potências incrementais: O(n), só termos positivos
+	BEZIER_DE_CASTELJAU  // Interpolações sucessivas: O(n^2), estável para qualquer grau
+};
+
+// Acima deste grau os binomiais (e a soma de Horner) estouram o float
+const int BEZIER_MAX_BINOMIAL_DEGREE = 120;
+
+struct BezierEvaluator
+{
+	int degree = -1;
+	BezierMethod method = BEZIER_AUTO;
+	std::vector<float> x, y, z;      // Pontos de controle em SoA
+	std::vector<float> binomial;     // C(n, i), i = 0..n
+	std::vector<float> wx, wy, wz;   // C(n, i) * P_i, usados pelo Horner
+};
+
+//Funções da curva
+void initializeBernsteinMatrix(glm::mat4x4& matrix);
+void generateBezierCurvePoints(Curve& curve, int numPoints);
+void generateGlobalBezierCurvePoints(Curve& curve, int numPoints);
+void initializeCatmullRomMatrix(glm::mat4x4& matrix);
+void generateCatmullRomCurvePoints(Curve& curve, int numPoints);
+std::vector<glm::vec3> generateHeartControlPoints(int numPoints);
+std::vector<glm::vec3> generateInfinityControlPoints(int numPoints);
+
+// Coeficientes G * M de cada segmento (CUBIC_SEGMENT_FLOATS por segmento); devolve o nro de segmentos
+int computeCubicCoefficients(const Curve& curve, int stride, std::vector<float>& coeffs);
+int cubicSegmentCount(const Curve& curve, int stride);
+// Escreve numPoints amostras por segmento (t = j / numPoints, j < numPoints) em out, que já deve
+// ter espaço para cubicSegmentCount * numPoints pontos
+void tessellateCubicCurve(const Curve& curve, int stride, int numPoints, glm::vec3* out, TessellationMethod method = TESSELLATE_SIMD);
+
+// Integra |P'(t)| por Gauss-Legendre em cada amostra; M já deve estar inicializada.
+// Normalmente table = curve.arcLength, construída uma vez junto com a curva
+void buildArcLengthTable(const Curve& curve, int stride, ArcLengthTable& table);
+// Converte a distância (já em [0, length]) em segmento e t. segment é também a dica de entrada:
+// se estiver a poucos segmentos do destino anda a partir dela, senão faz a busca binária
+float arcLengthToParameter(const ArcLengthTable& table, float distance, int& segment);
+// Só a busca, sem o passo de Newton: t interpolado entre as amostras vizinhas. sampleT e
+// sampleLength recebem o t e o comprimento acumulado da amostra anterior (para refinar em lote)
+float arcLengthLookup(const ArcLengthTable& table, float distance, int& segment, float& sampleT, float& sampleLength);
+// Inversa de arcLengthToParameter: distância percorrida até t no segmento
+float parameterToArcLength(const ArcLengthTable& table, int segment, float t);
+
+// Substituem as versões de nro fixo de pontos; curvePoints inclui as duas pontas da curva.
+// Com screenSpace, guardam a câmera usada em curve.tessellationViewProjection
+void generateAdaptiveCurvePoints(Curve& curve, int stride, const AdaptiveTessellation& settings);
+void generateAdaptiveGlobalBezierCurvePoints(Curve& curve, const AdaptiveTessellation& settings);
+// Com screenSpace: true se o tamanho projetado da caixa dos pontos de controle mudou mais que
+// retessellateScale desde a última tesselação (zoom, aproximação); girar a câmera não conta
+bool needsRetessellation(const Curve& curve, const AdaptiveTessellation& settings);
+
+// Amostragem contínua sem curvePoints, a partir de curve.arcLength. t vai de 0 a 1 na curva
+// inteira (segmento = floor(t * segments)); distance vai de 0 a length(). A normal parte de um
+// frame fixo em t = 0 e é propagada por dupla reflexão, então não gira em torno da tangente.
+// As versões em lote continuam a busca e a propagação da amostra anterior: entradas ordenadas
+// custam O(1) cada, com o mesmo resultado das chamadas avulsas
+CurveSample sampleCurve(const ArcLengthTable& table, float t);
+CurveSample sampleCurveAtDistance(const ArcLengthTable& table, float distance);
+void sampleCurveBatch(const ArcLengthTable& table, const float* t, size_t count, CurveSample* out);
+void sampleCurveAtDistanceBatch(const ArcLengthTable& table, const float* distance, size_t count, CurveSample* out);
+
+// Edição incremental. Segmentos que usam o ponto de controle index: os 4 vizinhos na Catmull-Rom,
+// o trecho que o contém na Bézier por partes (os dois, nas pontas compartilhadas)
+void dirtySegmentRange(const Curve& curve, int stride, int index, int& first, int& last);
+// Move o ponto e acumula os segmentos afetados em curve.dirtyFirst/dirtyLast
+void moveControlPoint(Curve& curve, int stride, int index, const glm::vec3& point);
+// Devolve o intervalo acumulado (false se nada mudou) e o limpa
+bool takeDirtySegments(Curve& curve, int& first, int& last);
+// Re-tessela só os segmentos [first, last], do jeito que a curva foi tesselada: com
+// pointsPerSegment fixo ou adaptativa com settings. Sem um layout conhecido refaz a curva toda
+CurvePointsUpdate retessellateCurveSegments(Curve& curve, int stride, const AdaptiveTessellation& settings, int first, int last);
+// Integra de novo só os segmentos [first, last]; os seguintes têm o comprimento acumulado
+// deslocado e o frame girado em torno da tangente, sem propagar as reflexões outra vez
+void updateArcLengthTable(const Curve& curve, int stride, ArcLengthTable& table, int first, int last);
+
+void initBezierEvaluator(BezierEvaluator& evaluator, const std::vector<glm::vec3>& controlPoints, BezierMethod method = BEZIER_AUTO);
+glm::vec3 evaluateBezier(const BezierEvaluator& evaluator, float t);
+// Avalia count valores de t; com SSE processa 4 por vez
+void evaluateBezierBatch(const BezierEvaluator& evaluator, const float* t, size_t count, glm::vec3* out);
+
+// Compara os métodos com a implementação antiga (tgamma/pow) em erro e tempo
+void benchmarkCurves();
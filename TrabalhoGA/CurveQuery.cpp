@@ -0,0 +1,313 @@
+#include "CurveQuery.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+namespace
+{
+	const int MAX_DEPTH = 64;       // Limita a pilha de travessia
+	const int COARSE_SAMPLES = 8;   // Amostras por segmento antes do Newton
+	const int NEWTON_STEPS = 6;
+
+	// Caixa do polígono de controle de Bézier do segmento: P0 = d, P1 = d + c/3, P2 = d + (2c + b)/3, P3 = a + b + c + d
+	void segmentBounds(const float* c, glm::vec3& bmin, glm::vec3& bmax)
+	{
+		glm::vec3 a(c[0], c[1], c[2]), b(c[3], c[4], c[5]), v(c[6], c[7], c[8]), d(c[9], c[10], c[11]);
+		glm::vec3 p1 = d + v / 3.0f, p2 = d + (2.0f * v + b) / 3.0f, p3 = a + b + v + d;
+		bmin = glm::min(glm::min(d, p1), glm::min(p2, p3));
+		bmax = glm::max(glm::max(d, p1), glm::max(p2, p3));
+	}
+
+	inline float boxDistance2(const BVHNode& node, const glm::vec3& q)
+	{
+		glm::vec3 e = glm::max(glm::max(node.bmin - q, q - node.bmax), glm::vec3(0.0f));
+		return glm::dot(e, e);
+	}
+
+	inline glm::vec3 position(const float* c, float t)
+	{
+		return glm::vec3(((c[0] * t + c[3]) * t + c[6]) * t + c[9], ((c[1] * t + c[4]) * t + c[7]) * t + c[10], ((c[2] * t + c[5]) * t + c[8]) * t + c[11]);
+	}
+
+	// Ponto do segmento mais próximo de q. A distância ao quadrado é um polinômio de grau 6 com até
+	// 3 mínimos: as amostras escolhem o vale e o Newton em f(t) = (P - q) . P' o refina
+	float closestOnSegment(const float* c, const glm::vec3& q, float& bestT)
+	{
+		bestT = 0.0f;
+		glm::vec3 e = position(c, 0.0f) - q;
+		float best = glm::dot(e, e);
+		for (int i = 1; i <= COARSE_SAMPLES; i++)
+		{
+			float t = (float)i / COARSE_SAMPLES;
+			e = position(c, t) - q;
+			float d2 = glm::dot(e, e);
+			if (d2 < best)
+			{
+				best = d2;
+				bestT = t;
+			}
+		}
+
+		glm::vec3 a(c[0], c[1], c[2]), b(c[3], c[4], c[5]), v(c[6], c[7], c[8]);
+		float t = bestT;
+		for (int k = 0; k < NEWTON_STEPS; k++)
+		{
+			glm::vec3 diff = position(c, t) - q;
+			glm::vec3 d1 = (3.0f * a * t + 2.0f * b) * t + v;
+			glm::vec3 d2 = 6.0f * a * t + 2.0f * b;
+			float f = glm::dot(diff, d1);
+			float df = glm::dot(d1, d1) + glm::dot(diff, d2);
+			if (df <= 0.0f) break; // Fora da bacia de um mínimo: fica com a amostra
+			float next = min(max(t - f / df, 0.0f), 1.0f);
+			bool done = fabs(next - t) < 1e-7f;
+			t = next;
+			if (done) break;
+		}
+		e = position(c, t) - q;
+		float d2 = glm::dot(e, e);
+		if (d2 < best)
+		{
+			best = d2;
+			bestT = t;
+		}
+		return best;
+	}
+
+	void fillHit(const ArcLengthTable& table, int segment, float t, float distance2, CurveHit& hit)
+	{
+		hit.segment = segment;
+		hit.t = t;
+		hit.distance = sqrt(distance2);
+		hit.point = position(&table.coeffs[(size_t)segment * CUBIC_SEGMENT_FLOATS], t);
+		hit.arcLength = parameterToArcLength(table, segment, t);
+	}
+
+	double elapsedMs(chrono::high_resolution_clock::time_point start)
+	{
+		return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+	}
+}
+
+void buildCurveBVH(CurveBVH& bvh, const ArcLengthTable& table)
+{
+	auto start = chrono::high_resolution_clock::now();
+	bvh.nodes.clear();
+	bvh.segments.resize((size_t)table.segments);
+	if (table.segments == 0) return;
+
+	vector<glm::vec3> bmin((size_t)table.segments), bmax((size_t)table.segments), centers((size_t)table.segments);
+	for (int s = 0; s < table.segments; s++)
+	{
+		segmentBounds(&table.coeffs[(size_t)s * CUBIC_SEGMENT_FLOATS], bmin[s], bmax[s]);
+		centers[s] = 0.5f * (bmin[s] + bmax[s]);
+		bvh.segments[s] = (uint32_t)s;
+	}
+	bvh.nodes.reserve(2 * ((size_t)table.segments / CURVE_BVH_LEAF_SIZE + 1));
+	bvh.nodes.push_back(BVHNode());
+
+	// Pilha explícita de (nó, início, fim) nos segmentos
+	struct Range { uint32_t node, begin, end; };
+	vector<Range> pending;
+	pending.push_back({ 0, 0, (uint32_t)table.segments });
+	while (!pending.empty())
+	{
+		Range range = pending.back();
+		pending.pop_back();
+
+		glm::vec3 lo(FLT_MAX), hi(-FLT_MAX), clo(FLT_MAX), chi(-FLT_MAX);
+		for (uint32_t i = range.begin; i < range.end; i++)
+		{
+			uint32_t s = bvh.segments[i];
+			lo = glm::min(lo, bmin[s]);
+			hi = glm::max(hi, bmax[s]);
+			clo = glm::min(clo, centers[s]);
+			chi = glm::max(chi, centers[s]);
+		}
+		BVHNode& node = bvh.nodes[range.node];
+		node.bmin = lo;
+		node.bmax = hi;
+		if (range.end - range.begin <= (uint32_t)CURVE_BVH_LEAF_SIZE)
+		{
+			node.leftFirst = range.begin;
+			node.count = range.end - range.begin;
+			continue;
+		}
+
+		// Mediana dos centros no maior eixo: a árvore fica balanceada mesmo com segmentos de tamanhos diferentes
+		glm::vec3 extent = chi - clo;
+		int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+		uint32_t mid = (range.begin + range.end) / 2;
+		nth_element(bvh.segments.begin() + range.begin, bvh.segments.begin() + mid, bvh.segments.begin() + range.end,
+			[&](uint32_t a, uint32_t b) { return centers[a][axis] < centers[b][axis]; });
+
+		uint32_t left = (uint32_t)bvh.nodes.size();
+		node.leftFirst = left;
+		node.count = 0;
+		bvh.nodes.push_back(BVHNode());
+		bvh.nodes.push_back(BVHNode());
+		pending.push_back({ left + 1, mid, range.end });
+		pending.push_back({ left, range.begin, mid });
+	}
+	bvh.buildMs = elapsedMs(start);
+}
+
+void refitCurveBVH(CurveBVH& bvh, const ArcLengthTable& table)
+{
+	// Os filhos sempre vêm depois do pai no vetor: de trás para frente cada nó já tem os filhos prontos
+	for (size_t i = bvh.nodes.size(); i-- > 0;)
+	{
+		BVHNode& node = bvh.nodes[i];
+		if (node.isLeaf())
+		{
+			node.bmin = glm::vec3(FLT_MAX);
+			node.bmax = glm::vec3(-FLT_MAX);
+			for (uint32_t k = 0; k < node.count; k++)
+			{
+				glm::vec3 lo, hi;
+				segmentBounds(&table.coeffs[(size_t)bvh.segments[node.leftFirst + k] * CUBIC_SEGMENT_FLOATS], lo, hi);
+				node.bmin = glm::min(node.bmin, lo);
+				node.bmax = glm::max(node.bmax, hi);
+			}
+			continue;
+		}
+		const BVHNode& left = bvh.nodes[node.leftFirst];
+		const BVHNode& right = bvh.nodes[node.leftFirst + 1];
+		node.bmin = glm::min(left.bmin, right.bmin);
+		node.bmax = glm::max(left.bmax, right.bmax);
+	}
+}
+
+bool closestPointOnCurve(const CurveBVH& bvh, const ArcLengthTable& table, const glm::vec3& query, CurveHit& hit, float maxDistance)
+{
+	if (bvh.empty()) return false;
+
+	float best = maxDistance < FLT_MAX ? maxDistance * maxDistance : FLT_MAX;
+	int bestSegment = -1;
+	float bestT = 0.0f;
+
+	uint32_t stack[MAX_DEPTH];
+	int top = 0;
+	if (boxDistance2(bvh.nodes[0], query) < best) stack[top++] = 0;
+	while (top > 0)
+	{
+		const BVHNode& node = bvh.nodes[stack[--top]];
+		if (boxDistance2(node, query) >= best) continue; // O melhor ponto melhorou desde o empilhamento
+
+		if (node.isLeaf())
+		{
+			for (uint32_t k = 0; k < node.count; k++)
+			{
+				uint32_t s = bvh.segments[node.leftFirst + k];
+				float t;
+				float d2 = closestOnSegment(&table.coeffs[(size_t)s * CUBIC_SEGMENT_FLOATS], query, t);
+				if (d2 < best)
+				{
+					best = d2;
+					bestSegment = (int)s;
+					bestT = t;
+				}
+			}
+			continue;
+		}
+
+		// O mais próximo é empilhado por último, para ser visitado primeiro
+		uint32_t near = node.leftFirst, far = node.leftFirst + 1;
+		float dNear = boxDistance2(bvh.nodes[near], query), dFar = boxDistance2(bvh.nodes[far], query);
+		if (dFar < dNear)
+		{
+			swap(near, far);
+			swap(dNear, dFar);
+		}
+		if (dFar < best && top < MAX_DEPTH) stack[top++] = far;
+		if (dNear < best && top < MAX_DEPTH) stack[top++] = near;
+	}
+
+	if (bestSegment < 0) return false;
+	fillHit(table, bestSegment, bestT, best, hit);
+	return true;
+}
+
+float distanceToCurve(const CurveBVH& bvh, const ArcLengthTable& table, const glm::vec3& query)
+{
+	CurveHit hit;
+	return closestPointOnCurve(bvh, table, query, hit) ? hit.distance : FLT_MAX;
+}
+
+float nearestCurveParameter(const CurveBVH& bvh, const ArcLengthTable& table, const glm::vec3& query)
+{
+	CurveHit hit;
+	if (!closestPointOnCurve(bvh, table, query, hit)) return 0.0f;
+	return ((float)hit.segment + hit.t) / (float)table.segments;
+}
+
+void benchmarkCurveQueries()
+{
+	cout << fixed << setprecision(3);
+	cout << "==== Consultas de proximidade em curvas ====" << endl;
+
+	int sizes[] = { 1000, 100000, 400000 };
+	for (int size : sizes)
+	{
+		// Hélice longa: muitos segmentos próximos uns dos outros (espiras a 0.3 unidades)
+		Curve curve;
+		curve.controlPoints.resize((size_t)size + 3);
+		for (size_t i = 0; i < curve.controlPoints.size(); i++)
+		{
+			float u = (float)i * 0.3f;
+			curve.controlPoints[i] = glm::vec3(4.0f * cos(u), 4.0f * sin(u), u * 0.05f);
+		}
+		initializeCatmullRomMatrix(curve.M);
+		generateCatmullRomCurvePoints(curve, 10);
+		buildArcLengthTable(curve, 1, curve.arcLength);
+		const ArcLengthTable& table = curve.arcLength;
+
+		CurveBVH bvh;
+		buildCurveBVH(bvh, table);
+
+		// Consultas perto da curva, a até meia unidade dela
+		const int queries = 100000;
+		vector<glm::vec3> points(queries);
+		unsigned state = 2024u;
+		auto next = [&state]() { state = state * 1664525u + 1013904223u; return (state >> 8) * (1.0f / 16777216.0f); };
+		for (glm::vec3& q : points)
+		{
+			const glm::vec3& p = curve.curvePoints[(size_t)(next() * (curve.curvePoints.size() - 1))];
+			q = p + glm::vec3(next() - 0.5f, next() - 0.5f, next() - 0.5f);
+		}
+
+		auto start = chrono::high_resolution_clock::now();
+		double sink = 0.0;
+		for (const glm::vec3& q : points) sink += distanceToCurve(bvh, table, q);
+		double bvhNs = elapsedMs(start) * 1e6 / queries;
+
+		// Varredura linear da poligonal e força bruta nos segmentos analíticos, em poucas consultas
+		const int checks = size > 100000 ? 20 : 100;
+		double scanNs = 0.0, maxErr = 0.0, scanErr = 0.0;
+		for (int i = 0; i < checks; i++)
+		{
+			const glm::vec3& q = points[i];
+			start = chrono::high_resolution_clock::now();
+			float scan = FLT_MAX;
+			for (const glm::vec3& p : curve.curvePoints) scan = min(scan, glm::dot(p - q, p - q));
+			scanNs += elapsedMs(start) * 1e6 / checks;
+
+			float brute = FLT_MAX, t;
+			for (int s = 0; s < table.segments; s++)
+				brute = min(brute, closestOnSegment(&table.coeffs[(size_t)s * CUBIC_SEGMENT_FLOATS], q, t));
+			float fast = distanceToCurve(bvh, table, q);
+			maxErr = max(maxErr, (double)fabs(fast - sqrt(brute)));
+			scanErr = max(scanErr, (double)(sqrt(scan) - fast));
+		}
+
+		cout << size << " segmentos: BVH de " << bvh.nodes.size() << " nos em " << bvh.buildMs << " ms" << endl;
+		cout << "  BVH: " << bvhNs << " ns/consulta  varredura de " << curve.curvePoints.size() << " pontos: " << scanNs
+			<< " ns (" << scanNs / bvhNs << "x)  (" << (sink > 0.0 ? "ok" : "-") << ")" << endl;
+		cout << "  diferenca para a forca bruta: " << scientific << maxErr << "  erro da poligonal: " << scanErr << fixed << endl;
+	}
+	cout << defaultfloat;
+}
@@ -0,0 +1,56 @@
+// Consultas de proximidade em curvas cúbicas por partes (ponto mais próximo, distância, t)
+//
+// BVH com um segmento cúbico por primitiva, construída a partir da ArcLengthTable da curva
+// (que já guarda os coeficientes na base de potências). A caixa de cada segmento é a do polígono
+// de controle de Bézier equivalente, que contém a curva inteira: ao contrário da poligonal
+// tesselada, nenhum trecho fica de fora. A busca desce primeiro pelo filho mais próximo e descarta
+// as caixas mais distantes que o melhor ponto já encontrado; em cada folha o ponto do segmento é
+// escolhido por amostragem grossa e refinado com Newton em (P(t) - q) . P'(t) = 0.
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cfloat>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "BVH.h"
+#include "Curve.h"
+
+// Segmentos por folha
+const int CURVE_BVH_LEAF_SIZE = 4;
+
+struct CurveBVH
+{
+	std::vector<BVHNode> nodes;      // Raiz no índice 0; os filhos de um nó interno ficam em leftFirst e leftFirst + 1
+	std::vector<uint32_t> segments;  // Índices dos segmentos na ordem das folhas
+	double buildMs = 0.0;
+
+	bool empty() const { return nodes.empty(); }
+};
+
+struct CurveHit
+{
+	glm::vec3 point = glm::vec3(0.0f);
+	float distance = FLT_MAX;
+	int segment = -1;
+	float t = 0.0f;          // Parâmetro dentro do segmento
+	float arcLength = 0.0f;  // Distância percorrida na curva até point (a mesma escala de AgentGroup::param)
+};
+
+// Divisão pela mediana dos centros no maior eixo: profundidade log2(segmentos / CURVE_BVH_LEAF_SIZE)
+void buildCurveBVH(CurveBVH& bvh, const ArcLengthTable& table);
+// Recalcula as caixas sem mudar a árvore, depois de pontos movidos (updateArcLengthTable)
+void refitCurveBVH(CurveBVH& bvh, const ArcLengthTable& table);
+
+// table deve ser a mesma da construção. Retorna false se nenhum ponto da curva está a menos de
+// maxDistance (consultas do tipo "está perto do caminho?" param cedo)
+bool closestPointOnCurve(const CurveBVH& bvh, const ArcLengthTable& table, const glm::vec3& query, CurveHit& hit, float maxDistance = FLT_MAX);
+float distanceToCurve(const CurveBVH& bvh, const ArcLengthTable& table, const glm::vec3& query);
+// t de 0 a 1 na curva inteira, como em sampleCurve
+float nearestCurveParameter(const CurveBVH& bvh, const ArcLengthTable& table, const glm::vec3& query);
+
+// Compara com a varredura linear de curvePoints e com a força bruta nos segmentos, até 100k+ segmentos
+void benchmarkCurveQueries();
@@ -0,0 +1,285 @@
+#include "CurveRenderer.h"
+
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Benchmark.h"
+#include "GpuMemory.h"
+
+using namespace std;
+
+bool curvePatchesSupported()
+{
+	return GLAD_GL_VERSION_4_0 != 0;
+}
+
+void createCurvePatches(CurvePatches& patches, const Curve& curve, int stride)
+{
+	patches.segments = cubicSegmentCount(curve, stride);
+	patches.M = curve.M;
+	patches.convexHull = stride == 3;
+
+	GLint maxLevel = 64;
+	glGetIntegerv(GL_MAX_TESS_GEN_LEVEL, &maxLevel);
+	patches.maxLevel = (float)maxLevel;
+
+	// Cada segmento usa os pontos [s * stride, s * stride + 3]
+	vector<GLuint> indices;
+	indices.reserve((size_t)patches.segments * 4);
+	for (int s = 0; s < patches.segments; s++)
+		for (int k = 0; k < 4; k++)
+			indices.push_back((GLuint)(s * stride + k));
+
+	glGenVertexArrays(1, &patches.VAO);
+	glGenBuffers(1, &patches.VBO);
+	glGenBuffers(1, &patches.EBO);
+
+	glBindVertexArray(patches.VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, patches.VBO);
+	// DYNAMIC: os pontos de controle podem ser editados
+	glBufferData(GL_ARRAY_BUFFER, curve.controlPoints.size() * sizeof(glm::vec3), curve.controlPoints.data(), GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, patches.EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+	gpuTrack(GPU_CURVE, patches.VBO, "pontos de controle (patches)", curve.controlPoints.size() * sizeof(glm::vec3));
+	gpuTrack(GPU_CURVE, patches.EBO, "indices dos patches", indices.size() * sizeof(GLuint));
+
+	// Atributo posição (x, y, z)
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
+	glEnableVertexAttribArray(0);
+
+	// O EBO fica registrado no VAO; só o VBO pode ser desvinculado antes
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void setCurveControlPoint(CurvePatches& patches, Curve& curve, int index, const glm::vec3& point)
+{
+	if (index < 0 || index >= (int)curve.controlPoints.size()) return;
+	curve.controlPoints[index] = point;
+
+	glBindBuffer(GL_ARRAY_BUFFER, patches.VBO);
+	glBufferSubData(GL_ARRAY_BUFFER, index * sizeof(glm::vec3), sizeof(glm::vec3), &point);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void drawCurvePatches(const CurvePatches& patches, const Shader& shader, float pixelsPerLine)
+{
+	if (patches.segments == 0) return;
+
+	glUniformMatrix4fv(glGetUniformLocation(shader.ID, "basis"), 1, GL_FALSE, glm::value_ptr(patches.M));
+	shader.setBool("convexHull", patches.convexHull);
+	shader.setFloat("pixelsPerLine", pixelsPerLine);
+	shader.setFloat("maxLevel", patches.maxLevel);
+
+	glBindVertexArray(patches.VAO);
+	glPatchParameteri(GL_PATCH_VERTICES, 4);
+	glDrawElements(GL_PATCHES, patches.segments * 4, GL_UNSIGNED_INT, 0);
+	glBindVertexArray(0);
+	countDraw(patches.segments * 4);
+}
+
+void deleteCurvePatches(CurvePatches& patches)
+{
+	gpuUntrack(GPU_CURVE, patches.VBO);
+	gpuUntrack(GPU_CURVE, patches.EBO);
+	glDeleteVertexArrays(1, &patches.VAO);
+	glDeleteBuffers(1, &patches.VBO);
+	glDeleteBuffers(1, &patches.EBO);
+	patches = CurvePatches();
+}
+
+namespace
+{
+	inline glm::vec4 packPoint(const glm::vec3& p, int style, bool last)
+	{
+		return glm::vec4(p, last ? -1.0f : (float)style);
+	}
+
+	void markDirty(CurveLines& lines, size_t first, size_t end)
+	{
+		if (lines.dirtyEnd <= lines.dirtyFirst)
+		{
+			lines.dirtyFirst = first;
+			lines.dirtyEnd = end;
+			return;
+		}
+		lines.dirtyFirst = min(lines.dirtyFirst, first);
+		lines.dirtyEnd = max(lines.dirtyEnd, end);
+	}
+
+	void setPointAttributes(GLuint VAO, size_t offsetA, size_t offsetB)
+	{
+		glBindVertexArray(VAO);
+		glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (GLvoid*)offsetA);
+		glEnableVertexAttribArray(0);
+		glVertexAttribDivisor(0, 1);
+		glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (GLvoid*)offsetB);
+		glEnableVertexAttribArray(1);
+		glVertexAttribDivisor(1, 1);
+	}
+}
+
+int addCurveLineStyle(CurveLines& lines, const glm::vec4& color, float width)
+{
+	if ((int)lines.styles.size() >= CURVE_LINE_MAX_STYLES) return CURVE_LINE_MAX_STYLES - 1;
+	lines.styles.push_back({ color, width });
+	return (int)lines.styles.size() - 1;
+}
+
+int addCurveLine(CurveLines& lines, const vector<glm::vec3>& points, int style)
+{
+	CurveLineRange range;
+	range.first = (int)lines.linePoints.size();
+	range.count = (int)points.size();
+	range.style = style;
+	for (size_t i = 0; i < points.size(); i++)
+		lines.linePoints.push_back(packPoint(points[i], style, i + 1 == points.size()));
+	lines.lines.push_back(range);
+	lines.layoutChanged = true;
+	return (int)lines.lines.size() - 1;
+}
+
+int addCurveMarkers(CurveLines& lines, const vector<glm::vec3>& points, int style)
+{
+	CurveLineRange range;
+	range.first = (int)lines.markerPoints.size();
+	range.count = (int)points.size();
+	range.style = style;
+	for (const glm::vec3& p : points)
+		lines.markerPoints.push_back(packPoint(p, style, false));
+	lines.markers.push_back(range);
+	lines.layoutChanged = true;
+	return (int)lines.markers.size() - 1;
+}
+
+void displayCurve(CurveLines& lines, const Curve& curve, int lineStyle, int markerStyle, int& line, int& markers)
+{
+	line = addCurveLine(lines, curve.curvePoints, lineStyle);
+	markers = markerStyle >= 0 ? addCurveMarkers(lines, curve.controlPoints, markerStyle) : -1;
+}
+
+void updateCurveLine(CurveLines& lines, int line, const vector<glm::vec3>& points, const CurvePointsUpdate& update)
+{
+	if (line < 0 || line >= (int)lines.lines.size()) return;
+	CurveLineRange& range = lines.lines[line];
+
+	// Mudou o nro de pontos: as poligonais seguintes se deslocam e o buffer é reenviado inteiro
+	if (update.resized || (int)points.size() != range.count)
+	{
+		vector<glm::vec4> packed(points.size());
+		for (size_t i = 0; i < points.size(); i++)
+			packed[i] = packPoint(points[i], range.style, i + 1 == points.size());
+		lines.linePoints.erase(lines.linePoints.begin() + range.first, lines.linePoints.begin() + range.first + range.count);
+		lines.linePoints.insert(lines.linePoints.begin() + range.first, packed.begin(), packed.end());
+		int shift = (int)points.size() - range.count;
+		range.count = (int)points.size();
+		for (CurveLineRange& other : lines.lines)
+			if (other.first > range.first) other.first += shift;
+		lines.layoutChanged = true;
+		return;
+	}
+
+	size_t end = min(update.first + update.count, points.size());
+	for (size_t i = update.first; i < end; i++)
+		lines.linePoints[range.first + i] = packPoint(points[i], range.style, i + 1 == points.size());
+	if (end > update.first) markDirty(lines, range.first + update.first, range.first + end);
+}
+
+void updateCurveMarker(CurveLines& lines, int markers, int index, const glm::vec3& point)
+{
+	if (markers < 0 || markers >= (int)lines.markers.size()) return;
+	const CurveLineRange& range = lines.markers[markers];
+	if (index < 0 || index >= range.count) return;
+	size_t i = (size_t)(range.first + index);
+	lines.markerPoints[i] = packPoint(point, range.style, false);
+	markDirty(lines, lines.linePoints.size() + i, lines.linePoints.size() + i + 1);
+}
+
+void uploadCurveLines(CurveLines& lines)
+{
+	if (lines.VBO == 0)
+	{
+		glGenBuffers(1, &lines.VBO);
+		glGenVertexArrays(1, &lines.lineVAO);
+		glGenVertexArrays(1, &lines.markerVAO);
+	}
+
+	size_t lineBytes = lines.linePoints.size() * sizeof(glm::vec4);
+	size_t markerBytes = lines.markerPoints.size() * sizeof(glm::vec4);
+	glBindBuffer(GL_ARRAY_BUFFER, lines.VBO);
+	if (lines.layoutChanged)
+	{
+		// Folga de 50%: a tesselação adaptativa muda o nro de pontos a cada zoom
+		if (lineBytes + markerBytes > lines.capacity)
+		{
+			lines.capacity = (lineBytes + markerBytes) * 3 / 2;
+			glBufferData(GL_ARRAY_BUFFER, lines.capacity, nullptr, GL_DYNAMIC_DRAW);
+			gpuTrack(GPU_CURVE, lines.VBO, "linhas das curvas", lines.capacity);
+		}
+		if (lineBytes > 0) glBufferSubData(GL_ARRAY_BUFFER, 0, lineBytes, lines.linePoints.data());
+		if (markerBytes > 0) glBufferSubData(GL_ARRAY_BUFFER, lineBytes, markerBytes, lines.markerPoints.data());
+
+		// Os marcadores começam depois das linhas: o ponteiro deles muda junto com o layout
+		setPointAttributes(lines.lineVAO, 0, sizeof(glm::vec4));
+		setPointAttributes(lines.markerVAO, lineBytes, lineBytes);
+		glBindVertexArray(0);
+		lines.layoutChanged = false;
+	}
+	else if (lines.dirtyEnd > lines.dirtyFirst)
+	{
+		// Intervalo sujo, que pode atravessar a fronteira entre linhas e marcadores
+		size_t lineCount = lines.linePoints.size();
+		size_t first = lines.dirtyFirst, end = lines.dirtyEnd;
+		if (first < lineCount)
+		{
+			size_t lineEnd = min(end, lineCount);
+			glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(glm::vec4), (lineEnd - first) * sizeof(glm::vec4), &lines.linePoints[first]);
+		}
+		if (end > lineCount)
+		{
+			size_t markerFirst = max(first, lineCount) - lineCount;
+			glBufferSubData(GL_ARRAY_BUFFER, lineBytes + markerFirst * sizeof(glm::vec4), (end - lineCount - markerFirst) * sizeof(glm::vec4), &lines.markerPoints[markerFirst]);
+		}
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	lines.dirtyFirst = lines.dirtyEnd = 0;
+}
+
+void drawCurveLines(const CurveLines& lines, const Shader& shader)
+{
+	for (size_t i = 0; i < lines.styles.size(); i++)
+	{
+		string index = "[" + to_string(i) + "]";
+		const glm::vec4& color = lines.styles[i].color;
+		shader.setVec4("styleColor" + index, color.r, color.g, color.b, color.a);
+		shader.setFloat("styleWidth" + index, lines.styles[i].width);
+	}
+
+	// Uma instância por segmento (o último ponto não começa nenhum) e uma por marcador
+	if (lines.linePoints.size() > 1)
+	{
+		glBindVertexArray(lines.lineVAO);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei)lines.linePoints.size() - 1);
+		countDraw(6, (int)lines.linePoints.size() - 1);
+	}
+	if (!lines.markerPoints.empty())
+	{
+		glBindVertexArray(lines.markerVAO);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei)lines.markerPoints.size());
+		countDraw(6, (int)lines.markerPoints.size());
+	}
+	glBindVertexArray(0);
+}
+
+void deleteCurveLines(CurveLines& lines)
+{
+	gpuUntrack(GPU_CURVE, lines.VBO);
+	glDeleteVertexArrays(1, &lines.lineVAO);
+	glDeleteVertexArrays(1, &lines.markerVAO);
+	glDeleteBuffers(1, &lines.VBO);
+	lines = CurveLines();
+}
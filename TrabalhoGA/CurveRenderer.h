@@ -0,0 +1,108 @@
+// Desenho de curvas na GPU
+//
+// Caminho com tesselação (GL 4.0+): só os pontos de controle vão para a GPU e cada segmento
+// cúbico é um patch de 4 vértices, montado por índices (sobrepostos na Catmull-Rom, então cada
+// ponto é enviado uma vez). O shader de controle escolhe quantos trechos de reta cada segmento
+// recebe pelo tamanho dele na tela e o de avaliação calcula P(t) = G * M * T em isolinhas, com a
+// mesma matriz M da CPU. Mover um ponto de controle reenvia 12 bytes.
+//
+// Linhas grossas (qualquer contexto 4.3): todas as poligonais e marcadores de pontos de controle
+// ficam num único buffer de vec4 (xyz + estilo) e cada segmento é uma instância de 6 vértices,
+// expandida na tela pelo vertex shader (curve-lines.*) em volta de uma cápsula. Junções e pontas
+// saem redondas sem geometria extra, no lugar de glLineWidth/glPointSize, que o perfil core não
+// garante acima de 1 pixel. São duas chamadas de desenho: uma para as linhas e uma para os marcadores.
+
+#pragma once
+
+//GLAD
+#include <glad/glad.h>
+
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Curve.h"
+#include "Shader.h"
+
+struct CurvePatches
+{
+	GLuint VAO = 0;
+	GLuint VBO = 0;          // Pontos de controle (vec3)
+	GLuint EBO = 0;          // 4 índices por segmento
+	int segments = 0;
+	glm::mat4 M;             // Base da curva (Bernstein ou Catmull-Rom)
+	bool convexHull = false; // Bézier: a curva fica dentro do polígono de controle
+	float maxLevel = 64.0f;  // GL_MAX_TESS_GEN_LEVEL do contexto
+};
+
+// Contexto com tesselação (GL 4.0); sem ele a curva é desenhada pelos pontos da CPU
+bool curvePatchesSupported();
+
+// stride = 1 para Catmull-Rom e 3 para Bézier por partes; curve.M já deve estar inicializada
+void createCurvePatches(CurvePatches& patches, const Curve& curve, int stride);
+
+// Move um ponto de controle na CPU e na GPU (glBufferSubData de um vec3). Os pontos tesselados
+// na CPU e a tabela de comprimento de arco ficam com moveControlPoint e retessellateCurveSegments
+void setCurveControlPoint(CurvePatches& patches, Curve& curve, int index, const glm::vec3& point);
+
+// O shader (curve-patches.*) já deve estar em uso, com projection, view, viewport e a cor definidos
+void drawCurvePatches(const CurvePatches& patches, const Shader& shader, float pixelsPerLine);
+
+void deleteCurvePatches(CurvePatches& patches);
+
+// Estilos por segmento (uniforms do shader): cor e largura em pixels
+const int CURVE_LINE_MAX_STYLES = 8;
+
+struct CurveLineStyle
+{
+	glm::vec4 color;
+	float width;
+};
+
+// Trecho de uma poligonal ou conjunto de marcadores dentro do buffer
+struct CurveLineRange
+{
+	int first = 0;
+	int count = 0;
+	int style = 0;
+};
+
+struct CurveLines
+{
+	GLuint VBO = 0;
+	GLuint lineVAO = 0;       // pointA = ponto i, pointB = ponto i + 1
+	GLuint markerVAO = 0;     // pointA = pointB = marcador i
+	size_t capacity = 0;      // Bytes alocados no VBO
+
+	std::vector<CurveLineStyle> styles;
+	std::vector<glm::vec4> linePoints;   // Poligonais em sequência; o último ponto de cada uma tem w = -1
+	std::vector<glm::vec4> markerPoints; // Vão para o buffer depois das linhas
+	std::vector<CurveLineRange> lines, markers;
+
+	// Pontos alterados desde o último upload, em índices do buffer (linhas e depois marcadores)
+	size_t dirtyFirst = 0, dirtyEnd = 0;
+	bool layoutChanged = true;           // Nro de pontos mudou: reenvia tudo e refaz os ponteiros
+};
+
+// Devolve o índice do estilo (no máximo CURVE_LINE_MAX_STYLES)
+int addCurveLineStyle(CurveLines& lines, const glm::vec4& color, float width);
+// Devolvem o identificador usado nas atualizações
+int addCurveLine(CurveLines& lines, const std::vector<glm::vec3>& points, int style);
+int addCurveMarkers(CurveLines& lines, const std::vector<glm::vec3>& points, int style);
+
+// Poligonal da curva (curvePoints) e, com markerStyle >= 0, marcadores nos pontos de controle.
+// line e markers recebem os identificadores (-1 se não foram criados)
+void displayCurve(CurveLines& lines, const Curve& curve, int lineStyle, int markerStyle, int& line, int& markers);
+
+// Trecho re-tesselado (retessellateCurveSegments): sem mudança de tamanho só ele é reenviado
+void updateCurveLine(CurveLines& lines, int line, const std::vector<glm::vec3>& points, const CurvePointsUpdate& update);
+void updateCurveMarker(CurveLines& lines, int markers, int index, const glm::vec3& point);
+
+// Envia o que mudou (glBufferSubData do intervalo sujo; glBufferData só se não couber)
+void uploadCurveLines(CurveLines& lines);
+
+// O shader (curve-lines.*) já deve estar em uso, com projection, view e viewport definidos
+void drawCurveLines(const CurveLines& lines, const Shader& shader);
+
+void deleteCurveLines(CurveLines& lines);
@@ -0,0 +1,109 @@
+#include "FileWatch.h"
+
+#include <algorithm>
+
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+	long long modificationTime(const string& path)
+	{
+		struct stat info;
+		if (stat(path.c_str(), &info) != 0) return 0;
+		return (long long)info.st_mtime;
+	}
+
+	void addChange(vector<string>& changes, const string& path)
+	{
+		if (find(changes.begin(), changes.end(), path) == changes.end())
+			changes.push_back(path);
+	}
+}
+
+bool watchFile(FileWatcher& watcher, const string& path)
+{
+	for (const WatchedFile& file : watcher.files)
+		if (file.path == path) return true;
+
+	if (!watcher.initialized)
+	{
+#ifdef __linux__
+		watcher.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+		watcher.lastPoll = chrono::steady_clock::now();
+		watcher.initialized = true;
+	}
+
+	WatchedFile file;
+	file.path = path;
+	size_t slash = path.find_last_of("/\\");
+	file.dir = slash == string::npos ? "." : path.substr(0, slash);
+	file.name = slash == string::npos ? path : path.substr(slash + 1);
+	file.modified = modificationTime(path);
+#ifdef __linux__
+	if (watcher.fd >= 0)
+	{
+		// Um diretório já observado devolve o mesmo descritor
+		file.wd = inotify_add_watch(watcher.fd, file.dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (file.wd < 0) return false;
+	}
+#endif
+	watcher.files.push_back(file);
+	return true;
+}
+
+vector<string> pollFileChanges(FileWatcher& watcher)
+{
+	vector<string> changes;
+	if (watcher.files.empty()) return changes;
+
+#ifdef __linux__
+	if (watcher.fd >= 0)
+	{
+		alignas(inotify_event) char buffer[4096];
+		ssize_t length;
+		while ((length = read(watcher.fd, buffer, sizeof(buffer))) > 0)
+		{
+			for (char* p = buffer; p < buffer + length; p += sizeof(inotify_event) + ((inotify_event*)p)->len)
+			{
+				const inotify_event* event = (const inotify_event*)p;
+				if (event->len == 0) continue;
+				for (const WatchedFile& file : watcher.files)
+					if (file.wd == event->wd && file.name == event->name)
+						addChange(changes, file.path);
+			}
+		}
+		return changes;
+	}
+#endif
+
+	auto now = chrono::steady_clock::now();
+	if (now - watcher.lastPoll < chrono::milliseconds(FILE_WATCH_POLL_MS)) return changes;
+	watcher.lastPoll = now;
+	for (WatchedFile& file : watcher.files)
+	{
+		long long modified = modificationTime(file.path);
+		if (modified != 0 && modified != file.modified)
+		{
+			file.modified = modified;
+			addChange(changes, file.path);
+		}
+	}
+	return changes;
+}
+
+void closeFileWatcher(FileWatcher& watcher)
+{
+#ifdef __linux__
+	if (watcher.fd >= 0) close(watcher.fd);
+#endif
+	watcher.fd = -1;
+	watcher.files.clear();
+	watcher.initialized = false;
+}
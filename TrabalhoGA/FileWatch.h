@@ -0,0 +1,36 @@
+// Observação de arquivos do disco (usada no hot reload dos shaders)
+//
+// No Linux o diretório de cada arquivo é observado com inotify: os eventos ficam na fila do kernel e
+// pollFileChanges só lê o que já chegou, sem bloquear. Os editores costumam gravar num arquivo novo e
+// renomear por cima, então vale tanto o fechamento após escrita quanto o arquivo movido para o nome.
+// Nas outras plataformas (ou se o inotify falhar) as datas de modificação são comparadas a cada
+// FILE_WATCH_POLL_MS.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+
+const int FILE_WATCH_POLL_MS = 250;
+
+struct WatchedFile
+{
+	std::string path;          // Como foi pedido em watchFile (é o que pollFileChanges devolve)
+	std::string dir, name;
+	int wd = -1;               // Descritor do inotify do diretório
+	long long modified = 0;    // Data de modificação, sem inotify
+};
+
+struct FileWatcher
+{
+	std::vector<WatchedFile> files;
+	int fd = -1;               // inotify; -1 = compara as datas de modificação
+	bool initialized = false;
+	std::chrono::steady_clock::time_point lastPoll;
+};
+
+bool watchFile(FileWatcher& watcher, const std::string& path);
+// Arquivos observados que mudaram desde a última chamada, cada um uma vez (não bloqueia)
+std::vector<std::string> pollFileChanges(FileWatcher& watcher);
+void closeFileWatcher(FileWatcher& watcher);
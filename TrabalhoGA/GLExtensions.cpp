@@ -0,0 +1,71 @@
+#include "GLExtensions.h"
+
+#include <cstring>
+
+#ifndef GL_VERSION_4_1
+PFNGLGETPROGRAMBINARYPROC glad_glGetProgramBinary = nullptr;
+PFNGLPROGRAMBINARYPROC glad_glProgramBinary = nullptr;
+PFNGLPROGRAMPARAMETERIPROC glad_glProgramParameteri = nullptr;
+#endif
+#ifndef GL_VERSION_4_2
+PFNGLTEXSTORAGE2DPROC glad_glTexStorage2D = nullptr;
+PFNGLTEXSTORAGE3DPROC glad_glTexStorage3D = nullptr;
+#endif
+#ifndef GL_VERSION_4_3
+PFNGLCOPYIMAGESUBDATAPROC glad_glCopyImageSubData = nullptr;
+#endif
+#ifndef GL_KHR_parallel_shader_compile
+PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glad_glMaxShaderCompilerThreadsKHR = nullptr;
+#endif
+
+int glContextVersion()
+{
+	GLint major = 0, minor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	return major * 10 + minor;
+}
+
+bool hasGLExtension(const char* name)
+{
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (GLint i = 0; i < count; i++)
+	{
+		const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+		if (extension && strcmp(extension, name) == 0) return true;
+	}
+	return false;
+}
+
+void loadGLExtensions(GLADloadproc load)
+{
+	// O loader da GLFW pode devolver um ponteiro mesmo sem suporte: vale a versão ou a extensão
+	int version = glContextVersion();
+#ifndef GL_VERSION_4_1
+	if (version >= 41 || hasGLExtension("GL_ARB_get_program_binary"))
+	{
+		glad_glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)load("glGetProgramBinary");
+		glad_glProgramBinary = (PFNGLPROGRAMBINARYPROC)load("glProgramBinary");
+		glad_glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)load("glProgramParameteri");
+	}
+#endif
+#ifndef GL_VERSION_4_2
+	if (version >= 42 || hasGLExtension("GL_ARB_texture_storage"))
+	{
+		glad_glTexStorage2D = (PFNGLTEXSTORAGE2DPROC)load("glTexStorage2D");
+		glad_glTexStorage3D = (PFNGLTEXSTORAGE3DPROC)load("glTexStorage3D");
+	}
+#endif
+#ifndef GL_VERSION_4_3
+	if (version >= 43 || hasGLExtension("GL_ARB_copy_image"))
+		glad_glCopyImageSubData = (PFNGLCOPYIMAGESUBDATAPROC)load("glCopyImageSubData");
+#endif
+#ifndef GL_KHR_parallel_shader_compile
+	// A versão ARB tem a mesma assinatura e o mesmo GL_COMPLETION_STATUS
+	if (hasGLExtension("GL_KHR_parallel_shader_compile"))
+		glad_glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsKHR");
+	else if (hasGLExtension("GL_ARB_parallel_shader_compile"))
+		glad_glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsARB");
+#endif
+}
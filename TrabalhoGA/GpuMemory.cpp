@@ -0,0 +1,164 @@
+#include "GpuMemory.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <map>
+#include <climits>
+
+using namespace std;
+
+GpuMemory gpuMemory;
+
+namespace
+{
+	const char* CATEGORY_NAMES[GPU_CATEGORY_COUNT] = { "texturas", "malhas", "instancias", "curvas", "envio de texturas" };
+
+	inline uint64_t allocationKey(GpuCategory category, GLuint name)
+	{
+		return ((uint64_t)category << 32) | name;
+	}
+
+	void addBytes(GpuCategory category, long long delta)
+	{
+		gpuMemory.total = (size_t)((long long)gpuMemory.total + delta);
+		gpuMemory.categoryBytes[category] = (size_t)((long long)gpuMemory.categoryBytes[category] + delta);
+		gpuMemory.peak = max(gpuMemory.peak, gpuMemory.total);
+	}
+
+	double megabytes(size_t bytes)
+	{
+		return bytes / (1024.0 * 1024.0);
+	}
+}
+
+const char* gpuCategoryName(GpuCategory category)
+{
+	return CATEGORY_NAMES[category];
+}
+
+void setGpuBudget(size_t bytes)
+{
+	gpuMemory.budget = bytes;
+}
+
+void gpuTrack(GpuCategory category, GLuint name, const string& asset, size_t bytes)
+{
+	if (name == 0) return;
+	GpuAllocation& allocation = gpuMemory.allocations[allocationKey(category, name)];
+	if (allocation.evictedBytes > 0 && bytes > 0)
+	{
+		gpuMemory.reloads++;
+		allocation.evictedBytes = 0;
+	}
+	addBytes(category, (long long)bytes - (long long)allocation.bytes);
+	allocation.category = category;
+	allocation.asset = asset;
+	allocation.bytes = bytes;
+	allocation.lastUsed = gpuMemory.frame;
+}
+
+void gpuUntrack(GpuCategory category, GLuint name)
+{
+	auto it = gpuMemory.allocations.find(allocationKey(category, name));
+	if (it == gpuMemory.allocations.end()) return;
+	addBytes(category, -(long long)it->second.bytes);
+	gpuMemory.allocations.erase(it);
+}
+
+void gpuTouch(GpuCategory category, GLuint name)
+{
+	auto it = gpuMemory.allocations.find(allocationKey(category, name));
+	if (it != gpuMemory.allocations.end()) it->second.lastUsed = gpuMemory.frame;
+}
+
+void gpuNextFrame()
+{
+	gpuMemory.frame++;
+}
+
+const GpuAllocation* gpuAllocation(GpuCategory category, GLuint name)
+{
+	auto it = gpuMemory.allocations.find(allocationKey(category, name));
+	return it != gpuMemory.allocations.end() ? &it->second : nullptr;
+}
+
+long long gpuHeadroom()
+{
+	if (gpuMemory.budget == 0) return LLONG_MAX;
+	return (long long)gpuMemory.budget - (long long)gpuMemory.total;
+}
+
+GLuint gpuLeastRecentlyUsed(GpuCategory category, int minIdleFrames)
+{
+	GLuint best = 0;
+	int bestFrame = INT_MAX;
+	for (const auto& item : gpuMemory.allocations)
+	{
+		const GpuAllocation& allocation = item.second;
+		if (allocation.category != category || allocation.bytes == 0 || allocation.lastUsed > gpuMemory.frame - minIdleFrames) continue;
+		if (allocation.lastUsed < bestFrame)
+		{
+			bestFrame = allocation.lastUsed;
+			best = (GLuint)(item.first & 0xFFFFFFFFu);
+		}
+	}
+	return best;
+}
+
+void gpuEvicted(GpuCategory category, GLuint name)
+{
+	auto it = gpuMemory.allocations.find(allocationKey(category, name));
+	if (it == gpuMemory.allocations.end() || it->second.bytes == 0) return;
+	GpuAllocation& allocation = it->second;
+	addBytes(category, -(long long)allocation.bytes);
+	allocation.evictedBytes = allocation.bytes;
+	allocation.bytes = 0;
+	gpuMemory.evictions++;
+	gpuMemory.evictedBytes += allocation.evictedBytes;
+}
+
+bool gpuIsEvicted(GpuCategory category, GLuint name)
+{
+	const GpuAllocation* allocation = gpuAllocation(category, name);
+	return allocation && allocation->evictedBytes > 0;
+}
+
+vector<GpuAssetUsage> gpuUsageByAsset()
+{
+	map<pair<string, int>, GpuAssetUsage> byAsset;
+	for (const auto& item : gpuMemory.allocations)
+	{
+		const GpuAllocation& allocation = item.second;
+		GpuAssetUsage& usage = byAsset[make_pair(allocation.asset, (int)allocation.category)];
+		usage.asset = allocation.asset;
+		usage.category = allocation.category;
+		usage.bytes += allocation.bytes;
+		usage.objects++;
+	}
+
+	vector<GpuAssetUsage> usages;
+	for (const auto& item : byAsset) usages.push_back(item.second);
+	sort(usages.begin(), usages.end(), [](const GpuAssetUsage& a, const GpuAssetUsage& b) { return a.bytes > b.bytes; });
+	return usages;
+}
+
+void reportGpuMemory(size_t topAssets)
+{
+	cout << fixed << setprecision(2);
+	cout << "Memoria de GPU: " << megabytes(gpuMemory.total) << " MB em " << gpuMemory.allocations.size() << " objetos (pico "
+		<< megabytes(gpuMemory.peak) << " MB";
+	if (gpuMemory.budget > 0) cout << ", orcamento " << megabytes(gpuMemory.budget) << " MB";
+	cout << ")" << endl;
+	for (int c = 0; c < GPU_CATEGORY_COUNT; c++)
+		cout << "  " << CATEGORY_NAMES[c] << ": " << megabytes(gpuMemory.categoryBytes[c]) << " MB" << endl;
+
+	vector<GpuAssetUsage> usages = gpuUsageByAsset();
+	for (size_t i = 0; i < usages.size() && i < topAssets; i++)
+		cout << "    " << megabytes(usages[i].bytes) << " MB  " << usages[i].asset << " (" << CATEGORY_NAMES[usages[i].category]
+			<< (usages[i].objects > 1 ? ", " + to_string(usages[i].objects) + " objetos" : string()) << ")" << endl;
+	if (gpuMemory.evictions > 0)
+		cout << "  " << gpuMemory.evictions << " esvaziados (" << megabytes(gpuMemory.evictedBytes) << " MB) e "
+			<< gpuMemory.reloads << " recarregados" << endl;
+	cout << defaultfloat;
+}
@@ -0,0 +1,87 @@
+// Contabilidade da memória de GPU: bytes de cada buffer e textura, por categoria e por asset
+//
+// Quem cria um objeto GL registra o seu tamanho com gpuTrack (de novo quando o tamanho muda) e o
+// remove com gpuUntrack antes de apagar. Os objetos são identificados pela categoria e pelo nome GL
+// (buffers e texturas têm espaços de nomes separados, e cada buffer pertence a uma categoria só).
+//
+// Com um orçamento (setGpuBudget), quem pode liberar memória consulta gpuHeadroom: as texturas com
+// streaming perdem níveis (Texture.h) e as malhas não desenhadas há mais tempo têm o VBO esvaziado
+// (gpuLeastRecentlyUsed + gpuEvicted), sendo recarregadas do cache de malhas cozidas quando voltam a
+// ser desenhadas. "Usado" é o que foi marcado com gpuTouch no quadro.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+//GLAD
+#include <glad/glad.h>
+
+enum GpuCategory
+{
+	GPU_TEXTURE,    // Texturas 2D e arrays
+	GPU_MESH,       // VBOs das malhas
+	GPU_INSTANCES,  // Matrizes por instância dos agentes
+	GPU_CURVE,      // Pontos, índices e linhas das curvas
+	GPU_STAGING,    // Pixel unpack buffers do envio de texturas
+	GPU_CATEGORY_COUNT
+};
+
+struct GpuAllocation
+{
+	GpuCategory category = GPU_TEXTURE;
+	std::string asset;         // Arquivo de origem (ou descrição, para o que não vem de arquivo)
+	size_t bytes = 0;
+	size_t evictedBytes = 0;   // > 0: esvaziado para caber no orçamento, com esse tamanho antes
+	int lastUsed = -1;         // Quadro do último gpuTouch
+};
+
+struct GpuMemory
+{
+	std::unordered_map<uint64_t, GpuAllocation> allocations; // Por categoria e nome GL
+	size_t budget = 0;                                      // 0 = sem limite
+	size_t total = 0, peak = 0;
+	size_t categoryBytes[GPU_CATEGORY_COUNT] = {};
+	int frame = 0;
+	int evictions = 0, reloads = 0;
+	size_t evictedBytes = 0;                                // Soma do que foi esvaziado
+};
+
+// Bytes de um asset numa categoria (vários objetos GL podem vir do mesmo arquivo)
+struct GpuAssetUsage
+{
+	std::string asset;
+	GpuCategory category;
+	size_t bytes = 0;
+	int objects = 0;
+};
+
+extern GpuMemory gpuMemory;
+
+const char* gpuCategoryName(GpuCategory category);
+
+void setGpuBudget(size_t bytes);
+// Registra ou atualiza o tamanho de um objeto (se estava esvaziado, conta como recarregado)
+void gpuTrack(GpuCategory category, GLuint name, const std::string& asset, size_t bytes);
+void gpuUntrack(GpuCategory category, GLuint name);
+// Marca o objeto como usado no quadro corrente
+void gpuTouch(GpuCategory category, GLuint name);
+void gpuNextFrame();
+
+const GpuAllocation* gpuAllocation(GpuCategory category, GLuint name);
+// Bytes livres no orçamento (negativo se passou; sem orçamento, o maior valor possível)
+long long gpuHeadroom();
+// O objeto da categoria, ainda com memória, usado há mais tempo e não usado nos últimos minIdleFrames
+// quadros (1 = só o quadro corrente; 0 = nenhum)
+GLuint gpuLeastRecentlyUsed(GpuCategory category, int minIdleFrames = 1);
+// O dono esvaziou o objeto: os bytes saem da conta até o próximo gpuTrack
+void gpuEvicted(GpuCategory category, GLuint name);
+bool gpuIsEvicted(GpuCategory category, GLuint name);
+
+// Ordenado por bytes, do maior para o menor
+std::vector<GpuAssetUsage> gpuUsageByAsset();
+// Total e pico por categoria, os maiores assets e o que foi esvaziado e recarregado
+void reportGpuMemory(size_t topAssets = 10);
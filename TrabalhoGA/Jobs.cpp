@@ -0,0 +1,333 @@
+#include "Jobs.h"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <memory>
+
+using namespace std;
+
+namespace
+{
+	// Fila dupla protegida por spinlock: as seções críticas são de poucas instruções
+	struct WorkerQueue
+	{
+		atomic<bool> locked{ false };
+		deque<Job> jobs;
+		atomic<int> size{ 0 };       // Cópia do tamanho, lida sem a trava por quem vai roubar
+
+		// Estatísticas (só o dono escreve)
+		atomic<uint64_t> executed{ 0 };
+		atomic<uint64_t> stolen{ 0 };
+		atomic<uint64_t> busyNs{ 0 };
+
+		void lock()
+		{
+			while (locked.exchange(true, memory_order_acquire))
+				while (locked.load(memory_order_relaxed)) this_thread::yield();
+		}
+		void unlock() { locked.store(false, memory_order_release); }
+	};
+
+	vector<unique_ptr<WorkerQueue>> queues;
+	vector<thread> threads;
+	atomic<bool> running{ false };
+	atomic<int> queuedJobs{ 0 };   // Jobs em alguma fila (para as threads saberem quando dormir)
+	atomic<int> sleepingWorkers{ 0 };
+	mutex sleepMutex;
+	condition_variable wakeUp;
+	atomic<JobProfileHook> profileHook{ nullptr };
+	chrono::high_resolution_clock::time_point startTime;
+
+	thread_local int workerIndex = 0; // A thread principal (e qualquer outra externa) usa a fila 0
+
+	const int SPIN_BEFORE_SLEEP = 64;
+
+	// Encerra as threads se o programa sair sem chamar shutdownJobSystem (retornos antecipados do main)
+	struct JobSystemGuard { ~JobSystemGuard() { shutdownJobSystem(); } } jobSystemGuard;
+
+	bool popOwn(int worker, Job& job)
+	{
+		WorkerQueue& q = *queues[worker];
+		q.lock();
+		bool found = !q.jobs.empty();
+		if (found)
+		{
+			job = q.jobs.back();
+			q.jobs.pop_back();
+			q.size.fetch_sub(1, memory_order_relaxed);
+		}
+		q.unlock();
+		return found;
+	}
+
+	bool steal(int worker, Job& job)
+	{
+		int n = (int)queues.size();
+		for (int k = 1; k < n; k++)
+		{
+			WorkerQueue& victim = *queues[(worker + k) % n];
+			if (victim.size.load(memory_order_relaxed) == 0) continue; // Leitura otimista, confirmada com a trava
+			victim.lock();
+			bool found = !victim.jobs.empty();
+			if (found)
+			{
+				job = victim.jobs.front();
+				victim.jobs.pop_front();
+				victim.size.fetch_sub(1, memory_order_relaxed);
+			}
+			victim.unlock();
+			if (found)
+			{
+				queues[worker]->stolen.fetch_add(1, memory_order_relaxed);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool takeJob(int worker, Job& job)
+	{
+		if (popOwn(worker, job) || steal(worker, job))
+		{
+			queuedJobs.fetch_sub(1);
+			return true;
+		}
+		return false;
+	}
+
+	void execute(int worker, const Job& job)
+	{
+		WorkerQueue& q = *queues[worker];
+		JobProfileHook hook = profileHook.load(memory_order_relaxed);
+		if (hook)
+		{
+			auto start = chrono::high_resolution_clock::now();
+			job.function(job.data, job.begin, job.end);
+			auto end = chrono::high_resolution_clock::now();
+			q.busyNs.fetch_add(chrono::duration_cast<chrono::nanoseconds>(end - start).count(), memory_order_relaxed);
+			hook(job.name ? job.name : "job", worker,
+				chrono::duration<double, milli>(start - startTime).count(),
+				chrono::duration<double, milli>(end - start).count());
+		}
+		else
+		{
+			job.function(job.data, job.begin, job.end);
+		}
+		q.executed.fetch_add(1, memory_order_relaxed);
+
+		// Por último: quem espera pode destruir os dados do job assim que o contador zerar
+		if (job.counter) job.counter->pending.fetch_sub(1, memory_order_release);
+	}
+
+	void workerLoop(int worker)
+	{
+		workerIndex = worker;
+		Job job;
+		int idle = 0;
+		while (running.load(memory_order_relaxed))
+		{
+			if (takeJob(worker, job))
+			{
+				execute(worker, job);
+				idle = 0;
+				continue;
+			}
+			if (++idle < SPIN_BEFORE_SLEEP)
+			{
+				this_thread::yield();
+				continue;
+			}
+
+			// Dorme até alguém publicar um job; o contador é relido com a trava para não perder o aviso
+			unique_lock<mutex> lock(sleepMutex);
+			sleepingWorkers++;
+			wakeUp.wait(lock, [] { return queuedJobs.load() > 0 || !running.load(); });
+			sleepingWorkers--;
+			idle = 0;
+		}
+	}
+
+	// Trabalho de ~1 µs para o benchmark, calibrado na máquina
+	atomic<int> benchmarkSink{ 0 };
+	int benchmarkIterations = 1;
+
+	void benchmarkWork(void*, size_t, size_t)
+	{
+		float x = 1.0f;
+		for (int i = 0; i < benchmarkIterations; i++) x = x * 0.999f + 0.5f;
+		benchmarkSink.store((int)x, memory_order_relaxed);
+	}
+
+	void emptyWork(void*, size_t, size_t) {}
+
+	double elapsedMs(chrono::high_resolution_clock::time_point start)
+	{
+		return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+	}
+}
+
+void initJobSystem(int workers)
+{
+	if (running) return;
+	if (workers <= 0) workers = max(1, (int)thread::hardware_concurrency());
+
+	startTime = chrono::high_resolution_clock::now();
+	queues.clear();
+	for (int i = 0; i < workers; i++) queues.emplace_back(new WorkerQueue());
+
+	running = true;
+	for (int i = 1; i < workers; i++) threads.emplace_back(workerLoop, i);
+	cout << "Sistema de jobs: " << workers << " threads" << endl;
+}
+
+void shutdownJobSystem()
+{
+	if (!running) return;
+	{
+		lock_guard<mutex> lock(sleepMutex);
+		running = false;
+	}
+	wakeUp.notify_all();
+	for (thread& t : threads) t.join();
+	threads.clear();
+	queues.clear();
+	queuedJobs = 0;
+}
+
+int jobWorkerCount()
+{
+	return (int)queues.size();
+}
+
+int currentJobWorker()
+{
+	return workerIndex;
+}
+
+void setJobProfileHook(JobProfileHook hook)
+{
+	profileHook = hook;
+}
+
+void runJob(const Job& job)
+{
+	if (job.counter) job.counter->pending.fetch_add(1, memory_order_relaxed);
+
+	// Sem sistema de jobs iniciado: executa na hora
+	if (queues.empty())
+	{
+		job.function(job.data, job.begin, job.end);
+		if (job.counter) job.counter->pending.fetch_sub(1, memory_order_release);
+		return;
+	}
+
+	WorkerQueue& q = *queues[workerIndex];
+	q.lock();
+	q.jobs.push_back(job);
+	q.size.fetch_add(1, memory_order_relaxed);
+	q.unlock();
+	queuedJobs.fetch_add(1);
+
+	if (sleepingWorkers.load() > 0)
+	{
+		lock_guard<mutex> lock(sleepMutex);
+		wakeUp.notify_one();
+	}
+}
+
+void runJob(function<void()> function, JobCounter* counter, const char* name)
+{
+	Job job;
+	job.function = [](void* data, size_t, size_t)
+	{
+		std::function<void()>* f = (std::function<void()>*)data;
+		(*f)();
+		delete f;
+	};
+	job.data = new std::function<void()>(std::move(function));
+	job.counter = counter;
+	job.name = name;
+	runJob(job);
+}
+
+void waitForCounter(JobCounter& counter)
+{
+	Job job;
+	while (counter.pending.load(memory_order_acquire) > 0)
+	{
+		if (!queues.empty() && takeJob(workerIndex, job))
+			execute(workerIndex, job);
+		else
+			this_thread::yield();
+	}
+}
+
+void reportJobStats()
+{
+	cout << "Jobs por thread (executados / roubados / ocupado ms):" << endl;
+	for (size_t i = 0; i < queues.size(); i++)
+	{
+		const WorkerQueue& q = *queues[i];
+		cout << "  [" << i << "] " << q.executed.load() << " / " << q.stolen.load()
+			<< " / " << fixed << setprecision(3) << q.busyNs.load() / 1e6 << defaultfloat << endl;
+	}
+}
+
+void benchmarkJobSystem(int jobs)
+{
+	if (queues.empty()) initJobSystem();
+	jobs = max(jobs, 1);
+
+	// Calibra o laço para ~1 µs por job
+	benchmarkIterations = 1000;
+	auto start = chrono::high_resolution_clock::now();
+	for (int i = 0; i < 1000; i++) benchmarkWork(nullptr, 0, 0);
+	double perJobUs = elapsedMs(start); // 1000 jobs => ms equivale a µs por job
+	benchmarkIterations = max(1, (int)(benchmarkIterations / max(perJobUs, 1e-3)));
+
+	start = chrono::high_resolution_clock::now();
+	for (int i = 0; i < jobs; i++) benchmarkWork(nullptr, 0, 0);
+	double serialMs = elapsedMs(start);
+
+	// Jobs vazios: custo puro de publicar, pegar e sinalizar o contador
+	JobCounter counter;
+	Job job;
+	job.function = emptyWork;
+	job.counter = &counter;
+	job.name = "vazio";
+	start = chrono::high_resolution_clock::now();
+	for (int i = 0; i < jobs; i++) runJob(job);
+	waitForCounter(counter);
+	double emptyMs = elapsedMs(start);
+
+	// Um job de ~1 µs por elemento, publicados um a um pela thread principal
+	job.function = benchmarkWork;
+	job.name = "1us";
+	start = chrono::high_resolution_clock::now();
+	for (int i = 0; i < jobs; i++) runJob(job);
+	waitForCounter(counter);
+	double singleMs = elapsedMs(start);
+
+	// parallelFor agrupando 64 jobs por bloco
+	start = chrono::high_resolution_clock::now();
+	parallelFor((size_t)jobs, 64, [](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++) benchmarkWork(nullptr, 0, 0);
+	}, "1us-lote");
+	double batchedMs = elapsedMs(start);
+
+	cout << fixed << setprecision(3);
+	cout << "==== Benchmark do sistema de jobs (" << jobWorkerCount() << " threads, " << jobs << " jobs) ====" << endl;
+	cout << "Serial (1 us/job): " << serialMs << " ms" << endl;
+	cout << "Jobs vazios: " << emptyMs << " ms (" << emptyMs * 1e6 / jobs << " ns/job)" << endl;
+	cout << "Jobs de 1 us: " << singleMs << " ms (speedup " << serialMs / singleMs << "x)" << endl;
+	cout << "parallelFor (64 por bloco): " << batchedMs << " ms (speedup " << serialMs / batchedMs << "x)" << endl;
+	cout << defaultfloat;
+	reportJobStats();
+}
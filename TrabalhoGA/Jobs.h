@@ -0,0 +1,92 @@
+// Sistema de jobs com roubo de trabalho
+//
+// Uma thread de trabalho por núcleo (a thread principal conta como a de índice 0). Cada thread
+// tem sua fila dupla: o dono empilha e desempilha no fim (LIFO, dados quentes na cache) e as
+// threads ociosas roubam do início (FIFO, os pedaços maiores). Dependências são expressas com
+// contadores: cada job decrementa o seu ao terminar e waitForCounter executa outros jobs
+// enquanto espera, então é seguro esperar de dentro de um job.
+//
+// Uso típico:
+//     parallelFor(n, 256, [&](size_t begin, size_t end) { ... }, "nome");
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <type_traits>
+
+// Contador de jobs pendentes; a espera termina quando chega a zero
+struct JobCounter
+{
+	std::atomic<int> pending{ 0 };
+};
+
+// Job de baixo nível: função sobre o intervalo [begin, end) com um ponteiro de dados
+struct Job
+{
+	void (*function)(void* data, size_t begin, size_t end) = nullptr;
+	void* data = nullptr;
+	size_t begin = 0, end = 0;
+	JobCounter* counter = nullptr;
+	const char* name = nullptr;   // Nome para o profiling (literal, não é copiado)
+};
+
+// Chamado ao fim de cada job, na thread que o executou (tempos em ms desde initJobSystem)
+typedef void (*JobProfileHook)(const char* name, int worker, double startMs, double durationMs);
+
+// workers = 0 usa um por núcleo
+void initJobSystem(int workers = 0);
+void shutdownJobSystem();
+int jobWorkerCount();
+int currentJobWorker();
+
+void setJobProfileHook(JobProfileHook hook);
+
+// Enfileira na fila da thread corrente; incrementa job.counter antes de publicar
+void runJob(const Job& job);
+
+// Job avulso (carregamento de um asset, por exemplo); a função é copiada
+void runJob(std::function<void()> function, JobCounter* counter, const char* name = nullptr);
+
+// Executa outros jobs até o contador zerar
+void waitForCounter(JobCounter& counter);
+
+// Estatísticas acumuladas por thread (jobs executados, roubados, tempo ocupado)
+void reportJobStats();
+
+// Mede o custo de agendamento com jobs de ~1 µs e compara com a execução serial
+void benchmarkJobSystem(int jobs);
+
+// Divide [0, count) em blocos de até grain elementos e espera todos terminarem.
+// Sem threads de trabalho (ou com um bloco só) roda direto na thread corrente.
+template <typename F>
+void parallelFor(size_t count, size_t grain, F&& body, const char* name = nullptr)
+{
+	if (count == 0) return;
+	if (grain == 0) grain = 1;
+	if (jobWorkerCount() <= 1 || count <= grain)
+	{
+		body((size_t)0, count);
+		return;
+	}
+
+	typedef typename std::remove_reference<F>::type Body;
+	JobCounter counter;
+	Job job;
+	job.function = [](void* data, size_t begin, size_t end) { (*(Body*)data)(begin, end); };
+	job.data = (void*)&body;
+	job.counter = &counter;
+	job.name = name;
+
+	// O primeiro bloco fica para a thread corrente, os demais vão para a fila
+	for (size_t begin = grain; begin < count; begin += grain)
+	{
+		job.begin = begin;
+		job.end = begin + grain < count ? begin + grain : count;
+		runJob(job);
+	}
+	body((size_t)0, grain);
+	waitForCounter(counter);
+}
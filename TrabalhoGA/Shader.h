@@ -7,95 +7,183 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
 
 //GLAD
 #include <glad/glad.h>
+#include "GLExtensions.h"
+#include "Cache.h"
+#include "FileWatch.h"
 
 // GLFW
 #include <GLFW/glfw3.h>
 
 using namespace std;
 
+// Cache de programas linkados (GL 4.1 ou ARB_get_program_binary): depois do primeiro link, o binário
+// do driver vai para ./cache/*.prog e nas execuções seguintes é carregado com glProgramBinary, sem
+// compilar. O arquivo guarda o hash dos fontes de todos os estágios e de GL_VENDOR/RENDERER/VERSION,
+// então editar um shader ou trocar de driver refaz o binário; se o driver recusar o binário (o que
+// ele pode fazer a qualquer momento), o programa é compilado dos fontes e o arquivo regravado
+//
+// Hot reload: com watch, os fontes entram num FileWatcher; quando um deles muda, reload compila e
+// linka um programa novo sem esperar o resultado (com GL_KHR_parallel_shader_compile o driver faz isso
+// nas suas threads) e updateReload, chamada a cada quadro, só consulta GL_COMPLETION_STATUS. O ID
+// troca só depois de um link com sucesso; com erro, o log é impresso e o programa anterior continua.
+// A cada troca version aumenta: as locations e os uniforms do programa antigo não valem mais
+struct ShaderStats
+{
+	int programs = 0;
+	int fromBinary = 0; // Carregados do cache
+	int rejected = 0;   // Binários recusados pelo driver
+	double ms = 0;      // Tempo total de compilação/carregamento
+};
+
 class Shader
 {
 public:
 	GLuint ID;
+	double buildMs = 0;      // Tempo para criar o programa
+	bool fromBinary = false; // Veio do cache de binários
+	int version = 0;         // Trocas de programa pelo hot reload
+
 	// Constructor generates the shader on the fly
 	Shader(const GLchar* vertexPath, const GLchar* fragmentPath)
 	{
-		// 1. Retrieve the vertex/fragment source code from filePath
-		std::string vertexCode;
-		std::string fragmentCode;
-		std::ifstream vShaderFile;
-		std::ifstream fShaderFile;
-		// ensures ifstream objects can throw exceptions:
-		vShaderFile.exceptions(std::ifstream::badbit);
-		fShaderFile.exceptions(std::ifstream::badbit);
-		try
+		GLenum types[2] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+		const GLchar* paths[2] = { vertexPath, fragmentPath };
+		build(types, paths, 2);
+	}
+
+	// Programa com tesselação (GL 4.0+): vertex -> controle -> avaliação -> fragment
+	Shader(const GLchar* vertexPath, const GLchar* tessControlPath, const GLchar* tessEvaluationPath, const GLchar* fragmentPath)
+	{
+		GLenum types[4] = { GL_VERTEX_SHADER, GL_TESS_CONTROL_SHADER, GL_TESS_EVALUATION_SHADER, GL_FRAGMENT_SHADER };
+		const GLchar* paths[4] = { vertexPath, tessControlPath, tessEvaluationPath, fragmentPath };
+		build(types, paths, 4);
+	}
+
+	// Somas de todos os programas criados até agora
+	static ShaderStats& stats()
+	{
+		static ShaderStats shaderStats;
+		return shaderStats;
+	}
+
+	void watch(FileWatcher& watcher) const
+	{
+		for (int i = 0; i < stageCount; i++)
+			watchFile(watcher, paths[i]);
+	}
+
+	bool usesFile(const std::string& path) const
+	{
+		for (int i = 0; i < stageCount; i++)
+			if (paths[i] == path) return true;
+		return false;
+	}
+
+	bool reloading() const
+	{
+		return pendingProgram != 0;
+	}
+
+	// Começa a recompilar dos fontes (uma recompilação em andamento é descartada)
+	void reload()
+	{
+		cancelReload();
+		std::string sources[4];
+		for (int i = 0; i < stageCount; i++)
 		{
-			// Open files
-			vShaderFile.open(vertexPath);
-			fShaderFile.open(fragmentPath);
-			std::stringstream vShaderStream, fShaderStream;
-			// Read file's buffer contents into streams
-			vShaderStream << vShaderFile.rdbuf();
-			fShaderStream << fShaderFile.rdbuf();
-			// close file handlers
-			vShaderFile.close();
-			fShaderFile.close();
-			// Convert stream into string
-			vertexCode = vShaderStream.str();
-			fragmentCode = fShaderStream.str();
+			sources[i] = readSource(paths[i].c_str());
+			if (sources[i].empty()) return; // Arquivo sumiu ou está no meio de uma gravação
 		}
-		catch (std::ifstream::failure e)
+
+		parallelCompile();
+		pendingStart = std::chrono::steady_clock::now();
+		pendingKey = programKey(types, sources, stageCount);
+		pendingProgram = glCreateProgram();
+		for (int i = 0; i < stageCount; i++)
 		{
-			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+			pendingStages[i] = startStage(types[i], sources[i]);
+			glAttachShader(pendingProgram, pendingStages[i]);
 		}
-		const GLchar* vShaderCode = vertexCode.c_str();
-		const GLchar * fShaderCode = fragmentCode.c_str();
-		// 2. Compile shaders
-		GLuint vertex, fragment;
-		GLint success;
-		GLchar infoLog[512];
-		// Vertex Shader
-		vertex = glCreateShader(GL_VERTEX_SHADER);
-		glShaderSource(vertex, 1, &vShaderCode, NULL);
-		glCompileShader(vertex);
-		// Print compile errors if any
-		glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-		if (!success)
+		if (binariesSupported())
+			glProgramParameteri(pendingProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		glLinkProgram(pendingProgram);
+	}
+
+	// Uma vez por quadro: true quando o programa novo entrou no lugar do ID
+	bool updateReload()
+	{
+		if (pendingProgram == 0) return false;
+		if (parallelCompile())
 		{
-			glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+			GLint done = GL_FALSE;
+			glGetProgramiv(pendingProgram, GL_COMPLETION_STATUS_KHR, &done);
+			if (!done) return false;
 		}
-		// Fragment Shader
-		fragment = glCreateShader(GL_FRAGMENT_SHADER);
-		glShaderSource(fragment, 1, &fShaderCode, NULL);
-		glCompileShader(fragment);
-		// Print compile errors if any
-		glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
+
+		GLint success;
+		glGetProgramiv(pendingProgram, GL_LINK_STATUS, &success);
 		if (!success)
 		{
-			glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+			GLchar infoLog[512];
+			bool compiled = true;
+			for (int i = 0; i < stageCount; i++)
+			{
+				glGetShaderiv(pendingStages[i], GL_COMPILE_STATUS, &success);
+				if (success) continue;
+				glGetShaderInfoLog(pendingStages[i], 512, NULL, infoLog);
+				std::cout << "ERROR::SHADER::" << stageName(types[i]) << "::COMPILATION_FAILED (" << paths[i] << ")\n" << infoLog << std::endl;
+				compiled = false;
+			}
+			if (compiled)
+			{
+				glGetProgramInfoLog(pendingProgram, 512, NULL, infoLog);
+				std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+			}
+			std::cout << "Shader " << label() << " nao recarregado: mantendo o programa anterior" << std::endl;
+			cancelReload();
+			return false;
 		}
-		// Shader Program
-		this->ID = glCreateProgram();
-		glAttachShader(this->ID, vertex);
-		glAttachShader(this->ID, fragment);
-		glLinkProgram(this->ID);
-		// Print linking errors if any
-		glGetProgramiv(this->ID, GL_LINK_STATUS, &success);
-		if (!success)
+
+		for (int i = 0; i < stageCount; i++)
 		{
-			glGetProgramInfoLog(this->ID, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+			glDetachShader(pendingProgram, pendingStages[i]);
+			glDeleteShader(pendingStages[i]);
 		}
-		// Delete the shaders as they're linked into our program now and no longer necessery
-		glDeleteShader(vertex);
-		glDeleteShader(fragment);
+		glDeleteProgram(this->ID);
+		this->ID = pendingProgram;
+		pendingProgram = 0;
+		this->version++;
+		if (binariesSupported())
+			saveBinary(cachePath(label(), "prog"), pendingKey);
+		std::cout << "Shader " << label() << " recarregado em "
+			<< std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pendingStart).count() << " ms" << std::endl;
+		return true;
+	}
+
+	void cancelReload()
+	{
+		if (pendingProgram == 0) return;
+		for (int i = 0; i < stageCount; i++)
+			glDeleteShader(pendingStages[i]);
+		glDeleteProgram(pendingProgram);
+		pendingProgram = 0;
+	}
 
+	static void reportStats()
+	{
+		const ShaderStats& s = stats();
+		std::cout << "Shaders: " << s.programs << " programas em " << s.ms << " ms (" << s.fromBinary << " do cache de binarios";
+		if (s.rejected > 0) std::cout << ", " << s.rejected << " recusados pelo driver";
+		std::cout << ")" << std::endl;
 	}
+
 	// Uses the current shader
 	void Use()
 	{
@@ -137,5 +225,241 @@ public:
 	{
 		glUniformMatrix4fv(glGetUniformLocation(this->ID, name.c_str()), 1, GL_FALSE, v);
 	}
+
+private:
+	// Cabeçalho do arquivo .prog, seguido de length bytes do binário
+	struct BinaryHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t key;
+		uint32_t format;
+		uint32_t length;
+	};
+	static const uint32_t BINARY_MAGIC = 0x47525053; // "SPRG"
+	static const uint32_t BINARY_VERSION = 1;
+
+	// Estágios do programa, para o hot reload
+	GLenum types[4];
+	std::string paths[4];
+	int stageCount = 0;
+	// Recompilação em andamento (0 = nenhuma)
+	GLuint pendingProgram = 0;
+	GLuint pendingStages[4] = {};
+	uint64_t pendingKey = 0;
+	std::chrono::steady_clock::time_point pendingStart;
+
+	void build(const GLenum* stageTypes, const GLchar* const* stagePaths, int count)
+	{
+		auto start = std::chrono::steady_clock::now();
+		std::string sources[4];
+		stageCount = count;
+		for (int i = 0; i < count; i++)
+		{
+			types[i] = stageTypes[i];
+			paths[i] = stagePaths[i];
+			sources[i] = readSource(stagePaths[i]);
+		}
+
+		uint64_t key = programKey(types, sources, count);
+		std::string binaryPath = cachePath(label(), "prog");
+		this->ID = 0;
+		this->fromBinary = binariesSupported() && loadBinary(binaryPath, key);
+		if (!this->fromBinary)
+		{
+			GLuint stages[4];
+			for (int i = 0; i < count; i++)
+				stages[i] = compileStage(types[i], stageName(types[i]), sources[i]);
+			if (link(stages, count) && binariesSupported())
+				saveBinary(binaryPath, key);
+		}
+
+		this->buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		ShaderStats& s = stats();
+		s.programs++;
+		s.fromBinary += this->fromBinary ? 1 : 0;
+		s.ms += this->buildMs;
+	}
+
+	// Nome do programa no cache e nas mensagens: os arquivos dos estágios
+	std::string label() const
+	{
+		std::string text;
+		for (int i = 0; i < stageCount; i++)
+			text += (i > 0 ? "+" : "") + paths[i];
+		return text;
+	}
+
+	// Pede ao driver todas as threads de compilação que ele tiver; false sem a extensão
+	static bool parallelCompile()
+	{
+		static int parallel = -1;
+		if (parallel < 0)
+		{
+			parallel = glMaxShaderCompilerThreadsKHR ? 1 : 0;
+			if (parallel) glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+		}
+		return parallel == 1;
+	}
+
+	static const char* stageName(GLenum type)
+	{
+		switch (type)
+		{
+		case GL_VERTEX_SHADER: return "VERTEX";
+		case GL_TESS_CONTROL_SHADER: return "TESS_CONTROL";
+		case GL_TESS_EVALUATION_SHADER: return "TESS_EVALUATION";
+		default: return "FRAGMENT";
+		}
+	}
+
+	// O binário só vale para os mesmos fontes no mesmo driver
+	static uint64_t programKey(const GLenum* types, const std::string* sources, int count)
+	{
+		uint32_t version = BINARY_VERSION;
+		uint64_t key = hashBytes(&version, sizeof(version));
+		const GLenum strings[3] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+		for (GLenum name : strings)
+		{
+			const char* value = (const char*)glGetString(name);
+			if (value) key = hashBytes(value, strlen(value) + 1, key);
+		}
+		for (int i = 0; i < count; i++)
+		{
+			key = hashBytes(&types[i], sizeof(GLenum), key);
+			key = hashBytes(sources[i].data(), sources[i].size() + 1, key);
+		}
+		return key;
+	}
+
+	static bool binariesSupported()
+	{
+		static int supported = -1;
+		if (supported < 0)
+		{
+			GLint formats = 0;
+			if (glGetProgramBinary && glProgramBinary && glProgramParameteri)
+				glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+			supported = formats > 0 ? 1 : 0;
+		}
+		return supported == 1;
+	}
+
+	bool loadBinary(const std::string& path, uint64_t key)
+	{
+		std::vector<char> file;
+		if (!readFileBytes(path, file) || file.size() < sizeof(BinaryHeader)) return false;
+		BinaryHeader header;
+		memcpy(&header, file.data(), sizeof(header));
+		if (header.magic != BINARY_MAGIC || header.version != BINARY_VERSION || header.key != key ||
+			file.size() != sizeof(header) + header.length)
+			return false;
+
+		GLuint program = glCreateProgram();
+		glProgramBinary(program, header.format, file.data() + sizeof(header), (GLsizei)header.length);
+		GLint success = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		if (!success)
+		{
+			// Formato que o driver não aceita mais (atualização, outra GPU): compila dos fontes
+			while (glGetError() != GL_NO_ERROR) {}
+			glDeleteProgram(program);
+			stats().rejected++;
+			return false;
+		}
+		this->ID = program;
+		return true;
+	}
+
+	void saveBinary(const std::string& path, uint64_t key) const
+	{
+		GLint length = 0;
+		glGetProgramiv(this->ID, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0) return;
+
+		std::vector<char> file(sizeof(BinaryHeader) + length);
+		BinaryHeader header = { BINARY_MAGIC, BINARY_VERSION, key, 0, 0 };
+		GLsizei written = 0;
+		GLenum format = 0;
+		glGetProgramBinary(this->ID, length, &written, &format, file.data() + sizeof(header));
+		if (written <= 0) return;
+		header.format = format;
+		header.length = (uint32_t)written;
+		memcpy(file.data(), &header, sizeof(header));
+		file.resize(sizeof(header) + written);
+		writeFileBytes(path, file);
+	}
+
+	// 1. Retrieve the source code from filePath
+	static std::string readSource(const GLchar* path)
+	{
+		std::ifstream shaderFile;
+		// ensures ifstream objects can throw exceptions:
+		shaderFile.exceptions(std::ifstream::badbit);
+		try
+		{
+			shaderFile.open(path);
+			std::stringstream shaderStream;
+			shaderStream << shaderFile.rdbuf();
+			shaderFile.close();
+			return shaderStream.str();
+		}
+		catch (std::ifstream::failure e)
+		{
+			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+		}
+		return std::string();
+	}
+
+	// 2. Compile shaders
+	// Só envia o fonte e pede a compilação: o resultado é consultado depois
+	static GLuint startStage(GLenum type, const std::string& code)
+	{
+		const GLchar* shaderCode = code.c_str();
+		GLuint shader = glCreateShader(type);
+		glShaderSource(shader, 1, &shaderCode, NULL);
+		glCompileShader(shader);
+		return shader;
+	}
+
+	static GLuint compileStage(GLenum type, const char* name, const std::string& code)
+	{
+		GLint success;
+		GLchar infoLog[512];
+		GLuint shader = startStage(type, code);
+		// Print compile errors if any
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+		if (!success)
+		{
+			glGetShaderInfoLog(shader, 512, NULL, infoLog);
+			std::cout << "ERROR::SHADER::" << name << "::COMPILATION_FAILED\n" << infoLog << std::endl;
+		}
+		return shader;
+	}
+
+	// 3. Shader Program
+	bool link(const GLuint* stages, int count)
+	{
+		GLint success;
+		GLchar infoLog[512];
+		this->ID = glCreateProgram();
+		for (int i = 0; i < count; i++)
+			glAttachShader(this->ID, stages[i]);
+		// Sem a dica o driver pode não guardar o binário para glGetProgramBinary
+		if (binariesSupported())
+			glProgramParameteri(this->ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		glLinkProgram(this->ID);
+		// Print linking errors if any
+		glGetProgramiv(this->ID, GL_LINK_STATUS, &success);
+		if (!success)
+		{
+			glGetProgramInfoLog(this->ID, 512, NULL, infoLog);
+			std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+		}
+		// Delete the shaders as they're linked into our program now and no longer necessery
+		for (int i = 0; i < count; i++)
+			glDeleteShader(stages[i]);
+		return success == GL_TRUE;
+	}
 };
 
@@ -18,6 +18,7 @@
 #include <fstream>
 #include <sstream>
 #include <unordered_map>
+#include <unordered_set>
 #include <json.hpp>
 
 
@@ -34,6 +35,7 @@ using json = nlohmann::json;
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/constants.hpp>
 
 //STB_IMAGE
 #include <stb_image.h>
@@ -43,17 +45,50 @@ using json = nlohmann::json;
 
 #include <random>
 #include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <climits>
+#include <cfloat>
 
 //Classe gerenciadora de shaders
 #include "Shader.h"
+#include "FileWatch.h"
+
+//BVH de triângulos e cache de assets cozidos
+#include "BVH.h"
+#include "Cache.h"
+
+//Funções do GL acima do 4.0 (glTexStorage2D, ...)
+#include "GLExtensions.h"
+
+//Texturas compartilhadas entre objetos (uma decodificação por imagem)
+#include "Texture.h"
+
+//Bytes de cada buffer e textura na GPU, com orçamento
+#include "GpuMemory.h"
+
+//Modo de benchmark e medição de tempo por subsistema
+#include "Benchmark.h"
+
+//Curvas e agentes que as percorrem
+#include "Curve.h"
+#include "CurveRenderer.h"
+#include "CurveQuery.h"
+#include "Agents.h"
+
+//Animação por quadros-chave (clipes do config.json)
+#include "Animation.h"
+
+//Sistema de jobs (threads de trabalho)
+#include "Jobs.h"
 
 // Protótipo da função de callback de teclado
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
 
 // Protótipos das funções
 int setupGeometry();
-int loadSimpleOBJ(string filePATH, int &nVertices);
-GLuint loadTexture(string filePath, int& width, int& height);
+int loadSimpleOBJ(string filePATH, int &nVertices, BVH* bvh = nullptr);
 //std::unordered_map<std::string, Material> loadMTL(const std::string& filePath);
 
 // Dimensões da janela (pode ser alterado em tempo de execução)
@@ -69,6 +104,20 @@ struct GeneralConfig {
 	glm::vec3 cameraUp;
 	glm::vec3 lightPos;
 	glm::vec3 lightColor;
+	float curveTolerance;     // Erro de corda máximo das curvas (0 = nro fixo de pontos)
+	bool curveScreenSpace;    // curveTolerance em pixels, re-tesselando quando a câmera muda
+	float curveRetessellate;  // Variação relativa do tamanho da curva na tela que pede nova tesselação
+	bool drawCurve;           // Desenha a Catmull-Rom seguida pelos agentes
+	float curvePixelsPerLine; // Comprimento na tela de cada trecho de reta da curva tesselada na GPU
+	float curveLineWidth;     // Largura da curva em pixels (0 = linha fina tesselada na GPU)
+	float controlPointSize;   // Diâmetro dos marcadores dos pontos de controle em pixels (0 = sem marcadores)
+	std::string textureCompression; // "none", "bc1", "bc3", "bc7" ou "auto" (BC1 se opaca, BC7 se tem alfa)
+	std::string textureQuality;     // "fast", "normal" ou "high"
+	std::string mipFilter;          // "box", "kaiser" ou "lanczos"
+	bool mipSrgb;                   // Filtra os mipmaps em espaço linear (texturas de cor em sRGB)
+	float alphaCutoff;              // Corte do teste de alfa cuja cobertura os mipmaps preservam (0 = desligado)
+	float textureBudgetMB;          // VRAM das texturas grandes carregadas por demanda (0 = carrega tudo)
+	float gpuBudgetMB;              // Memória de GPU total; acima dela malhas e texturas são esvaziadas (0 = sem limite)
 };
 
 struct ObjectConfig {
@@ -79,23 +128,24 @@ struct ObjectConfig {
 	glm::vec3 rotation;       // Rotação inicial (em graus)
 	float scale;              // Escala inicial
 	bool eMovel;			  // Para verificar se o objeto é móvel ou não
+	int agentCount;           // Nro de cópias do móvel percorrendo a curva
+	float speed;              // Velocidade do móvel (unidades por segundo, constante ao longo da curva)
+	float spread;             // Deslocamento máximo de cada cópia em relação à curva
 };
 
 struct Object
 {
-	GLuint VAO; //Índice do buffer de geometria
-	GLuint texID; //Identificador da textura carregada
-	int nVertices; //nro de vértices
+	GLuint VAO = 0; //Índice do buffer de geometria
+	GLuint VBO = 0; //Buffer de vértices (pode ser esvaziado pelo orçamento de GPU e recarregado)
+	TextureHandle texture = -1; //Referência no gerenciador de texturas
+	TextureBinding binding; //Textura 2D ou camada de um array (refeito quando as texturas são empacotadas)
+	glm::vec3 boundsCenter = glm::vec3(0.0f); //Esfera envolvente da malha (espaço de objeto), para o streaming de texturas
+	float boundsRadius = 0.0f;
+	int nVertices = 0; //nro de vértices
 	glm::mat4 model; //matriz de transformações do objeto
-	float ka, kd, ks; //coeficientes de iluminação - material do objeto
-
-};
+	float ka, kd, ks, q; //coeficientes de iluminação - material do objeto (animáveis)
+	BVH bvh; //BVH de triângulos para consultas de raio (picking)
 
-struct Curve
-{
-	std::vector<glm::vec3> controlPoints; // Pontos de controle da curva
-	std::vector<glm::vec3> curvePoints;   // Pontos da curva
-	glm::mat4 M;                          // Matriz dos coeficientes da curva
 };
 
 struct Material {
@@ -107,10 +157,58 @@ struct Material {
 
 
 
+// Malha cozida: buffer de vértices intercalado + BVH, salva em ./cache
+struct CookedMesh
+{
+	vector<GLfloat> vBuffer; // 11 floats por vértice (posição, cor, uv, normal)
+	BVH bvh;
+	bool fromCache = false;
+};
+
+// Recarga de um VBO esvaziado: os vértices são lidos num worker e enviados no quadro em que ficam prontos
+struct MeshReload
+{
+	string path;
+	vector<GLfloat> vBuffer;
+	bool ok = false;
+	bool failed = false; // Não é tentado de novo
+	JobCounter done;
+};
+
 // Protótipo das funções de configuração
 std::vector<ObjectConfig> loadObjectConfig(const std::string& configFile);
 std::vector<GeneralConfig> loadGeneralConfig(const std::string& configFile);
 
+// Protótipo das funções do cache de malhas e do picking
+bool cookMesh(const string& filePath, CookedMesh& mesh);
+int uploadMesh(const string& filePath, const CookedMesh& mesh, int& nVertices, BVH* bvh = nullptr);
+bool loadCookedMesh(const string& sourcePath, uint64_t sourceHash, CookedMesh& mesh);
+bool loadCookedVertices(const string& sourcePath, vector<GLfloat>& vBuffer);
+void saveCookedMesh(const string& sourcePath, uint64_t sourceHash, const CookedMesh& mesh);
+glm::mat4 objectModel(size_t i);
+void applyAnimations(const AnimationSet& animations, std::vector<Object>& objects);
+void pickRay(const glm::mat4& view, const glm::mat4& projection, double x, double y, int width, int height, glm::vec3& origin, glm::vec3& dir);
+int pickObject(const std::vector<Object>& objects, const glm::mat4& view, const glm::mat4& projection, double x, double y, int width, int height);
+int pickCurvePoint(const CurveBVH& bvh, const ArcLengthTable& table, const glm::mat4& view, const glm::mat4& projection, float pixelsPerUnit,
+	double x, double y, int width, int height);
+std::vector<size_t> sortByTexture(std::vector<Object>& objects, const TextureCache& textures);
+void bindTexture(const TextureBinding& binding, GLuint bound[2]);
+float screenDiameter(const Object& object, const glm::vec3& cameraPos, const glm::vec3& cameraFront, float pixelsPerUnit);
+GLuint meshBuffer(GLuint VAO);
+void evictMeshes();
+void reloadMesh(GLuint VBO);
+void updateMeshReloads();
+void finishMeshReloads();
+void deleteMesh(GLuint VAO);
+
+// Simulação em passo fixo (padrão acumulador), desacoplada da taxa de renderização
+const double SIM_DT = 1.0 / 90.0; // 90 passos de simulação por segundo
+const int MAX_SIM_STEPS = 8;      // Limite de passos por quadro, para não entrar em espiral após uma travada
+
+// Quadros sem ser desenhada até uma malha poder ser esvaziada (evita esvaziar e recarregar a cada giro da câmera)
+const int MESH_EVICT_FRAMES = 120;
+unordered_map<GLuint, shared_ptr<MeshReload>> meshReloads; // Por VBO
+
 
 // Carregando o arquivo de configuração e setando as variáveis de transformação
 std::vector<GeneralConfig> Gconfigs = loadGeneralConfig("./config.json");
@@ -131,34 +229,98 @@ vector<float> rotateX(NRO_OBJETOS, 0.0f);
 vector<float> rotateY(NRO_OBJETOS, 0.0f);
 vector<float> rotateZ(NRO_OBJETOS, 0.0f);
 
+// Objetos com trilha de rotação usam o quatérnio amostrado no lugar dos ângulos
+vector<glm::quat> orientacao(NRO_OBJETOS, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+vector<char> rotacaoAnimada(NRO_OBJETOS, 0);
+
 int indice = 0;
 
+// Picking com o mouse: o callback só registra o clique, o teste é feito no loop
+bool pickRequested = false;
+double pickX = 0.0, pickY = 0.0;
+
+// Edição da Catmull-Rom (tecla C): o callback acumula o deslocamento do ponto, aplicado no loop
+bool curveEditMode = false;
+int curveEditPoint = 1;       // Pontos 1 a curveEditPointCount (as pontas duplicadas acompanham)
+int curveEditPointCount = 0;
+glm::vec3 curveEditDelta(0.0f);
+
 
-//Funções da curva
-void initializeBernsteinMatrix(glm::mat4x4& matrix);
-void generateBezierCurvePoints(Curve& curve, int numPoints);
-void generateGlobalBezierCurvePoints(Curve& curve, int numPoints);
-void initializeCatmullRomMatrix(glm::mat4x4& matrix);
-void generateCatmullRomCurvePoints(Curve& curve, int numPoints);
-void displayCurve(const Curve& curve);
-GLuint generateControlPointsBuffer(vector<glm::vec3> controlPoints);
-std::vector<glm::vec3> generateHeartControlPoints(int numPoints);
-std::vector<glm::vec3> generateInfinityControlPoints(int numPoints);
+//Buffer de geometria dos pontos da curva
+GLuint generateControlPointsBuffer(const vector<glm::vec3>& controlPoints);
+void updateCurvePointsBuffer(GLuint VAO, const vector<glm::vec3>& points);
+void updateCurvePointsRange(GLuint VAO, const vector<glm::vec3>& points, const CurvePointsUpdate& update);
+void deleteCurvePointsBuffer(GLuint VAO);
 
 
 
 // Função MAIN
-int main()
+int main(int argc, char** argv)
 {
+	// Parâmetros do modo de benchmark (--benchmark, --headless, ...)
+	BenchmarkConfig benchConfig = loadBenchmarkConfig("./config.json", argc, argv);
+
+	// Uma thread de trabalho por núcleo, usada no carregamento, na construção das BVHs e na simulação
+	initJobSystem(benchConfig.jobWorkers);
+	if (benchConfig.jobBenchmark)
+	{
+		benchmarkJobSystem(benchConfig.jobBenchmarkJobs);
+		shutdownJobSystem();
+		return 0;
+	}
+	if (benchConfig.curveBenchmark)
+	{
+		benchmarkCurves();
+		benchmarkCurveQueries();
+		shutdownJobSystem();
+		return 0;
+	}
+	if (benchConfig.animationBenchmark)
+	{
+		benchmarkAnimation();
+		shutdownJobSystem();
+		return 0;
+	}
+	if (benchConfig.textureBenchmark)
+	{
+		benchmarkMipGeneration("../Modelos3D");
+		benchmarkTextureCompression("../Modelos3D");
+		shutdownJobSystem();
+		return 0;
+	}
+	if (benchConfig.enabled)
+		setJobProfileHook(profileJob);
+
+	// Sem janela: plataforma nula da GLFW com contexto OSMesa (OpenGL por software)
+	if (benchConfig.headless)
+		glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+
 	// Inicialização da GLFW
 	glfwInit();
 
+	if (benchConfig.headless)
+	{
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	}
+
 	// Criação da janela GLFW
 	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "Trabalho GB - Pedro Brandelli", nullptr, nullptr);
+	if (!window)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
 	glfwMakeContextCurrent(window);
 
+	// No benchmark o quadro não pode ficar preso ao vsync
+	if (benchConfig.enabled)
+		glfwSwapInterval(0);
+
 	// Fazendo o registro da função de callback para a janela GLFW
 	glfwSetKeyCallback(window, key_callback);
+	glfwSetMouseButtonCallback(window, mouse_button_callback);
 
 	// GLAD: carrega todos os ponteiros d funções da OpenGL
 	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
@@ -166,6 +328,7 @@ int main()
 		std::cout << "Failed to initialize GLAD" << std::endl;
 
 	}
+	loadGLExtensions((GLADloadproc)glfwGetProcAddress);
 
 	// Obtendo as informações de versão
 	const GLubyte* renderer = glGetString(GL_RENDERER); /* get renderer string */
@@ -181,35 +344,100 @@ int main()
 	// Compilando e buildando o programa de shader
 	Shader shaderCurva = Shader("./hello-curves.vs", "./hello-curves.fs");
 	Shader shader = Shader("phong.vs","phong.fs");
+	Shader shaderInstanced = Shader("phong-instanced.vs", "phong.fs");
+	Shader shaderPatches = Shader("curve-patches.vs", "curve-patches.tcs", "curve-patches.tes", "hello-curves.fs");
+	Shader shaderLines = Shader("curve-lines.vs", "curve-lines.fs");
+	Shader::reportStats();
+
+	// Hot reload: os shaders são recompilados quando um fonte é salvo (fora do benchmark)
+	Shader* shaders[] = { &shaderCurva, &shader, &shaderInstanced, &shaderPatches, &shaderLines };
+	FileWatcher shaderWatcher;
+	if (!benchConfig.enabled)
+		for (Shader* s : shaders) s->watch(shaderWatcher);
+
+	// Grupos de agentes: cada objeto móvel vira um grupo que percorre a curva
+	std::vector<AgentGroup> agentGroups;
+	std::vector<int> agentConfigs; // Índice em configs de cada grupo (-1 para o grupo do benchmark)
+
+	TextureCache textures;
+	setTextureCompression(textures, parseTextureFormat(Gconfigs[0].textureCompression), parseCompressionQuality(Gconfigs[0].textureQuality));
+	MipSettings mipSettings;
+	mipSettings.filter = parseMipFilter(Gconfigs[0].mipFilter);
+	mipSettings.srgb = Gconfigs[0].mipSrgb;
+	mipSettings.alphaCutoff = Gconfigs[0].alphaCutoff;
+	setTextureMipSettings(textures, mipSettings);
+	// Sem orçamento próprio, as texturas grandes usam o da GPU (é o streaming que as reduz)
+	setGpuBudget((size_t)(Gconfigs[0].gpuBudgetMB * 1024.0f * 1024.0f));
+	float textureBudgetMB = Gconfigs[0].textureBudgetMB > 0.0f ? Gconfigs[0].textureBudgetMB : Gconfigs[0].gpuBudgetMB;
+	setTextureStreaming(textures, (size_t)(textureBudgetMB * 1024.0f * 1024.0f));
+	bool texturesReported = false; // Relatório impresso quando a última textura fica residente
+	double lastTime = 0.0;
+	double accumulator = 0.0;
+
+	// Parsing das malhas (e construção das BVHs) em paralelo, uma vez por arquivo;
+	// a criação dos buffers na GPU fica na thread principal, dona do contexto
+	std::vector<string> meshPaths;
+	std::unordered_map<string, size_t> meshIndex;
+	auto addMesh = [&](const string& path)
+	{
+		if (meshIndex.count(path) == 0)
+		{
+			meshIndex[path] = meshPaths.size();
+			meshPaths.push_back(path);
+		}
+	};
+	for (int i = 0; i < NRO_OBJETOS; ++i) addMesh(configs[i].modelPath);
+	if (benchConfig.enabled)
+		for (const BenchmarkMesh& m : benchConfig.meshes) addMesh(m.modelPath);
 
-	Object movel;
-
+	std::vector<CookedMesh> cookedMeshes(meshPaths.size());
+	std::vector<char> cookedOk(meshPaths.size(), 0);
+	parallelFor(meshPaths.size(), 1, [&](size_t begin, size_t end)
+	{
+		for (size_t m = begin; m < end; m++)
+			cookedOk[m] = cookMesh(meshPaths[m], cookedMeshes[m]);
+	}, "malhas");
 
-	// Inicializando as variáveis do móvel
-	int texWidth, texHeight;
-	int indiceMovel = 0;
-	float lastTime = 0.0;
-	float FPS = 90.0;
-	float angle = 0.0;
-	glm::vec3 position;
-	glm::vec3 dimensions;
+	auto loadMesh = [&](const string& path, int& nVertices, BVH* bvh) -> int
+	{
+		size_t m = meshIndex[path];
+		if (!cookedOk[m])
+		{
+			cout << "Erro ao tentar ler o arquivo " << path << endl;
+			return -1;
+		}
+		return uploadMesh(path, cookedMeshes[m], nVertices, bvh);
+	};
+	// Esfera envolvente a partir da caixa da raiz da BVH
+	auto meshBounds = [&](const string& path, Object& object)
+	{
+		const BVH& bvh = cookedMeshes[meshIndex[path]].bvh;
+		if (bvh.empty()) return;
+		object.boundsCenter = (bvh.nodes[0].bmin + bvh.nodes[0].bmax) * 0.5f;
+		object.boundsRadius = glm::length(bvh.nodes[0].bmax - bvh.nodes[0].bmin) * 0.5f;
+	};
 
 	// Inicializando os objetos para serem renderizados
 	std::vector<Object> objects(NRO_OBJETOS);
 	//std::unordered_map<std::string, Material> materiais;
 
-	for (size_t i = 0; i < NRO_OBJETOS; ++i) {
+	for (int i = 0; i < NRO_OBJETOS; ++i) {
 		cout << configs[i].eMovel << endl;
 
 		if (configs[i].eMovel) {
 			cout << "movel " << configs[i].modelPath << endl;
-			movel.VAO = loadSimpleOBJ(configs[i].modelPath, movel.nVertices);
-			movel.texID = loadTexture(configs[i].texturePath, texWidth, texHeight);
-			dimensions = glm::vec3(configs[i].scale);
+			AgentGroup group;
+			group.VAO = loadMesh(configs[i].modelPath, group.nVertices, nullptr);
+			group.meshVBO = meshBuffer(group.VAO);
+			group.texture = acquireTexture(textures, configs[i].texturePath);
+			agentGroups.push_back(group);
+			agentConfigs.push_back((int)i);
 		}
 		else {
-			objects[i].VAO = loadSimpleOBJ(configs[i].modelPath, objects[i].nVertices);
-			objects[i].texID = loadTexture(configs[i].texturePath, texWidth, texHeight);
+			objects[i].VAO = loadMesh(configs[i].modelPath, objects[i].nVertices, &objects[i].bvh);
+			objects[i].VBO = meshBuffer(objects[i].VAO);
+			objects[i].texture = acquireTexture(textures, configs[i].texturePath);
+			meshBounds(configs[i].modelPath, objects[i]);
 			//std::unordered_map<std::string, Material> materiais = loadMTL(configs[i].mtlPath);
 
 			tx[i] = configs[i].translation.x;
@@ -223,6 +451,80 @@ int main()
 		}
 	}
 
+	// Cena de estresse: cada malha da mistura é carregada uma vez e replicada com transformações aleatórias
+	if (benchConfig.enabled)
+	{
+		std::vector<Object> benchMeshes(benchConfig.meshes.size());
+		for (size_t m = 0; m < benchConfig.meshes.size(); m++)
+		{
+			benchMeshes[m].VAO = loadMesh(benchConfig.meshes[m].modelPath, benchMeshes[m].nVertices, nullptr);
+			benchMeshes[m].VBO = meshBuffer(benchMeshes[m].VAO);
+			benchMeshes[m].texture = acquireTexture(textures, benchConfig.meshes[m].texturePath);
+			meshBounds(benchConfig.meshes[m].modelPath, benchMeshes[m]);
+		}
+
+		for (const StressInstance& inst : generateStressScene(benchConfig))
+		{
+			Object copy;
+			copy.VAO = benchMeshes[inst.mesh].VAO;
+			copy.VBO = benchMeshes[inst.mesh].VBO;
+			copy.texture = benchMeshes[inst.mesh].texture;
+			retainTexture(textures, copy.texture);
+			copy.nVertices = benchMeshes[inst.mesh].nVertices;
+			copy.boundsCenter = benchMeshes[inst.mesh].boundsCenter;
+			copy.boundsRadius = benchMeshes[inst.mesh].boundsRadius;
+			objects.push_back(copy);
+
+			tx.push_back(inst.translation.x);
+			ty.push_back(inst.translation.y);
+			tz.push_back(inst.translation.z);
+			rotateX.push_back(inst.rotation.x);
+			rotateY.push_back(inst.rotation.y);
+			rotateZ.push_back(inst.rotation.z);
+			fatoresEscala.push_back(inst.scale);
+			orientacao.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+			rotacaoAnimada.push_back(0);
+		}
+		cout << "Benchmark: " << benchConfig.copies << " instancias de " << benchMeshes.size() << " malhas" << endl;
+
+		// Multidão de agentes na curva, com a primeira malha da mistura
+		if (benchConfig.agents > 0)
+		{
+			AgentGroup group;
+			group.VAO = benchMeshes[0].VAO;
+			group.meshVBO = benchMeshes[0].VBO;
+			group.texture = benchMeshes[0].texture;
+			retainTexture(textures, group.texture);
+			group.nVertices = benchMeshes[0].nVertices;
+			agentGroups.push_back(group);
+			agentConfigs.push_back(-1);
+		}
+
+		// As cópias e o grupo já têm as suas referências
+		for (const Object& mesh : benchMeshes)
+			releaseTexture(textures, mesh.texture);
+	}
+
+	// Material padrão de todos os objetos; as trilhas de ka/kd/ks/q o sobrescrevem
+	for (Object& object : objects)
+	{
+		object.ka = 0.7f;
+		object.ks = 0.5f;
+		object.kd = 0.5f;
+		object.q = 10.0f;
+	}
+
+	// Clipes de animação: amostrados a cada quadro e aplicados antes das matrizes de modelo
+	AnimationSet animations;
+	loadAnimationConfig("./config.json", animations, NRO_OBJETOS);
+	if (animations.size() > 0)
+		cout << "Animacoes: " << animations.clips.size() << " clipes, " << animations.size() << " trilhas" << endl;
+	double lastAnimationTime = 0.0;
+
+	// Os vértices já estão na GPU
+	cookedMeshes.clear();
+	cookedMeshes.shrink_to_fit();
+
 
 
 	// CURVA ------------------------------
@@ -238,7 +540,7 @@ int main()
 
 	// Para os pontos de controle da Catmull Rom precisamos duplicar o primeiro e o último
 	curvaCatmullRom.controlPoints.push_back(curvaBezier.controlPoints[0]);
-	for (int i = 0; i < curvaBezier.controlPoints.size(); i++)
+	for (size_t i = 0; i < curvaBezier.controlPoints.size(); i++)
 	{
 		curvaCatmullRom.controlPoints.push_back(curvaBezier.controlPoints[i]);
 	}
@@ -253,11 +555,83 @@ int main()
 	// generateBezierCurvePoints(curvaBezier, numCurvePoints);
 	generateCatmullRomCurvePoints(curvaCatmullRom, 10);
 
+	// Tesselação adaptativa: em unidades do mundo substitui a fixa já aqui; em pixels é refeita
+	// no loop sempre que a câmera muda o tamanho das curvas na tela
+	AdaptiveTessellation curveSettings;
+	curveSettings.tolerance = Gconfigs[0].curveTolerance;
+	curveSettings.screenSpace = Gconfigs[0].curveScreenSpace;
+	curveSettings.retessellateScale = Gconfigs[0].curveRetessellate;
+	curveSettings.viewport = glm::vec2((float)WIDTH, (float)HEIGHT);
+	if (curveSettings.tolerance <= 0.0f) curveSettings.screenSpace = false;
+	else if (!curveSettings.screenSpace)
+	{
+		generateAdaptiveGlobalBezierCurvePoints(curvaBezier, curveSettings);
+		generateAdaptiveCurvePoints(curvaCatmullRom, 1, curveSettings);
+		cout << "Curvas adaptativas: " << curvaBezier.curvePoints.size() << " pontos (Bezier), " << curvaCatmullRom.curvePoints.size() << " (Catmull-Rom)" << endl;
+	}
+	buildArcLengthTable(curvaCatmullRom, 1, curvaCatmullRom.arcLength);
+	curveEditPointCount = (int)curvaCatmullRom.controlPoints.size() - 2;
+	// BVH dos segmentos da curva editável, para escolher o ponto de controle com o clique
+	CurveBVH curveBVH;
+	buildCurveBVH(curveBVH, curvaCatmullRom.arcLength);
+
 	// Cria os buffers de geometria dos pontos da curva
 	GLuint VAOControl = generateControlPointsBuffer(curvaBezier.controlPoints);
 	GLuint VAOBezierCurve = generateControlPointsBuffer(curvaBezier.curvePoints);
 	GLuint VAOCatmullRomCurve = generateControlPointsBuffer(curvaCatmullRom.curvePoints);
 
+	// Na GPU só vão os pontos de controle; os segmentos são tesselados no shader
+	CurvePatches patchesCatmullRom;
+	if (curvePatchesSupported())
+		createCurvePatches(patchesCatmullRom, curvaCatmullRom, 1);
+
+	// Linhas grossas: a poligonal da Catmull-Rom e os marcadores dos pontos de controle num só buffer
+	CurveLines curveLines;
+	int curveLine = -1, curveMarkers = -1;
+	if (Gconfigs[0].curveLineWidth > 0.0f)
+	{
+		int lineStyle = addCurveLineStyle(curveLines, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f), Gconfigs[0].curveLineWidth);
+		int markerStyle = Gconfigs[0].controlPointSize > 0.0f ? addCurveLineStyle(curveLines, glm::vec4(0.8f, 0.1f, 0.1f, 1.0f), Gconfigs[0].controlPointSize) : -1;
+		displayCurve(curveLines, curvaCatmullRom, lineStyle, markerStyle, curveLine, curveMarkers);
+		uploadCurveLines(curveLines);
+	}
+
+	// Agentes na Catmull-Rom: fases distribuídas ao longo da curva, velocidades e deslocamentos
+	// sorteados com semente fixa para que a cena seja a mesma a cada execução
+	std::mt19937 agentRng(benchConfig.seed);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	for (size_t g = 0; g < agentGroups.size(); g++)
+	{
+		AgentGroup& group = agentGroups[g];
+		int count = 1;
+		float speed = 2.7f, spread = 0.0f, scale = 1.0f;
+		if (agentConfigs[g] >= 0)
+		{
+			const ObjectConfig& config = configs[agentConfigs[g]];
+			count = max(config.agentCount, 1);
+			speed = config.speed;
+			spread = config.spread;
+			scale = config.scale;
+		}
+		else
+		{
+			count = benchConfig.agents;
+			spread = 1.0f;
+			scale = benchConfig.meshes[0].scale;
+		}
+
+		setAgentCurve(group, curvaCatmullRom, 1);
+		for (int a = 0; a < count; a++)
+		{
+			float phase = (float)a * group.path.length() / count;
+			float agentSpeed = count > 1 ? speed * (0.8f + 0.4f * unit(agentRng)) : speed;
+			glm::vec3 offset = spread * (2.0f * glm::vec3(unit(agentRng), unit(agentRng), unit(agentRng)) - 1.0f);
+			addAgent(group, agentSpeed, phase, offset, scale);
+		}
+		setupAgentInstancing(group);
+		cout << "Agentes: " << group.size() << " na curva (" << group.path.segments << " segmentos, comprimento " << group.path.length() << ")" << endl;
+	}
+
 	/*cout << curvaBezier.controlPoints.size() << endl;
 	cout << curvaBezier.curvePoints.size() << endl;
 	cout << curvaCatmullRom.curvePoints.size() << endl;*/
@@ -269,157 +643,412 @@ int main()
 
 
 
-	//glUseProgram(shader.ID);
-	shader.Use();
-	//glUseProgram(shaderCurva.ID);
-
 	//Matriz de modelo
 	glm::mat4 model = glm::mat4(1); //matriz identidade;
-	GLint modelLoc = glGetUniformLocation(shader.ID, "model");
 	model = glm::rotate(model, /*(GLfloat)glfwGetTime()*/glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
 
 	//Matriz de view
 	glm::mat4 view = glm::lookAt(Gconfigs[0].cameraPos,glm::vec3(0.0f,0.0f,0.0f), Gconfigs[0].cameraUp);
-	glUniformMatrix4fv(glGetUniformLocation(shader.ID, "view"), 1, GL_FALSE, glm::value_ptr(view));
 	//Matriz de projeção
 	//glm::mat4 projection = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, -1.0f, 1.0f);
 	glm::mat4 projection = glm::perspective(glm::radians(39.6f),(float)WIDTH/HEIGHT,0.1f,100.0f);
-	glUniformMatrix4fv(glGetUniformLocation(shader.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+	const float pixelsPerUnit = HEIGHT / (2.0f * tan(glm::radians(39.6f) * 0.5f)); // Na tela, a uma unidade da câmera
 
+	// Uniforms fixos e locations de todos os shaders: refeito quando o hot reload troca um programa,
+	// já que o programa novo começa com os valores padrão
+	GLint modelLoc, texLayerLoc, instancedTexLayerLoc;
+	auto setupShaders = [&](const glm::mat4& currentView)
+	{
+		//glUseProgram(shader.ID);
+		shader.Use();
+		//glUseProgram(shaderCurva.ID);
 
-	//Buffer de textura no shader
-	glUniform1i(glGetUniformLocation(shader.ID, "texBuffer"), 0);
+		modelLoc = glGetUniformLocation(shader.ID, "model");
+		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+		glUniformMatrix4fv(glGetUniformLocation(shader.ID, "view"), 1, GL_FALSE, glm::value_ptr(currentView));
+		glUniformMatrix4fv(glGetUniformLocation(shader.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+		shader.setVec3("cameraPos", Gconfigs[0].cameraPos.x, Gconfigs[0].cameraPos.y, Gconfigs[0].cameraPos.z);
 
+		//Buffer de textura no shader: 2D na unidade 0, arrays na 1 (texLayer diz qual amostrar)
+		glUniform1i(glGetUniformLocation(shader.ID, "texBuffer"), 0);
+		glUniform1i(glGetUniformLocation(shader.ID, "texArray"), 1);
+		texLayerLoc = glGetUniformLocation(shader.ID, "texLayer");
+
+		//Propriedades da superfície
+		shader.setFloat("ka",0.7);
+		shader.setFloat("ks", 0.5);
+		shader.setFloat("kd", 0.5);
+		shader.setFloat("q", 10.0);
+
+		//Propriedades da fonte de luz
+		shader.setVec3("lightPos",Gconfigs[0].lightPos[0], Gconfigs[0].lightPos[1], Gconfigs[0].lightPos[2]);
+		shader.setVec3("lightColor", Gconfigs[0].lightColor[0], Gconfigs[0].lightColor[1], Gconfigs[0].lightColor[2]);
+
+		// Mesmos parâmetros para o shader dos agentes (a matriz de modelo vem do buffer de instâncias)
+		shaderInstanced.Use();
+		glUniformMatrix4fv(glGetUniformLocation(shaderInstanced.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+		glUniformMatrix4fv(glGetUniformLocation(shaderInstanced.ID, "view"), 1, GL_FALSE, glm::value_ptr(currentView));
+		shaderInstanced.setVec3("cameraPos", Gconfigs[0].cameraPos.x, Gconfigs[0].cameraPos.y, Gconfigs[0].cameraPos.z);
+		glUniform1i(glGetUniformLocation(shaderInstanced.ID, "texBuffer"), 0);
+		glUniform1i(glGetUniformLocation(shaderInstanced.ID, "texArray"), 1);
+		instancedTexLayerLoc = glGetUniformLocation(shaderInstanced.ID, "texLayer");
+		shaderInstanced.setFloat("ka", 0.7);
+		shaderInstanced.setFloat("ks", 0.5);
+		shaderInstanced.setFloat("kd", 0.5);
+		shaderInstanced.setFloat("q", 10.0);
+		shaderInstanced.setVec3("lightPos", Gconfigs[0].lightPos[0], Gconfigs[0].lightPos[1], Gconfigs[0].lightPos[2]);
+		shaderInstanced.setVec3("lightColor", Gconfigs[0].lightColor[0], Gconfigs[0].lightColor[1], Gconfigs[0].lightColor[2]);
+
+		// Curvas: tesselação na GPU e, sem ela, a poligonal da CPU
+		shaderPatches.Use();
+		glUniformMatrix4fv(glGetUniformLocation(shaderPatches.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+		shaderPatches.setVec2("viewport", (float)WIDTH, (float)HEIGHT);
+		shaderPatches.setVec4("finalColorC", 0.0f, 0.0f, 0.0f, 1.0f);
+		shaderCurva.Use();
+		glUniformMatrix4fv(glGetUniformLocation(shaderCurva.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+		shaderCurva.setVec4("finalColorC", 0.0f, 0.0f, 0.0f, 1.0f);
+		shaderLines.Use();
+		glUniformMatrix4fv(glGetUniformLocation(shaderLines.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+		shaderLines.setVec2("viewport", (float)WIDTH, (float)HEIGHT);
+		shader.Use();
+	};
+	setupShaders(view);
 
 	glEnable(GL_DEPTH_TEST);
 	glActiveTexture(GL_TEXTURE0);
 
-	//Propriedades da superfície
-	shader.setFloat("ka",0.7);
-	shader.setFloat("ks", 0.5);
-	shader.setFloat("kd", 0.5);
-	shader.setFloat("q", 10.0);
+	// Objetos na ordem de desenho, agrupados por textura e malha
+	std::vector<size_t> drawOrder = sortByTexture(objects, textures);
+	int drawOrderVersion = textures.packVersion;
+	std::vector<float> objectPixels; // Diâmetro de cada objeto na tela, calculado junto com as matrizes
 
-	//Propriedades da fonte de luz
-	shader.setVec3("lightPos",Gconfigs[0].lightPos[0], Gconfigs[0].lightPos[1], Gconfigs[0].lightPos[2]);
-	shader.setVec3("lightColor", Gconfigs[0].lightColor[0], Gconfigs[0].lightColor[1], Gconfigs[0].lightColor[2]);
+	int frame = 0;
+
+	lastTime = glfwGetTime();
+	lastAnimationTime = lastTime;
 
 	// Loop da aplicação - "game loop"
 	while (!glfwWindowShouldClose(window))
 	{	
+		beginFrame();
+		gpuNextFrame();
+
 		// Checa se houveram eventos de input (key pressed, mouse moved etc.) e chama as funções de callback correspondentes
+		profileBegin(PROFILE_EVENTS);
 		glfwPollEvents();
+		profileEnd(PROFILE_EVENTS);
+
+		// Texturas: os níveis mapeados no quadro anterior vão para a GPU e os próximos são mapeados
+		profileBegin(PROFILE_RENDER);
+		updateTextureStreaming(textures); // Com os pedidos do quadro anterior
+		updateMeshReloads();
+		if (updateTextureUploads(textures) == 0)
+		{
+			packTextureArrays(textures);
+			if (!texturesReported)
+			{
+				reportTextureCache(textures);
+				reportGpuMemory();
+				texturesReported = true;
+			}
+		}
+		if (drawOrderVersion != textures.packVersion)
+		{
+			drawOrder = sortByTexture(objects, textures);
+			drawOrderVersion = textures.packVersion;
+		}
+		// O envio das texturas mexe nas ligações: o controle do que está ligado recomeça a cada quadro
+		GLuint boundTextures[2] = { 0, 0 };
+		profileEnd(PROFILE_RENDER);
+
+		// Câmera roteirizada do benchmark
+		if (benchConfig.enabled)
+			benchmarkCamera(benchConfig, frame - benchConfig.warmupFrames, Gconfigs[0].cameraPos, Gconfigs[0].cameraFront);
 
 		// Limpa o buffer de cor
 		glClearColor(255.0f, 255.0f, 255.0f, 1.0f); //cor de fundo
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		//shaderCurva.Use();
-
-		glLineWidth(10);
-		glPointSize(20);
-
-		float angle = (GLfloat)glfwGetTime();
-
-
 		shader.Use();
 
-		for (size_t i = 0; i < objects.size(); i++) {
-
-			//Propriedades da superfície
-			shader.setFloat("ka", 0.7);
-			shader.setFloat("ks", 0.5);
-			shader.setFloat("kd", 0.5);
-			shader.setFloat("q", 10.0);
-
-			glm::mat4 model = glm::mat4(1); // Resetando a matriz para cada objeto
+		// Matrizes de modelo calculadas em paralelo; as chamadas de desenho continuam na thread principal
+		profileBegin(PROFILE_SIMULATION);
+		if (animations.size() > 0)
+		{
+			// As animações só dependem do tempo: avançam com o quadro, sem o passo fixo dos agentes
+			double animationNow = glfwGetTime();
+			advanceAnimations(animations, (float)(animationNow - lastAnimationTime));
+			lastAnimationTime = animationNow;
+			sampleAnimations(animations);
+			applyAnimations(animations, objects);
+		}
+		// Matriz de modelo e tamanho na tela de cada objeto (0 = atrás da câmera, não desenha)
+		objectPixels.resize(objects.size());
+		parallelFor(objects.size(), 256, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				objects[i].model = objectModel(i);
+				objectPixels[i] = objects[i].VAO ? screenDiameter(objects[i], Gconfigs[0].cameraPos, Gconfigs[0].cameraFront, pixelsPerUnit) : 0.0f;
+			}
+		}, "transformacoes e culling");
+		profileEnd(PROFILE_SIMULATION);
 
-			//// POSIÇÃO INICIAL
-			//if (i == 0) model = glm::translate(model, glm::vec3(-3.0f, 0.0f, 0.0f));
-			//if (i == 1) model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
-			//if (i == 2) model = glm::translate(model, glm::vec3(3.0f, 0.0f, 0.0f));
+		profileBegin(PROFILE_RENDER);
+		int boundLayer = INT_MIN;
+		for (size_t i : drawOrder) {
 
-			// TRANSLAÇÃO
-			model = glm::translate(model, glm::vec3(tx[i], ty[i], tz[i]));
+			// Atrás da câmera: não desenha (a malha fica candidata a ser esvaziada)
+			float pixels = objectPixels[i];
+			if (pixels == 0.0f) continue;
+			requestTextureResolution(textures, objects[i].texture, pixels);
+			gpuTouch(GPU_MESH, objects[i].VBO);
 
-			// ESCALA
-			model = glm::scale(model, glm::vec3(fatoresEscala[i]));
+			// Malha esvaziada: não desenha até os vértices voltarem
+			if (gpuIsEvicted(GPU_MESH, objects[i].VBO))
+			{
+				reloadMesh(objects[i].VBO);
+				continue;
+			}
 
-			// ROTAÇÃO
-			if (rotateX[i]) model = glm::rotate(model, rotateX[i], glm::vec3(1.0f, 0.0f, 0.0f));
-			if (rotateY[i]) model = glm::rotate(model, rotateY[i], glm::vec3(0.0f, 1.0f, 0.0f));
-			if (rotateZ[i]) model = glm::rotate(model, rotateZ[i], glm::vec3(0.0f, 0.0f, 1.0f));
+			//Propriedades da superfície
+			shader.setFloat("ka", objects[i].ka);
+			shader.setFloat("ks", objects[i].ks);
+			shader.setFloat("kd", objects[i].kd);
+			shader.setFloat("q", objects[i].q);
 
 			// Enviar matriz para o shader
-			glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+			glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(objects[i].model));
+
+			// Mesmo array: só troca a camada
+			bindTexture(objects[i].binding, boundTextures);
+			if (objects[i].binding.layer != boundLayer)
+			{
+				boundLayer = objects[i].binding.layer;
+				glUniform1i(texLayerLoc, boundLayer);
+			}
 
 			glBindVertexArray(objects[i].VAO);
-			glBindTexture(GL_TEXTURE_2D, objects[i].texID);
 			glDrawArrays(GL_TRIANGLES, 0, objects[i].nVertices);
+			countDraw(objects[i].nVertices);
 
 		}
+		profileEnd(PROFILE_RENDER);
 
 		// Desenhar Móvel -----------------------------------------------------------
-		position = curvaCatmullRom.curvePoints[indiceMovel];
-		// Atualiza posição e rotação do objeto móvel
-		float now = glfwGetTime();
-		float dt = now - lastTime;
-
-		// Atualiza o índice do ponto da curva com base no tempo e FPS
-		if (dt >= 1.0f / FPS) {
-			indiceMovel = (indiceMovel + 1) % curvaCatmullRom.curvePoints.size();
-			lastTime = now;
-		}
+		profileBegin(PROFILE_SIMULATION);
+		// Acumula o tempo real do quadro e consome em passos fixos de simulação
+		double now = glfwGetTime();
+		accumulator += min(now - lastTime, MAX_SIM_STEPS * SIM_DT);
+		lastTime = now;
 
-		// Obtém a nova posição do objeto móvel
-		position = curvaCatmullRom.curvePoints[indiceMovel];
-
-		// Calcula o próximo ponto e a direção para ajustar o ângulo
-		glm::vec3 nextPos = curvaCatmullRom.curvePoints[(indiceMovel + 1) % curvaCatmullRom.curvePoints.size()];
-		glm::vec3 dir = glm::normalize(nextPos - position);
-		angle = atan2(dir.y, dir.x) + glm::radians(-90.0f);
-
-		// Configura a matriz de transformações para o móvel
-		movel.model = glm::mat4(1); // Matriz identidade
-		movel.model = glm::translate(movel.model, position); // Translação para a posição atual
-		movel.model = glm::rotate(movel.model, angle, glm::vec3(0.0f, 1.0f, 0.0f)); // Rotação com base no ângulo
-		movel.model = glm::scale(movel.model, dimensions); // Escala para ajustar o tamanho
+		while (accumulator >= SIM_DT)
+		{
+			// Avança todos os agentes um passo fixo
+			for (AgentGroup& group : agentGroups)
+				updateAgents(group, (float)SIM_DT);
+			accumulator -= SIM_DT;
+		}
 
-		// Envia a matriz ao shader
-		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(movel.model));
+		// Avalia os agentes entre os dois últimos passos, conforme a fração de passo que sobrou,
+		// escrevendo as matrizes direto no buffer de instâncias
+		for (AgentGroup& group : agentGroups)
+			uploadAgentMatrices(group, (float)(accumulator - SIM_DT));
+		profileEnd(PROFILE_SIMULATION);
 
-		// Renderiza o móvel
-		glBindVertexArray(movel.VAO);
-		glBindTexture(GL_TEXTURE_2D, movel.texID);
-		glDrawArrays(GL_TRIANGLES, 0, movel.nVertices);
+		// Renderiza os agentes: uma chamada de desenho instanciada por grupo
+		shaderInstanced.Use();
+		for (const AgentGroup& group : agentGroups)
+		{
+			// Agentes espalhados pela curva: alguém sempre está perto, vale a resolução toda
+			requestTextureResolution(textures, group.texture, FLT_MAX);
+			TextureBinding binding = textureBinding(textures, group.texture);
+			bindTexture(binding, boundTextures);
+			glUniform1i(instancedTexLayerLoc, binding.layer);
+			gpuTouch(GPU_MESH, group.meshVBO);
+			drawAgents(group);
+		}
 
+		// Acima do orçamento: esvazia as malhas que não foram desenhadas nos últimos MESH_EVICT_FRAMES quadros
+		evictMeshes();
 
-		//cout << position[0] << " " << position[0] << " " << position[0];
+		//cout << movelState.position[0] << " " << movelState.position[1] << " " << movelState.position[2];
 
 		//Atualizar a matriz de view
 		//Matriz de view
 		glm::mat4 view = glm::lookAt(Gconfigs[0].cameraPos, Gconfigs[0].cameraPos + Gconfigs[0].cameraFront, Gconfigs[0].cameraUp);
+		glUniformMatrix4fv(glGetUniformLocation(shaderInstanced.ID, "view"), 1, GL_FALSE, glm::value_ptr(view));
+		shaderInstanced.setVec3("cameraPos", Gconfigs[0].cameraPos.x, Gconfigs[0].cameraPos.y, Gconfigs[0].cameraPos.z);
+		shader.Use();
 		glUniformMatrix4fv(glGetUniformLocation(shader.ID, "view"), 1, GL_FALSE, glm::value_ptr(view));
 
+		// Ponto da Catmull-Rom movido: só os 4 segmentos vizinhos são re-tesselados e reenviados,
+		// e a tabela de comprimento de arco é refeita só neles (os agentes recebem a cópia)
+		if (curveEditDelta != glm::vec3(0.0f))
+		{
+			int last = (int)curvaCatmullRom.controlPoints.size() - 1;
+			glm::vec3 point = curvaCatmullRom.controlPoints[curveEditPoint] + curveEditDelta;
+			int moved[] = { curveEditPoint, curveEditPoint == 1 ? 0 : -1, curveEditPoint == last - 1 ? last : -1 };
+			for (int index : moved)
+			{
+				if (index < 0) continue;
+				moveControlPoint(curvaCatmullRom, 1, index, point);
+				if (patchesCatmullRom.segments > 0) setCurveControlPoint(patchesCatmullRom, curvaCatmullRom, index, point);
+				updateCurveMarker(curveLines, curveMarkers, index, point);
+			}
+			curveEditDelta = glm::vec3(0.0f);
+
+			int first, lastSegment;
+			if (takeDirtySegments(curvaCatmullRom, first, lastSegment))
+			{
+				CurvePointsUpdate update = retessellateCurveSegments(curvaCatmullRom, 1, curveSettings, first, lastSegment);
+				updateCurvePointsRange(VAOCatmullRomCurve, curvaCatmullRom.curvePoints, update);
+				updateCurveLine(curveLines, curveLine, curvaCatmullRom.curvePoints, update);
+				updateArcLengthTable(curvaCatmullRom, 1, curvaCatmullRom.arcLength, first, lastSegment);
+				refitCurveBVH(curveBVH, curvaCatmullRom.arcLength);
+				for (AgentGroup& group : agentGroups)
+					group.path = curvaCatmullRom.arcLength;
+			}
+		}
+
+		// Curvas com tolerância em pixels: só re-tessela quando o tamanho delas na tela muda o bastante
+		curveSettings.viewProjection = projection * view;
+		if (needsRetessellation(curvaBezier, curveSettings))
+		{
+			generateAdaptiveGlobalBezierCurvePoints(curvaBezier, curveSettings);
+			updateCurvePointsBuffer(VAOBezierCurve, curvaBezier.curvePoints);
+		}
+		if (needsRetessellation(curvaCatmullRom, curveSettings))
+		{
+			generateAdaptiveCurvePoints(curvaCatmullRom, 1, curveSettings);
+			updateCurvePointsBuffer(VAOCatmullRomCurve, curvaCatmullRom.curvePoints);
+			CurvePointsUpdate update;
+			update.count = curvaCatmullRom.curvePoints.size();
+			update.resized = true;
+			updateCurveLine(curveLines, curveLine, curvaCatmullRom.curvePoints, update);
+		}
+
+		// Curva seguida pelos agentes: linhas grossas e marcadores em duas chamadas instanciadas,
+		// ou linha fina com um patch por segmento
+		if (Gconfigs[0].drawCurve)
+		{
+			profileBegin(PROFILE_RENDER);
+			if (curveLine >= 0)
+			{
+				uploadCurveLines(curveLines);
+				shaderLines.Use();
+				glUniformMatrix4fv(glGetUniformLocation(shaderLines.ID, "view"), 1, GL_FALSE, glm::value_ptr(view));
+				drawCurveLines(curveLines, shaderLines);
+			}
+			else if (patchesCatmullRom.segments > 0)
+			{
+				shaderPatches.Use();
+				glUniformMatrix4fv(glGetUniformLocation(shaderPatches.ID, "view"), 1, GL_FALSE, glm::value_ptr(view));
+				drawCurvePatches(patchesCatmullRom, shaderPatches, Gconfigs[0].curvePixelsPerLine);
+			}
+			else
+			{
+				shaderCurva.Use();
+				glUniformMatrix4fv(glGetUniformLocation(shaderCurva.ID, "view"), 1, GL_FALSE, glm::value_ptr(view));
+				glBindVertexArray(VAOCatmullRomCurve);
+				glDrawArrays(GL_LINE_STRIP, 0, (GLsizei)curvaCatmullRom.curvePoints.size());
+				glBindVertexArray(0);
+				countDraw((int)curvaCatmullRom.curvePoints.size());
+			}
+			shader.Use();
+			profileEnd(PROFILE_RENDER);
+		}
+
 		//Propriedades da câmera
 		shader.setVec3("cameraPos", Gconfigs[0].cameraPos.x, Gconfigs[0].cameraPos.y, Gconfigs[0].cameraPos.z);
 
+		// Shaders salvos: recompila sem esperar e troca o programa quando o link termina bem
+		for (const string& path : pollFileChanges(shaderWatcher))
+			for (Shader* s : shaders)
+				if (s->usesFile(path)) s->reload();
+		bool shadersReloaded = false;
+		for (Shader* s : shaders)
+			shadersReloaded |= s->updateReload();
+		if (shadersReloaded) setupShaders(view);
+
+		// Seleção do objeto clicado (raio contra a BVH de cada objeto); editando a curva, do ponto de
+		// controle do trecho sob o cursor
+		if (pickRequested)
+		{
+			int winWidth, winHeight;
+			glfwGetWindowSize(window, &winWidth, &winHeight);
+			int point = curveEditMode ? pickCurvePoint(curveBVH, curvaCatmullRom.arcLength, view, projection, pixelsPerUnit * winHeight / HEIGHT,
+				pickX, pickY, winWidth, winHeight) : -1;
+			if (point >= 0)
+			{
+				curveEditPoint = min(max(point, 1), curveEditPointCount);
+				cout << "Editando a curva, ponto " << curveEditPoint << endl;
+			}
+			else
+			{
+				int picked = pickObject(objects, view, projection, pickX, pickY, winWidth, winHeight);
+				if (picked >= 0) indice = picked;
+			}
+			pickRequested = false;
+		}
 		
 		// Troca os buffers da tela
+		profileBegin(PROFILE_SWAP);
 		glfwSwapBuffers(window);
+		profileEnd(PROFILE_SWAP);
+
+		endFrame(benchConfig.enabled && frame >= benchConfig.warmupFrames);
+		frame++;
+		if (benchConfig.enabled && frame >= benchConfig.warmupFrames + benchConfig.frames)
+			glfwSetWindowShouldClose(window, GL_TRUE);
 	}
-	// Pede pra OpenGL desalocar os buffers
-	for (size_t i = 0; i < objects.size(); i++)
+
+	if (benchConfig.enabled)
+	{
+		writeBenchmarkReport(benchConfig, (const char*)renderer);
+		reportGpuMemory();
+		reportJobStats();
+	}
+
+	// Pede pra OpenGL desalocar os buffers (as cópias do benchmark e o grupo de agentes dele compartilham a malha)
+	finishMeshReloads();
+	std::unordered_set<GLuint> meshVAOs;
+	for (const Object& object : objects)
+		if (object.VAO) meshVAOs.insert(object.VAO);
+	for (const AgentGroup& group : agentGroups)
+		if (group.VAO) meshVAOs.insert(group.VAO);
+	for (GLuint VAO : meshVAOs)
+		deleteMesh(VAO);
+	deleteCurvePatches(patchesCatmullRom);
+	deleteCurveLines(curveLines);
+	deleteCurvePointsBuffer(VAOControl);
+	deleteCurvePointsBuffer(VAOBezierCurve);
+	deleteCurvePointsBuffer(VAOCatmullRomCurve);
+
+	for (Shader* s : shaders) s->cancelReload();
+	closeFileWatcher(shaderWatcher);
+
+	for (AgentGroup& group : agentGroups)
+	{
+		gpuUntrack(GPU_INSTANCES, group.instanceVBO);
+		glDeleteBuffers(1, &group.instanceVBO);
+	}
+
+	// Cada objeto solta a sua referência; a textura é apagada com a última
+	for (const Object& object : objects)
+		releaseTexture(textures, object.texture);
+	for (const AgentGroup& group : agentGroups)
+		releaseTexture(textures, group.texture);
+	deleteTextureCache(textures);
+
+	// Tudo que foi criado já devia ter sido apagado
+	if (!gpuMemory.allocations.empty())
 	{
-		glDeleteVertexArrays(1, &objects[i].VAO);
+		cout << "Objetos de GPU nao liberados:" << endl;
+		reportGpuMemory();
 	}
-	/*glDeleteVertexArrays(1, &VAOControl);
-	glDeleteVertexArrays(1, &VAOBezierCurve);
-	glDeleteVertexArrays(1, &VAOCatmullRomCurve);*/
 
-	glDeleteVertexArrays(1, &movel.VAO);
+	shutdownJobSystem();
 
 	// Finaliza a execução da GLFW, limpando os recursos alocados por ela
 	glfwTerminate();
@@ -438,6 +1067,33 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, GL_TRUE);
 
+	// Edição da curva: espaço troca o ponto de controle e WASDQE o movem
+	if (key == GLFW_KEY_C && action == GLFW_PRESS && curveEditPointCount > 0)
+	{
+		curveEditMode = !curveEditMode;
+		if (curveEditMode) cout << "Editando a curva, ponto " << curveEditPoint << endl;
+		else cout << "Edicao da curva encerrada" << endl;
+		return;
+	}
+	if (curveEditMode && action != GLFW_RELEASE)
+	{
+		float curveStep = 0.25f;
+		if (key == GLFW_KEY_SPACE && action == GLFW_PRESS)
+		{
+			curveEditPoint = curveEditPoint % curveEditPointCount + 1;
+			cout << "Editando a curva, ponto " << curveEditPoint << endl;
+		}
+		if (key == GLFW_KEY_W) curveEditDelta.y += curveStep;
+		if (key == GLFW_KEY_S) curveEditDelta.y -= curveStep;
+		if (key == GLFW_KEY_A) curveEditDelta.x -= curveStep;
+		if (key == GLFW_KEY_D) curveEditDelta.x += curveStep;
+		if (key == GLFW_KEY_Q) curveEditDelta.z -= curveStep;
+		if (key == GLFW_KEY_E) curveEditDelta.z += curveStep;
+		if (key == GLFW_KEY_SPACE || key == GLFW_KEY_W || key == GLFW_KEY_S || key == GLFW_KEY_A ||
+			key == GLFW_KEY_D || key == GLFW_KEY_Q || key == GLFW_KEY_E)
+			return;
+	}
+
 	// Rotação
 	if (key == GLFW_KEY_X && action == GLFW_REPEAT)
 	{
@@ -517,6 +1173,15 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 }
 
 
+// Callback de mouse - o clique com o botão esquerdo seleciona o objeto sob o cursor
+void mouse_button_callback(GLFWwindow* window, int button, int action, int /*mods*/)
+{
+	if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
+	{
+		glfwGetCursorPos(window, &pickX, &pickY);
+		pickRequested = true;
+	}
+}
 
 std::vector<GeneralConfig> loadGeneralConfig(const std::string& configFile) {
 	std::vector<GeneralConfig> configs;
@@ -560,6 +1225,76 @@ std::vector<GeneralConfig> loadGeneralConfig(const std::string& configFile) {
 		else
 			config.lightPos = glm::vec3(0.0f); // Valor padrão
 
+		if (item.contains("curveTolerance"))
+			config.curveTolerance = item["curveTolerance"];
+		else
+			config.curveTolerance = 0.0f; // Valor padrão: nro fixo de pontos
+
+		if (item.contains("curveScreenSpace"))
+			config.curveScreenSpace = item["curveScreenSpace"];
+		else
+			config.curveScreenSpace = false; // Valor padrão
+
+		if (item.contains("curveRetessellate"))
+			config.curveRetessellate = item["curveRetessellate"];
+		else
+			config.curveRetessellate = 0.1f; // Valor padrão: 10% de variação no tamanho na tela
+
+		if (item.contains("drawCurve"))
+			config.drawCurve = item["drawCurve"];
+		else
+			config.drawCurve = false; // Valor padrão
+
+		if (item.contains("curvePixelsPerLine"))
+			config.curvePixelsPerLine = item["curvePixelsPerLine"];
+		else
+			config.curvePixelsPerLine = 8.0f; // Valor padrão
+
+		if (item.contains("curveLineWidth"))
+			config.curveLineWidth = item["curveLineWidth"];
+		else
+			config.curveLineWidth = 3.0f; // Valor padrão
+
+		if (item.contains("controlPointSize"))
+			config.controlPointSize = item["controlPointSize"];
+		else
+			config.controlPointSize = 0.0f; // Valor padrão
+
+		if (item.contains("textureCompression"))
+			config.textureCompression = item["textureCompression"];
+		else
+			config.textureCompression = "none"; // Valor padrão
+
+		if (item.contains("textureQuality"))
+			config.textureQuality = item["textureQuality"];
+		else
+			config.textureQuality = "normal"; // Valor padrão
+
+		if (item.contains("mipFilter"))
+			config.mipFilter = item["mipFilter"];
+		else
+			config.mipFilter = "box"; // Valor padrão
+
+		if (item.contains("mipSrgb"))
+			config.mipSrgb = item["mipSrgb"];
+		else
+			config.mipSrgb = true; // Valor padrão
+
+		if (item.contains("alphaCutoff"))
+			config.alphaCutoff = item["alphaCutoff"];
+		else
+			config.alphaCutoff = 0.0f; // Valor padrão
+
+		if (item.contains("textureBudgetMB"))
+			config.textureBudgetMB = item["textureBudgetMB"];
+		else
+			config.textureBudgetMB = 0.0f; // Valor padrão
+
+		if (item.contains("gpuBudgetMB"))
+			config.gpuBudgetMB = item["gpuBudgetMB"];
+		else
+			config.gpuBudgetMB = 0.0f; // Valor padrão
+
 		configs.push_back(config);
 	}
 
@@ -612,6 +1347,21 @@ std::vector<ObjectConfig> loadObjectConfig(const std::string& configFile) {
 		else
 			config.eMovel = false; // Valor padrão
 
+		if (item.contains("agentCount"))
+			config.agentCount = item["agentCount"];
+		else
+			config.agentCount = 1; // Valor padrão
+
+		if (item.contains("speed"))
+			config.speed = item["speed"];
+		else
+			config.speed = 2.7f; // Valor padrão: uma volta na lemniscata (~29.7 unidades) em 11 s
+
+		if (item.contains("spread"))
+			config.spread = item["spread"];
+		else
+			config.spread = 0.0f; // Valor padrão
+
 		configs.push_back(config);
 	}
 
@@ -702,23 +1452,39 @@ int setupGeometry()
 	return VAO;
 }
 
-int loadSimpleOBJ(string filePath, int& nVertices)
+int loadSimpleOBJ(string filePath, int& nVertices, BVH* bvh)
+{
+	CookedMesh mesh;
+	if (!cookMesh(filePath, mesh))
+	{
+		cout << "Erro ao tentar ler o arquivo " << filePath << endl;
+		return -1;
+	}
+	return uploadMesh(filePath, mesh, nVertices, bvh);
+}
+
+// Lê e faz o parsing do .obj (ou recupera a malha cozida), construindo a BVH; não usa a OpenGL
+bool cookMesh(const string& filePath, CookedMesh& mesh)
 {
 	vector <glm::vec3> vertices;
 	vector <glm::vec2> texCoords;
 	vector <glm::vec3> normals;
-	vector <GLfloat> vBuffer;
+	vector <glm::vec3> triangles; // Posições de cada face, para a BVH
+	vector <GLfloat>& vBuffer = mesh.vBuffer;
 
 	glm::vec3 color = glm::vec3(1.0, 0.0, 0.0);
 
-	ifstream arqEntrada;
-
-	arqEntrada.open(filePath.c_str());
-	if (arqEntrada.is_open())
+	vector<char> fileData;
+	if (readFileBytes(filePath, fileData))
 	{
+		// Se a malha já foi cozida com este mesmo conteúdo, pula o parsing e a construção da BVH
+		uint64_t sourceHash = hashBytes(fileData.data(), fileData.size());
+		bool fromCache = loadCookedMesh(filePath, sourceHash, mesh);
+		istringstream arqEntrada(fromCache ? string() : string(fileData.begin(), fileData.end()));
+
 		//Fazer o parsing
 		string line;
-		while (!arqEntrada.eof())
+		while (!fromCache && !arqEntrada.eof())
 		{
 			getline(arqEntrada, line);
 			istringstream ssline(line);
@@ -772,6 +1538,7 @@ int loadSimpleOBJ(string filePath, int& nVertices)
 					vBuffer.push_back(vertices[vi].x);
 					vBuffer.push_back(vertices[vi].y);
 					vBuffer.push_back(vertices[vi].z);
+					triangles.push_back(vertices[vi]);
 
 					//Atributo cor
 					vBuffer.push_back(color.r);
@@ -796,113 +1563,314 @@ int loadSimpleOBJ(string filePath, int& nVertices)
 
 		}
 
-		arqEntrada.close();
+		if (!fromCache)
+		{
+			// BVH construída no momento do cozimento e salva junto com a malha
+			buildBVH(mesh.bvh, triangles);
+			saveCookedMesh(filePath, sourceHash, mesh);
+		}
+		mesh.fromCache = fromCache;
+		return true;
+	}
+	return false;
+}
 
-		cout << "Gerando o buffer de geometria..." << endl;
-		GLuint VBO, VAO;
+// Cria o VAO/VBO da malha cozida (thread do contexto OpenGL)
+int uploadMesh(const string& filePath, const CookedMesh& mesh, int& nVertices, BVH* bvh)
+{
+	const vector <GLfloat>& vBuffer = mesh.vBuffer;
+	reportBVH(filePath, mesh.bvh, mesh.fromCache);
 
-		//Geração do identificador do VBO
-		glGenBuffers(1, &VBO);
+	cout << "Gerando o buffer de geometria..." << endl;
+	GLuint VBO, VAO;
 
-		//Faz a conexão (vincula) do buffer como um buffer de array
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	//Geração do identificador do VBO
+	glGenBuffers(1, &VBO);
 
-		//Envia os dados do array de floats para o buffer da OpenGl
-		glBufferData(GL_ARRAY_BUFFER, vBuffer.size() * sizeof(GLfloat), vBuffer.data(), GL_STATIC_DRAW);
+	//Faz a conexão (vincula) do buffer como um buffer de array
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
 
-		//Geração do identificador do VAO (Vertex Array Object)
-		glGenVertexArrays(1, &VAO);
+	//Envia os dados do array de floats para o buffer da OpenGl
+	glBufferData(GL_ARRAY_BUFFER, vBuffer.size() * sizeof(GLfloat), vBuffer.data(), GL_STATIC_DRAW);
+	gpuTrack(GPU_MESH, VBO, filePath, vBuffer.size() * sizeof(GLfloat));
 
-		// Vincula (bind) o VAO primeiro, e em seguida  conecta e seta o(s) buffer(s) de vértices
-		// e os ponteiros para os atributos 
-		glBindVertexArray(VAO);
+	//Geração do identificador do VAO (Vertex Array Object)
+	glGenVertexArrays(1, &VAO);
 
-		//Para cada atributo do vertice, criamos um "AttribPointer" (ponteiro para o atributo), indicando: 
-		// Localização no shader * (a localização dos atributos devem ser correspondentes no layout especificado no vertex shader)
-		// Numero de valores que o atributo tem (por ex, 3 coordenadas xyz) 
-		// Tipo do dado
-		// Se está normalizado (entre zero e um)
-		// Tamanho em bytes 
-		// Deslocamento a partir do byte zero 
+	// Vincula (bind) o VAO primeiro, e em seguida  conecta e seta o(s) buffer(s) de vértices
+	// e os ponteiros para os atributos 
+	glBindVertexArray(VAO);
 
-		//Atributo posição (x, y, z)
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)0);
-		glEnableVertexAttribArray(0);
+	//Para cada atributo do vertice, criamos um "AttribPointer" (ponteiro para o atributo), indicando: 
+	// Localização no shader * (a localização dos atributos devem ser correspondentes no layout especificado no vertex shader)
+	// Numero de valores que o atributo tem (por ex, 3 coordenadas xyz) 
+	// Tipo do dado
+	// Se está normalizado (entre zero e um)
+	// Tamanho em bytes 
+	// Deslocamento a partir do byte zero 
 
-		//Atributo cor (r, g, b)
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-		glEnableVertexAttribArray(1);
+	//Atributo posição (x, y, z)
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)0);
+	glEnableVertexAttribArray(0);
 
-		//Atributo coordenada de textura - s, t
-		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(6 * sizeof(GLfloat)));
-		glEnableVertexAttribArray(2);
+	//Atributo cor (r, g, b)
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
+	glEnableVertexAttribArray(1);
 
-		//Atributo vetor normal - x, y, z
-		glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(8 * sizeof(GLfloat)));
-		glEnableVertexAttribArray(3);
+	//Atributo coordenada de textura - s, t
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(6 * sizeof(GLfloat)));
+	glEnableVertexAttribArray(2);
 
-		// Observe que isso é permitido, a chamada para glVertexAttribPointer registrou o VBO como o objeto de buffer de vértice 
-		// atualmente vinculado - para que depois possamos desvincular com segurança
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	//Atributo vetor normal - x, y, z
+	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(8 * sizeof(GLfloat)));
+	glEnableVertexAttribArray(3);
 
-		// Desvincula o VAO (é uma boa prática desvincular qualquer buffer ou array para evitar bugs medonhos)
-		glBindVertexArray(0);
+	// Observe que isso é permitido, a chamada para glVertexAttribPointer registrou o VBO como o objeto de buffer de vértice 
+	// atualmente vinculado - para que depois possamos desvincular com segurança
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-		nVertices = vBuffer.size() / 11;
-		return VAO;
+	// Desvincula o VAO (é uma boa prática desvincular qualquer buffer ou array para evitar bugs medonhos)
+	glBindVertexArray(0);
 
-	}
-	else
+	nVertices = vBuffer.size() / 11;
+	if (bvh) *bvh = mesh.bvh;
+	return VAO;
+}
+
+// Formato do arquivo cozido: "MSH1", hash da origem, vBuffer, BVH
+const uint32_t COOKED_MESH_MAGIC = 0x3148534D;
+
+bool loadCookedMesh(const string& sourcePath, uint64_t sourceHash, CookedMesh& mesh)
+{
+	vector<char> data;
+	if (!readFileBytes(cachePath(sourcePath, "mesh"), data)) return false;
+
+	const char* ptr = data.data();
+	const char* end = ptr + data.size();
+	uint32_t magic;
+	uint64_t hash, floatCount;
+	if (data.size() < sizeof(magic) + sizeof(hash) + sizeof(floatCount)) return false;
+	memcpy(&magic, ptr, sizeof(magic)); ptr += sizeof(magic);
+	memcpy(&hash, ptr, sizeof(hash)); ptr += sizeof(hash);
+	memcpy(&floatCount, ptr, sizeof(floatCount)); ptr += sizeof(floatCount);
+	if (magic != COOKED_MESH_MAGIC || hash != sourceHash) return false; // Origem mudou: recozinhar
+	if ((uint64_t)(end - ptr) < floatCount * sizeof(GLfloat)) return false;
+
+	mesh.vBuffer.resize((size_t)floatCount);
+	memcpy(mesh.vBuffer.data(), ptr, (size_t)floatCount * sizeof(GLfloat));
+	ptr += floatCount * sizeof(GLfloat);
+
+	auto start = chrono::high_resolution_clock::now();
+	if (!readBVH(ptr, end, mesh.bvh))
 	{
-		cout << "Erro ao tentar ler o arquivo " << filePath << endl;
-		return -1;
+		mesh.vBuffer.clear();
+		return false;
 	}
+	mesh.bvh.buildMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+	return true;
+}
+
+// Só o buffer de vértices da malha cozida, sem a BVH (para recarregar um VBO esvaziado). Não confere o
+// hash da origem: o arquivo foi gravado ou validado por cookMesh quando a malha foi carregada
+bool loadCookedVertices(const string& sourcePath, vector<GLfloat>& vBuffer)
+{
+	vector<char> data;
+	if (!readFileBytes(cachePath(sourcePath, "mesh"), data)) return false;
+
+	const char* ptr = data.data();
+	uint32_t magic;
+	uint64_t hash, floatCount;
+	if (data.size() < sizeof(magic) + sizeof(hash) + sizeof(floatCount)) return false;
+	memcpy(&magic, ptr, sizeof(magic)); ptr += sizeof(magic);
+	memcpy(&hash, ptr, sizeof(hash)); ptr += sizeof(hash);
+	memcpy(&floatCount, ptr, sizeof(floatCount)); ptr += sizeof(floatCount);
+	if (magic != COOKED_MESH_MAGIC || floatCount % 11 != 0) return false;
+	if ((uint64_t)(data.data() + data.size() - ptr) < floatCount * sizeof(GLfloat)) return false;
+
+	vBuffer.resize((size_t)floatCount);
+	memcpy(vBuffer.data(), ptr, (size_t)floatCount * sizeof(GLfloat));
+	return true;
+}
+
+void saveCookedMesh(const string& sourcePath, uint64_t sourceHash, const CookedMesh& mesh)
+{
+	vector<char> data;
+	uint64_t floatCount = mesh.vBuffer.size();
+	data.insert(data.end(), (const char*)&COOKED_MESH_MAGIC, (const char*)&COOKED_MESH_MAGIC + sizeof(COOKED_MESH_MAGIC));
+	data.insert(data.end(), (const char*)&sourceHash, (const char*)&sourceHash + sizeof(sourceHash));
+	data.insert(data.end(), (const char*)&floatCount, (const char*)&floatCount + sizeof(floatCount));
+	data.insert(data.end(), (const char*)mesh.vBuffer.data(), (const char*)(mesh.vBuffer.data() + mesh.vBuffer.size()));
+	writeBVH(data, mesh.bvh);
+
+	if (!writeFileBytes(cachePath(sourcePath, "mesh"), data))
+		cout << "Aviso: nao foi possivel salvar a malha cozida de " << sourcePath << endl;
 }
 
-GLuint loadTexture(string filePath, int& width, int& height)
+// Matriz de modelo do objeto i a partir dos vetores de transformação
+glm::mat4 objectModel(size_t i)
 {
-	GLuint texID; // id da textura a ser carregada
+	glm::mat4 model = glm::mat4(1); // Resetando a matriz para cada objeto
 
-	// Gera o identificador da textura na memória
-	glGenTextures(1, &texID);
-	glBindTexture(GL_TEXTURE_2D, texID);
+	//// POSIÇÃO INICIAL
+	//if (i == 0) model = glm::translate(model, glm::vec3(-3.0f, 0.0f, 0.0f));
+	//if (i == 1) model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
+	//if (i == 2) model = glm::translate(model, glm::vec3(3.0f, 0.0f, 0.0f));
 
-	// Ajuste dos parâmetros de wrapping e filtering
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// TRANSLAÇÃO
+	model = glm::translate(model, glm::vec3(tx[i], ty[i], tz[i]));
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	// ESCALA
+	model = glm::scale(model, glm::vec3(fatoresEscala[i]));
 
-	// Carregamento da imagem usando a função stbi_load da biblioteca stb_image
-	int nrChannels;
+	// ROTAÇÃO
+	if (rotacaoAnimada[i]) return model * glm::mat4_cast(orientacao[i]);
+	if (rotateX[i]) model = glm::rotate(model, rotateX[i], glm::vec3(1.0f, 0.0f, 0.0f));
+	if (rotateY[i]) model = glm::rotate(model, rotateY[i], glm::vec3(0.0f, 1.0f, 0.0f));
+	if (rotateZ[i]) model = glm::rotate(model, rotateZ[i], glm::vec3(0.0f, 0.0f, 1.0f));
 
-	unsigned char *data = stbi_load(filePath.c_str(), &width, &height, &nrChannels, 0);
+	return model;
+}
 
-	if (data)
+// Copia os valores amostrados para as variáveis de transformação e o material de cada objeto
+void applyAnimations(const AnimationSet& animations, std::vector<Object>& objects)
+{
+	for (size_t i = 0; i < animations.size(); i++)
 	{
-		if (nrChannels == 3) // jpg, bmp
+		if (!animations.clips[animations.clip[i]].playing) continue;
+
+		int target = animations.target[i];
+		switch (animations.channel[i])
 		{
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		}
-		else // assume que é 4 canais png
+		case ANIM_TRANSLATION:
 		{
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+			glm::vec3 t = animationVec3(animations, i);
+			tx[target] = t.x;
+			ty[target] = t.y;
+			tz[target] = t.z;
+			break;
+		}
+		case ANIM_ROTATION:
+			orientacao[target] = animationQuat(animations, i);
+			rotacaoAnimada[target] = 1;
+			break;
+		case ANIM_SCALE: fatoresEscala[target] = animationFloat(animations, i); break;
+		case ANIM_KA: objects[target].ka = animationFloat(animations, i); break;
+		case ANIM_KD: objects[target].kd = animationFloat(animations, i); break;
+		case ANIM_KS: objects[target].ks = animationFloat(animations, i); break;
+		case ANIM_SHININESS: objects[target].q = animationFloat(animations, i); break;
 		}
-		glGenerateMipmap(GL_TEXTURE_2D);
 	}
-	else
+}
+
+// Atualiza a textura de cada objeto e devolve os índices ordenados por textura e malha, para que objetos
+// com texturas no mesmo array sejam desenhados em sequência sem religar nada
+std::vector<size_t> sortByTexture(std::vector<Object>& objects, const TextureCache& textures)
+{
+	std::vector<size_t> order(objects.size());
+	for (size_t i = 0; i < objects.size(); i++)
 	{
-		std::cout << "Failed to load texture " << filePath << std::endl;
+		objects[i].binding = textureBinding(textures, objects[i].texture);
+		order[i] = i;
 	}
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+	{
+		const Object& oa = objects[a];
+		const Object& ob = objects[b];
+		if (oa.binding.target != ob.binding.target) return oa.binding.target < ob.binding.target;
+		if (oa.binding.id != ob.binding.id) return oa.binding.id < ob.binding.id;
+		return oa.VAO < ob.VAO;
+	});
+	return order;
+}
+
+// Diâmetro aproximado do objeto na tela, em pixels (0 se está todo atrás da câmera)
+float screenDiameter(const Object& object, const glm::vec3& cameraPos, const glm::vec3& cameraFront, float pixelsPerUnit)
+{
+	if (object.boundsRadius <= 0.0f) return FLT_MAX; // Sem esfera: como se estivesse perto
+	const glm::mat4& m = object.model;
+	float scale = max(glm::length(glm::vec3(m[0])), max(glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2]))));
+	glm::vec3 center = glm::vec3(m * glm::vec4(object.boundsCenter, 1.0f));
+	float radius = object.boundsRadius * scale;
+	float depth = glm::dot(center - cameraPos, glm::normalize(cameraFront));
+	if (depth < -radius) return 0.0f;
+	if (depth <= radius) return FLT_MAX; // Câmera dentro ou muito perto da esfera
+	return 2.0f * radius * pixelsPerUnit / depth;
+}
 
-	stbi_image_free(data);
+// Liga a textura na unidade do seu tipo (2D na 0, array na 1) se ainda não estiver ligada
+void bindTexture(const TextureBinding& binding, GLuint bound[2])
+{
+	int unit = binding.target == GL_TEXTURE_2D_ARRAY ? 1 : 0;
+	if (bound[unit] == binding.id) return;
+	glActiveTexture(GL_TEXTURE0 + unit);
+	glBindTexture(binding.target, binding.id);
+	glActiveTexture(GL_TEXTURE0);
+	bound[unit] = binding.id;
+	countTextureBind();
+}
+
+// Raio do plano near ao far pelo pixel (x, y) da janela, em coordenadas do mundo
+void pickRay(const glm::mat4& view, const glm::mat4& projection, double x, double y, int width, int height, glm::vec3& origin, glm::vec3& dir)
+{
+	glm::vec2 ndc(2.0f * (float)x / width - 1.0f, 1.0f - 2.0f * (float)y / height);
+	glm::mat4 invViewProj = glm::inverse(projection * view);
+	glm::vec4 nearPoint = invViewProj * glm::vec4(ndc, -1.0f, 1.0f);
+	glm::vec4 farPoint = invViewProj * glm::vec4(ndc, 1.0f, 1.0f);
+	origin = glm::vec3(nearPoint) / nearPoint.w;
+	dir = glm::vec3(farPoint) / farPoint.w - origin;
+}
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+// Lança um raio pelo pixel (x, y) e devolve o índice do objeto mais próximo atingido (ou -1)
+int pickObject(const std::vector<Object>& objects, const glm::mat4& view, const glm::mat4& projection, double x, double y, int width, int height)
+{
+	glm::vec3 origin, dir;
+	pickRay(view, projection, x, y, width, height, origin, dir);
+
+	int picked = -1;
+	RayHit hit;
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		if (objects[i].bvh.empty()) continue;
+
+		// O raio vai para o espaço do objeto; sem normalizar a direção, o t continua comparável entre objetos
+		glm::mat4 invModel = glm::inverse(objects[i].model);
+		Ray ray;
+		ray.origin = glm::vec3(invModel * glm::vec4(origin, 1.0f));
+		ray.dir = glm::vec3(invModel * glm::vec4(dir, 0.0f));
+		if (intersectBVH4(objects[i].bvh, ray, hit))
+			picked = (int)i;
+	}
+	return picked;
+}
 
-	std::cout << width;
+// Ponto de controle (índice em controlPoints) do trecho da curva a menos de CURVE_PICK_PIXELS do raio, ou -1.
+// O ponto do raio mais perto da curva sai alternando entre o ponto da curva mais perto do ponto do
+// raio (consulta na BVH) e a projeção dele de volta no raio
+int pickCurvePoint(const CurveBVH& bvh, const ArcLengthTable& table, const glm::mat4& view, const glm::mat4& projection, float pixelsPerUnit,
+	double x, double y, int width, int height)
+{
+	const float CURVE_PICK_PIXELS = 12.0f;
+	if (bvh.empty()) return -1;
+	glm::vec3 origin, dir;
+	pickRay(view, projection, x, y, width, height, origin, dir);
+	dir = glm::normalize(dir);
+
+	glm::vec3 center = 0.5f * (bvh.nodes[0].bmin + bvh.nodes[0].bmax);
+	float s = max(0.0f, glm::dot(center - origin, dir));
+	CurveHit hit;
+	for (int iteration = 0; iteration < 8; iteration++)
+	{
+		if (!closestPointOnCurve(bvh, table, origin + dir * s, hit)) return -1;
+		float next = max(0.0f, glm::dot(hit.point - origin, dir));
+		bool converged = fabs(next - s) < 1e-4f * (1.0f + s);
+		s = next;
+		if (converged) break;
+	}
+	closestPointOnCurve(bvh, table, origin + dir * s, hit);
+	if (hit.segment < 0 || hit.distance * pixelsPerUnit > CURVE_PICK_PIXELS * max(s, 1e-3f)) return -1;
 
-	return texID;
+	// O segmento i da Catmull-Rom vai do ponto i + 1 ao i + 2
+	return hit.t < 0.5f ? hit.segment + 1 : hit.segment + 2;
 }
 
 //std::unordered_map<std::string, Material> loadMTL(const std::string& filePath) {
@@ -959,104 +1927,7 @@ GLuint loadTexture(string filePath, int& width, int& height)
 //}
 
 
-void initializeBernsteinMatrix(glm::mat4& matrix)
-{
-	// matrix[0] = glm::vec4(1.0f, -3.0f, 3.0f, -1.0f);
-	// matrix[1] = glm::vec4(0.0f, 3.0f, -6.0f, 3.0f);
-	// matrix[2] = glm::vec4(0.0f, 0.0f, 3.0f, -3.0f);
-	// matrix[3] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
-
-	matrix[0] = glm::vec4(-1.0f, 3.0f, -3.0f, 1.0f); // Primeira coluna
-	matrix[1] = glm::vec4(3.0f, -6.0f, 3.0f, 0.0f);  // Segunda coluna
-	matrix[2] = glm::vec4(-3.0f, 3.0f, 0.0f, 0.0f);  // Terceira coluna
-	matrix[3] = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);   // Quarta coluna
-}
-
-void initializeCatmullRomMatrix(glm::mat4& matrix)
-{
-	// matrix[0] = glm::vec4(-1.0f, 3.0f, -3.0f, 1.0f);
-	// matrix[1] = glm::vec4(2.0f, -5.0f, 4.0f, -1.0f);
-	// matrix[2] = glm::vec4(-1.0f, 0.0f, 1.0f, 0.0f);
-	// matrix[3] = glm::vec4(0.0f, 2.0f, 0.0f, 0.0f);
-
-	matrix[0] = glm::vec4(-0.5f, 1.5f, -1.5f, 0.5f); // Primeira linha
-	matrix[1] = glm::vec4(1.0f, -2.5f, 2.0f, -0.5f); // Segunda linha
-	matrix[2] = glm::vec4(-0.5f, 0.0f, 0.5f, 0.0f);  // Terceira linha
-	matrix[3] = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);   // Quarta linha
-}
-
-void generateBezierCurvePoints(Curve& curve, int numPoints)
-{
-	curve.curvePoints.clear(); // Limpa quaisquer pontos antigos da curva
-
-	initializeBernsteinMatrix(curve.M);
-	// Calcular os pontos ao longo da curva com base em Bernstein
-	// Loop sobre os pontos de controle em grupos de 4
-
-	float piece = 1.0 / (float)numPoints;
-	float t;
-	for (int i = 0; i < curve.controlPoints.size() - 3; i += 3)
-	{
-
-		// Gera pontos para o segmento atual
-		for (int j = 0; j < numPoints; j++)
-		{
-			t = j * piece;
-
-			// Vetor t para o polinômio de Bernstein
-			glm::vec4 T(t * t * t, t * t, t, 1);
-
-			glm::vec3 P0 = curve.controlPoints[i];
-			glm::vec3 P1 = curve.controlPoints[i + 1];
-			glm::vec3 P2 = curve.controlPoints[i + 2];
-			glm::vec3 P3 = curve.controlPoints[i + 3];
-
-			glm::mat4x3 G(P0, P1, P2, P3);
-
-			// Calcula o ponto da curva multiplicando tVector, a matriz de Bernstein e os pontos de controle
-			glm::vec3 point = G * curve.M * T;
-
-			curve.curvePoints.push_back(point);
-		}
-	}
-}
-
-void generateCatmullRomCurvePoints(Curve& curve, int numPoints)
-{
-	curve.curvePoints.clear(); // Limpa quaisquer pontos antigos da curva
-
-	initializeCatmullRomMatrix(curve.M);
-	// Calcular os pontos ao longo da curva com base em Bernstein
-	// Loop sobre os pontos de controle em grupos de 4
-
-	float piece = 1.0 / (float)numPoints;
-	float t;
-	for (int i = 0; i < curve.controlPoints.size() - 3; i++)
-	{
-
-		// Gera pontos para o segmento atual
-		for (int j = 0; j < numPoints; j++)
-		{
-			t = j * piece;
-
-			// Vetor t para o polinômio de Bernstein
-			glm::vec4 T(t * t * t, t * t, t, 1);
-
-			glm::vec3 P0 = curve.controlPoints[i];
-			glm::vec3 P1 = curve.controlPoints[i + 1];
-			glm::vec3 P2 = curve.controlPoints[i + 2];
-			glm::vec3 P3 = curve.controlPoints[i + 3];
-
-			glm::mat4x3 G(P0, P1, P2, P3);
-
-			// Calcula o ponto da curva multiplicando tVector, a matriz de Bernstein e os pontos de controle
-			glm::vec3 point = G * curve.M * T;
-			curve.curvePoints.push_back(point);
-		}
-	}
-}
-
-GLuint generateControlPointsBuffer(vector<glm::vec3> controlPoints)
+GLuint generateControlPointsBuffer(const vector<glm::vec3>& controlPoints)
 {
 	GLuint VBO, VAO;
 
@@ -1068,6 +1939,7 @@ GLuint generateControlPointsBuffer(vector<glm::vec3> controlPoints)
 
 	// Envia os dados do array de floats para o buffer da OpenGl
 	glBufferData(GL_ARRAY_BUFFER, controlPoints.size() * sizeof(GLfloat) * 3, controlPoints.data(), GL_STATIC_DRAW);
+	gpuTrack(GPU_CURVE, VBO, "pontos da curva", controlPoints.size() * sizeof(GLfloat) * 3);
 
 	// Geração do identificador do VAO (Vertex Array Object)
 	glGenVertexArrays(1, &VAO);
@@ -1090,85 +1962,146 @@ GLuint generateControlPointsBuffer(vector<glm::vec3> controlPoints)
 	return VAO;
 }
 
-std::vector<glm::vec3> generateHeartControlPoints(int numPoints)
+// Reenvia os pontos de uma curva re-tesselada para o VBO ligado ao atributo 0 do VAO
+void updateCurvePointsBuffer(GLuint VAO, const vector<glm::vec3>& points)
 {
-	std::vector<glm::vec3> controlPoints;
+	GLint VBO = 0;
+	glBindVertexArray(VAO);
+	glGetVertexAttribiv(0, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &VBO);
+	glBindVertexArray(0);
+	if (VBO == 0) return;
+
+	glBindBuffer(GL_ARRAY_BUFFER, (GLuint)VBO);
+	glBufferData(GL_ARRAY_BUFFER, points.size() * sizeof(GLfloat) * 3, points.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	gpuTrack(GPU_CURVE, (GLuint)VBO, "pontos da curva", points.size() * sizeof(GLfloat) * 3);
+}
 
-	// Define o intervalo para t: de 0 a 2 * PI, dividido em numPoints
-	float step = 2 * 3.14159 / (numPoints - 1);
+// Reenvia só o trecho re-tesselado de uma curva editada. Se o trecho mudou de tamanho, os pontos
+// seguintes também são reenviados; o buffer só é realocado se a curva não couber mais nele
+void updateCurvePointsRange(GLuint VAO, const vector<glm::vec3>& points, const CurvePointsUpdate& update)
+{
+	if (update.count == 0) return;
+	GLint VBO = 0, capacity = 0;
+	glBindVertexArray(VAO);
+	glGetVertexAttribiv(0, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &VBO);
+	glBindVertexArray(0);
+	if (VBO == 0) return;
 
-	for (int i = 0; i < numPoints - 1; i++)
+	glBindBuffer(GL_ARRAY_BUFFER, (GLuint)VBO);
+	glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &capacity);
+	if (points.size() * sizeof(glm::vec3) > (size_t)capacity)
 	{
-		float t = i * step;
-
-		// Calcula x(t) e y(t) usando as fórmulas paramétricas
-		float x = 16 * pow(sin(t), 3);
-		float z = 13 * cos(t) - 5 * cos(2 * t) - 2 * cos(3 * t) - cos(4 * t);
-
-		// Normaliza os pontos para mantê-los dentro de [-1, 1] no espaço 3D
-		x /= 8.0f; // Dividir por 16 para normalizar x entre -1 e 1
-		z /= 8.0f; // Dividir por 16 para normalizar y aproximadamente entre -1 e 1
-		z += 0.15;
-		// Adiciona o ponto ao vetor de pontos de controle
-		//controlPoints.push_back(glm::vec3(x, y, 0.0f));
-		controlPoints.push_back(glm::vec3(x, z, 0.0f));
+		glBufferData(GL_ARRAY_BUFFER, points.size() * sizeof(glm::vec3), points.data(), GL_STATIC_DRAW);
+		gpuTrack(GPU_CURVE, (GLuint)VBO, "pontos da curva", points.size() * sizeof(glm::vec3));
 	}
-	controlPoints.push_back(controlPoints[0]);
-
-	return controlPoints;
+	else
+		glBufferSubData(GL_ARRAY_BUFFER, update.first * sizeof(glm::vec3), update.count * sizeof(glm::vec3), &points[update.first]);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
-void generateGlobalBezierCurvePoints(Curve& curve, int numPoints)
+// O VAO é o único identificador guardado: o VBO é recuperado do atributo 0 antes de apagar os dois
+void deleteCurvePointsBuffer(GLuint VAO)
 {
-	curve.curvePoints.clear(); // Limpa quaisquer pontos antigos da curva
+	GLint VBO = 0;
+	glBindVertexArray(VAO);
+	glGetVertexAttribiv(0, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &VBO);
+	glBindVertexArray(0);
+	GLuint buffer = (GLuint)VBO;
+	gpuUntrack(GPU_CURVE, buffer);
+	if (buffer != 0) glDeleteBuffers(1, &buffer);
+	glDeleteVertexArrays(1, &VAO);
+}
 
-	int n = curve.controlPoints.size() - 1; // Grau da curva
-	float t;
-	float piece = 1.0f / (float)numPoints;
+// VBO ligado ao atributo 0 (posição) do VAO de uma malha
+GLuint meshBuffer(GLuint VAO)
+{
+	GLint VBO = 0;
+	glBindVertexArray(VAO);
+	glGetVertexAttribiv(0, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &VBO);
+	glBindVertexArray(0);
+	return (GLuint)VBO;
+}
 
-	for (int j = 0; j <= numPoints; ++j)
+// Acima do orçamento de GPU, esvazia os VBOs das malhas desenhadas há mais tempo (só as que não foram
+// desenhadas nos últimos MESH_EVICT_FRAMES quadros); o VAO continua apontando para o buffer, que é
+// preenchido de novo por reloadMesh
+void evictMeshes()
+{
+	while (gpuHeadroom() < 0)
 	{
-		t = j * piece;
-		glm::vec3 point(0.0f); // Ponto na curva
+		GLuint VBO = gpuLeastRecentlyUsed(GPU_MESH, MESH_EVICT_FRAMES);
+		if (VBO == 0) return;
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		gpuEvicted(GPU_MESH, VBO);
+	}
+}
 
-		// Calcula o ponto da curva usando a fórmula de Bernstein
-		for (int i = 0; i <= n; ++i)
+// Pede a recarga de um VBO esvaziado: num worker, lê os vértices da malha cozida em ./cache (ou
+// cozinha de novo o .obj, se o cache sumiu); o envio para a GPU fica para updateMeshReloads
+void reloadMesh(GLuint VBO)
+{
+	if (meshReloads.count(VBO)) return; // Já pedida (ou falhou)
+	const GpuAllocation* allocation = gpuAllocation(GPU_MESH, VBO);
+	if (!allocation) return;
+
+	shared_ptr<MeshReload> reload = make_shared<MeshReload>();
+	reload->path = allocation->asset;
+	meshReloads[VBO] = reload;
+	runJob([reload]()
+	{
+		reload->ok = loadCookedVertices(reload->path, reload->vBuffer);
+		if (!reload->ok)
 		{
-			// Coeficiente binomial
-			float binomialCoeff = (float)(tgamma(n + 1) / (tgamma(i + 1) * tgamma(n - i + 1)));
-			// Polinômio de Bernstein
-			float bernsteinPoly = binomialCoeff * pow(1 - t, n - i) * pow(t, i);
-			// Soma ponderada dos pontos de controle
-			point += bernsteinPoly * curve.controlPoints[i];
+			CookedMesh mesh;
+			reload->ok = cookMesh(reload->path, mesh);
+			reload->vBuffer.swap(mesh.vBuffer);
 		}
-
-		curve.curvePoints.push_back(point);
-	}
+	}, &reload->done, "malha: recarga");
 }
 
-std::vector<glm::vec3> generateInfinityControlPoints(int numPoints) {
-	std::vector<glm::vec3> controlPoints;
-
-	// Define o intervalo para t: de 0 a 2 * PI, dividido em numPoints
-	float step = 2 * 3.14159f / numPoints;
-
-	// Constante que define o "tamanho" do símbolo
-	float a = 4.0f; // Ajuste para aumentar ou diminuir o símbolo
-
-	for (int i = 0; i < numPoints; ++i) {
-		float t = i * step;
-
-		// Fórmulas paramétricas para a lemniscata de Bernoulli
-		float x = (a * sqrt(2) * cos(t)) / (sin(t) * sin(t) + 1);
-		float y = (a * sqrt(2) * cos(t) * sin(t)) / (sin(t) * sin(t) + 1);
-
-		// Adiciona o ponto no plano XY
-		controlPoints.push_back(glm::vec3(x, y, 0.0f));
+// Envia para a GPU as recargas que terminaram (uma vez por quadro, na thread da OpenGL)
+void updateMeshReloads()
+{
+	for (auto it = meshReloads.begin(); it != meshReloads.end();)
+	{
+		MeshReload& reload = *it->second;
+		if (reload.failed || reload.done.pending.load(memory_order_acquire) > 0)
+		{
+			++it;
+			continue;
+		}
+		if (!reload.ok)
+		{
+			cout << "Erro ao recarregar a malha " << reload.path << endl;
+			reload.failed = true;
+			++it;
+			continue;
+		}
+		GLuint VBO = it->first;
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferData(GL_ARRAY_BUFFER, reload.vBuffer.size() * sizeof(GLfloat), reload.vBuffer.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		gpuTrack(GPU_MESH, VBO, reload.path, reload.vBuffer.size() * sizeof(GLfloat));
+		it = meshReloads.erase(it);
 	}
+}
 
-	// Fecha o loop conectando o último ponto ao primeiro
-	controlPoints.push_back(controlPoints[0]);
-
-	return controlPoints;
+// Espera as recargas em andamento (antes de apagar as malhas)
+void finishMeshReloads()
+{
+	for (auto& item : meshReloads)
+		waitForCounter(item.second->done);
+	meshReloads.clear();
 }
 
+// Apaga o VAO da malha e o VBO dele
+void deleteMesh(GLuint VAO)
+{
+	GLuint VBO = meshBuffer(VAO);
+	gpuUntrack(GPU_MESH, VBO);
+	if (VBO != 0) glDeleteBuffers(1, &VBO);
+	glDeleteVertexArrays(1, &VAO);
+}
@@ -0,0 +1,1003 @@
+#include "Texture.h"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <map>
+#include <tuple>
+#include <algorithm>
+#include <cmath>
+
+//STB_IMAGE
+#include <stb_image.h>
+
+#include "Cache.h"
+#include "GLExtensions.h"
+#include "GpuMemory.h"
+
+#ifndef _WIN32
+#include <climits>
+#endif
+
+using namespace std;
+
+// Carregamento em andamento: preenchido pela thread de trabalho, lido pela do GL depois que
+// decoded zera
+struct TextureLoad
+{
+	vector<char> file;              // Bytes do arquivo (liberados depois de decodificar)
+	CookedTexture image;            // Cadeia de mipmaps contígua, decodificada agora ou mapeada do cache
+	bool failed = false;
+	double decodeMs = 0.0;
+
+	string path;                    // Para o arquivo cozido
+	uint64_t contentHash = 0;
+	MipSettings mips;
+	uint64_t cookKey = 0;           // Hash da imagem combinado com as opções dos mipmaps
+	TextureFormat requested = TEXTURE_UNCOMPRESSED;
+	CompressionQuality quality = COMPRESS_NORMAL;
+	bool fromCooked = false;
+	bool stream = false;            // Pode ser carregada por demanda: depois de gravada, fica mapeada do cache
+	double cookMs = 0.0;
+	JobCounter decoded;
+
+	bool ready = false;             // A thread do GL já leu o resultado
+	int nextLevel = -1;             // Próximo nível a mapear (do último até o 0)
+	int hits = 0;                   // Pedidos reaproveitados antes de saber o tamanho
+};
+
+namespace
+{
+	// Cópias menores que isso (ou sem threads de trabalho) são feitas direto na thread do GL
+	const size_t COPY_JOB_BYTES = 64u << 10;
+
+	double nowMs()
+	{
+		return chrono::duration<double, milli>(chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	inline int levelSize(int size, int level) { return max(size >> level, 1); }
+
+	// VRAM de um nível (RGB8 costuma ser guardado com 4 bytes por texel)
+	size_t levelVram(const CookedTexture& image, int level)
+	{
+		size_t bytes = image.offsets[level + 1] - image.offsets[level];
+		return image.format == TEXTURE_UNCOMPRESSED ? bytes / image.channels * 4 : bytes;
+	}
+
+	// Primeiro nível que cabe em TEXTURE_STREAM_BASE_SIZE: o mínimo de uma textura com streaming
+	int streamBaseLevel(const TextureEntry& entry)
+	{
+		int level = 0;
+		while (level < entry.levels - 1 && max(levelSize(entry.width, level), levelSize(entry.height, level)) > TEXTURE_STREAM_BASE_SIZE)
+			level++;
+		return level;
+	}
+
+	// Na thread de trabalho: mapeia a textura cozida, se ela ainda vale; senão decodifica (RGB fica
+	// com 3 canais, o resto vira RGBA; para comprimir, sempre RGBA), monta os mipmaps, comprime se
+	// pedido e grava o resultado no cache para as próximas execuções
+	void decodeTexture(TextureLoad& load)
+	{
+		auto start = nowMs();
+		CookedTexture& image = load.image;
+		if (loadCookedTexture(load.path, load.cookKey, load.requested, load.quality, image))
+		{
+			vector<char>().swap(load.file);
+			load.fromCooked = true;
+			load.decodeMs = nowMs() - start;
+			return;
+		}
+
+		bool compress = load.requested != TEXTURE_UNCOMPRESSED;
+		int width, height, channels;
+		const stbi_uc* bytes = (const stbi_uc*)load.file.data();
+		int size = (int)load.file.size();
+		unsigned char* data = nullptr;
+		if (stbi_info_from_memory(bytes, size, &width, &height, &channels))
+		{
+			channels = channels == 3 ? 3 : 4;
+			data = stbi_load_from_memory(bytes, size, &width, &height, nullptr, compress ? 4 : channels);
+		}
+		vector<char>().swap(load.file);
+
+		if (!data)
+		{
+			load.failed = true;
+			return;
+		}
+
+		int stored = compress ? 4 : channels;
+		size_t base = (size_t)width * height * stored;
+		image.format = TEXTURE_UNCOMPRESSED;
+		image.width = width;
+		image.height = height;
+		image.channels = stored;
+		image.data.reserve(base + base / 3 + 64);
+		image.data.assign(data, data + base);
+		stbi_image_free(data);
+		buildMipChain(image.data, image.offsets, width, height, stored, load.mips);
+
+		if (compress)
+		{
+			double cookStart = nowMs();
+			CookedTexture cooked;
+			cookTexture(image.data.data(), image.offsets, width, height, channels, load.requested, load.quality, cooked);
+			image = move(cooked);
+			load.cookMs = nowMs() - cookStart;
+		}
+		saveCookedTexture(load.path, load.cookKey, load.requested, load.quality, image);
+
+		// Com streaming os níveis ficam disponíveis enquanto a textura existir: melhor do arquivo
+		// mapeado (páginas que o sistema pode descartar) do que da memória do processo
+		CookedTexture mapped;
+		if (load.stream && max(width, height) > TEXTURE_STREAM_MIN_SIZE &&
+			loadCookedTexture(load.path, load.cookKey, load.requested, load.quality, mapped))
+			image = move(mapped);
+		load.decodeMs = nowMs() - start;
+	}
+
+	TextureHandle newEntry(TextureCache& cache)
+	{
+		if (!cache.freeHandles.empty())
+		{
+			TextureHandle handle = cache.freeHandles.back();
+			cache.freeHandles.pop_back();
+			return handle;
+		}
+		cache.entries.push_back(TextureEntry());
+		return (TextureHandle)cache.entries.size() - 1;
+	}
+
+	// Um hit não decodifica nem envia nada: conta o que teria custado (se a imagem ainda está
+	// sendo decodificada, quando o tamanho for conhecido)
+	TextureHandle hit(TextureCache& cache, TextureHandle handle)
+	{
+		TextureEntry& entry = cache.entries[handle];
+		entry.refs++;
+		if (entry.load && !entry.load->ready)
+			entry.load->hits++;
+		else
+		{
+			cache.stats.decodeBytesSaved += entry.decodedBytes;
+			cache.stats.vramBytesSaved += entry.vramBytes;
+		}
+		return handle;
+	}
+
+	// Cinza 1x1 até o primeiro nível chegar; os filtros já são os da cadeia completa
+	GLuint createPlaceholder()
+	{
+		const unsigned char gray[4] = { 128, 128, 128, 255 };
+		GLuint texID;
+		glGenTextures(1, &texID);
+		glBindTexture(GL_TEXTURE_2D, texID);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, gray);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return texID;
+	}
+
+	// Menor buffer livre que comporta size bytes, ou um novo (potência de 2, no mínimo 64 KB)
+	int acquirePBO(TextureCache& cache, size_t size)
+	{
+		int best = -1;
+		for (size_t i = 0; i < cache.pbos.size(); i++)
+		{
+			const TexturePBO& pbo = cache.pbos[i];
+			if (!pbo.busy && pbo.capacity >= size && (best < 0 || pbo.capacity < cache.pbos[best].capacity))
+				best = (int)i;
+		}
+		if (best >= 0) return best;
+
+		TexturePBO pbo;
+		pbo.capacity = 64u << 10;
+		while (pbo.capacity < size) pbo.capacity *= 2;
+		glGenBuffers(1, &pbo.buffer);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo.buffer);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, pbo.capacity, nullptr, GL_STREAM_DRAW);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		gpuTrack(GPU_STAGING, pbo.buffer, "pixel unpack buffer", pbo.capacity);
+		cache.pbos.push_back(pbo);
+		return (int)cache.pbos.size() - 1;
+	}
+
+	// Buffers cuja cerca já passou voltam para o conjunto livre
+	void recyclePBOs(TextureCache& cache)
+	{
+		for (TexturePBO& pbo : cache.pbos)
+		{
+			if (!pbo.busy || !pbo.fence) continue;
+			GLenum status = glClientWaitSync(pbo.fence, 0, 0);
+			if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+			{
+				glDeleteSync(pbo.fence);
+				pbo.fence = 0;
+				pbo.busy = false;
+			}
+		}
+	}
+
+	// Mapeia o buffer e dispara a cópia do nível; a cópia segura o carregamento vivo
+	void stageLevel(TextureCache& cache, TextureHandle handle, int level)
+	{
+		shared_ptr<TextureLoad> load = cache.entries[handle].load;
+		size_t size = load->image.offsets[level + 1] - load->image.offsets[level];
+		int p = acquirePBO(cache, size);
+		TexturePBO& pbo = cache.pbos[p];
+
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo.buffer);
+		void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		pbo.busy = true;
+
+		const unsigned char* src = load->image.pixels() + load->image.offsets[level]; // Do arquivo mapeado, as páginas são lidas na cópia
+		if (!dst)
+			pbo.busy = false;
+		else if (size >= COPY_JOB_BYTES && jobWorkerCount() > 1)
+			runJob([load, dst, src, size]() { memcpy(dst, src, size); }, &cache.copies, "textura: copia");
+		else
+			memcpy(dst, src, size);
+
+		TextureStagedLevel staged;
+		staged.handle = handle;
+		staged.level = level;
+		staged.pbo = dst ? p : -1;
+		cache.staged.push_back(staged);
+	}
+
+	GLenum storageFormat(TextureFormat format, int channels)
+	{
+		return format != TEXTURE_UNCOMPRESSED ? compressedInternalFormat(format) : channels == 3 ? GL_RGB8 : GL_RGBA8;
+	}
+
+	// Níveis comprimidos vão inteiros, com o tamanho em bytes; os outros com o formato dos pixels.
+	// Com glTexStorage2D a cadeia toda é alocada (imutável) quando chega o primeiro nível, e cada
+	// nível só preenche a sua parte
+	void texImage(const TextureEntry& entry, int level, size_t size, const void* pixels)
+	{
+		int w = levelSize(entry.width, level), h = levelSize(entry.height, level);
+		bool compressed = entry.format != TEXTURE_UNCOMPRESSED;
+		GLenum format = entry.channels == 3 ? GL_RGB : GL_RGBA;
+		if (glTexStorage2D && !entry.streamed) // Com streaming os níveis finos são definidos e apagados depois
+		{
+			if (level == entry.levels - 1)
+				glTexStorage2D(GL_TEXTURE_2D, entry.levels, storageFormat(entry.format, entry.channels), entry.width, entry.height);
+			if (compressed)
+				glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, w, h, compressedInternalFormat(entry.format), (GLsizei)size, pixels);
+			else
+				glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, w, h, format, GL_UNSIGNED_BYTE, pixels);
+		}
+		else if (compressed)
+			glCompressedTexImage2D(GL_TEXTURE_2D, level, compressedInternalFormat(entry.format), w, h, 0, (GLsizei)size, pixels);
+		else
+			glTexImage2D(GL_TEXTURE_2D, level, format, w, h, 0, format, GL_UNSIGNED_BYTE, pixels);
+	}
+
+	// Desmapeia e manda o nível para a textura; o glTexImage2D lê do buffer de forma assíncrona
+	void finishLevel(TextureCache& cache, const TextureStagedLevel& staged)
+	{
+		TextureEntry& entry = cache.entries[staged.handle];
+		TextureLoad& load = *entry.load;
+		int level = staged.level;
+		size_t size = load.image.offsets[level + 1] - load.image.offsets[level];
+
+		glBindTexture(GL_TEXTURE_2D, entry.id);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // Linhas RGB dos níveis pequenos não são múltiplas de 4
+		if (staged.pbo >= 0)
+		{
+			TexturePBO& pbo = cache.pbos[staged.pbo];
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo.buffer);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			texImage(entry, level, size, nullptr);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			pbo.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+		else // O mapeamento falhou: envio síncrono
+			texImage(entry, level, size, load.image.pixels() + load.image.offsets[level]);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+		// Os níveis chegam do menor para o maior: a base desce a cada um e a textura fica completa
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, entry.levels - 1);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		cache.stats.uploads++;
+		cache.stats.uploadedBytes += size;
+
+		if (level == entry.baseLevel)
+		{
+			entry.state = TEXTURE_RESIDENT;
+			gpuTrack(GPU_TEXTURE, entry.id, entry.path, entry.vramBytes);
+			if (entry.streamed)
+				cache.streamedBytes += entry.vramBytes;
+			else
+			{
+				entry.load.reset();
+				cache.packPending = true;
+			}
+			if (--cache.loading == 0)
+				cache.stats.residentMs = nowMs() - cache.firstRequest;
+		}
+	}
+
+	// Resultado da decodificação, lido uma vez na thread do GL
+	void takeDecoded(TextureCache& cache, TextureHandle handle)
+	{
+		TextureEntry& entry = cache.entries[handle];
+		TextureLoad& load = *entry.load;
+		load.ready = true;
+		cache.stats.decodeMs += load.decodeMs;
+		cache.stats.cookMs += load.cookMs;
+
+		if (load.failed)
+		{
+			cout << "Failed to load texture " << entry.path << endl;
+			cache.stats.failures++;
+			entry.state = TEXTURE_FAILED;
+			entry.load.reset();
+			if (--cache.loading == 0)
+				cache.stats.residentMs = nowMs() - cache.firstRequest;
+			return;
+		}
+
+		const CookedTexture& image = load.image;
+		if (load.fromCooked) cache.stats.cookedLoads++;
+		else cache.stats.cooks++;
+		entry.width = image.width;
+		entry.height = image.height;
+		entry.channels = image.channels;
+		entry.levels = image.levels();
+		entry.format = image.format;
+		if (image.format == TEXTURE_UNCOMPRESSED)
+		{
+			entry.decodedBytes = image.offsets[1];
+			entry.vramBytes = image.size() / image.channels * 4; // RGB8 costuma ser guardado com 4 bytes por texel
+		}
+		else
+		{
+			entry.decodedBytes = (size_t)entry.width * entry.height * 4;
+			entry.vramBytes = image.size();
+		}
+		load.nextLevel = entry.levels - 1;
+		if (load.stream && max(entry.width, entry.height) > TEXTURE_STREAM_MIN_SIZE)
+		{
+			// Começa pelos níveis pequenos; o resto vem com os pedidos
+			entry.streamed = true;
+			entry.baseLevel = entry.wantedLevel = streamBaseLevel(entry);
+			entry.vramBytes = 0;
+			for (int level = entry.baseLevel; level < entry.levels; level++)
+				entry.vramBytes += levelVram(image, level);
+			cache.stats.streamed++;
+		}
+		cache.stats.decodeBytesSaved += (size_t)load.hits * entry.decodedBytes;
+		cache.stats.vramBytesSaved += (size_t)load.hits * entry.vramBytes;
+	}
+
+	// Array vazio com as dimensões e o formato da entrada, num slot livre de cache.arrays
+	int createArray(TextureCache& cache, const TextureEntry& entry, int layers)
+	{
+		int index = 0;
+		while (index < (int)cache.arrays.size() && cache.arrays[index].id != 0) index++;
+		if (index == (int)cache.arrays.size()) cache.arrays.push_back(TextureArray());
+
+		TextureArray& array = cache.arrays[index];
+		array.width = entry.width;
+		array.height = entry.height;
+		array.levels = entry.levels;
+		array.channels = entry.channels;
+		array.format = entry.format;
+		array.owners.assign(layers, -1);
+		array.vramBytes = entry.vramBytes * layers;
+
+		bool compressed = entry.format != TEXTURE_UNCOMPRESSED;
+		GLenum internal = storageFormat(entry.format, entry.channels);
+		glGenTextures(1, &array.id);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, array.id);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, entry.levels - 1);
+		if (glTexStorage3D)
+			glTexStorage3D(GL_TEXTURE_2D_ARRAY, entry.levels, internal, entry.width, entry.height, layers);
+		else
+		{
+			for (int level = 0; level < entry.levels; level++)
+			{
+				int w = levelSize(entry.width, level), h = levelSize(entry.height, level);
+				if (compressed)
+					glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, internal, w, h, layers, 0,
+						(GLsizei)(compressedImageSize(entry.format, w, h) * layers), nullptr);
+				else
+					glTexImage3D(GL_TEXTURE_2D_ARRAY, level, internal, w, h, layers, 0, entry.channels == 3 ? GL_RGB : GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			}
+		}
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		gpuTrack(GPU_TEXTURE, array.id, "array " + to_string(entry.width) + "x" + to_string(entry.height) + " " +
+			textureFormatName(entry.format) + " (" + to_string(layers) + " camadas)", array.vramBytes);
+		return index;
+	}
+
+	// Copia todos os níveis para a camada (na GPU com GL 4.3, senão ida e volta pela CPU) e apaga a textura 2D
+	void moveToLayer(TextureCache& cache, TextureHandle handle, int arrayIndex, int layer)
+	{
+		TextureEntry& entry = cache.entries[handle];
+		TextureArray& array = cache.arrays[arrayIndex];
+		bool compressed = entry.format != TEXTURE_UNCOMPRESSED;
+		vector<unsigned char> pixels;
+		for (int level = 0; level < entry.levels; level++)
+		{
+			int w = levelSize(entry.width, level), h = levelSize(entry.height, level);
+			if (glCopyImageSubData)
+			{
+				glCopyImageSubData(entry.id, GL_TEXTURE_2D, level, 0, 0, 0, array.id, GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, w, h, 1);
+				continue;
+			}
+			glBindTexture(GL_TEXTURE_2D, entry.id);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, array.id);
+			if (compressed)
+			{
+				size_t size = compressedImageSize(entry.format, w, h);
+				pixels.resize(size);
+				glGetCompressedTexImage(GL_TEXTURE_2D, level, pixels.data());
+				glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, w, h, 1, compressedInternalFormat(entry.format), (GLsizei)size, pixels.data());
+			}
+			else
+			{
+				GLenum format = entry.channels == 3 ? GL_RGB : GL_RGBA;
+				pixels.resize((size_t)w * h * entry.channels);
+				glPixelStorei(GL_PACK_ALIGNMENT, 1);
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+				glGetTexImage(GL_TEXTURE_2D, level, format, GL_UNSIGNED_BYTE, pixels.data());
+				glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, w, h, 1, format, GL_UNSIGNED_BYTE, pixels.data());
+				glPixelStorei(GL_PACK_ALIGNMENT, 4);
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+			}
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+		gpuUntrack(GPU_TEXTURE, entry.id);
+		glDeleteTextures(1, &entry.id);
+		entry.id = 0;
+		entry.array = arrayIndex;
+		entry.layer = layer;
+		array.owners[layer] = handle;
+	}
+
+	// Libera a camada da entrada; o array que fica vazio é apagado
+	void releaseLayer(TextureCache& cache, const TextureEntry& entry)
+	{
+		TextureArray& array = cache.arrays[entry.array];
+		array.owners[entry.layer] = -1;
+		for (TextureHandle owner : array.owners)
+			if (owner >= 0) return;
+		gpuUntrack(GPU_TEXTURE, array.id);
+		glDeleteTextures(1, &array.id);
+		array = TextureArray();
+	}
+
+	// Próximo nível mais fino, direto do arquivo mapeado (síncrono: o driver copia antes de voltar)
+	size_t addLevel(TextureCache& cache, TextureEntry& entry)
+	{
+		const CookedTexture& image = entry.load->image;
+		int level = entry.baseLevel - 1;
+		size_t size = image.offsets[level + 1] - image.offsets[level];
+		glBindTexture(GL_TEXTURE_2D, entry.id);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		texImage(entry, level, size, image.pixels() + image.offsets[level]);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		entry.baseLevel = level;
+		entry.vramBytes += levelVram(image, level);
+		gpuTrack(GPU_TEXTURE, entry.id, entry.path, entry.vramBytes);
+		cache.streamedBytes += levelVram(image, level);
+		cache.stats.refines++;
+		cache.stats.streamUploadedBytes += size;
+		return size;
+	}
+
+	// Tira o nível mais fino: a base sobe e o nível é redefinido vazio, liberando a memória
+	void dropLevel(TextureCache& cache, TextureEntry& entry)
+	{
+		int level = entry.baseLevel;
+		glBindTexture(GL_TEXTURE_2D, entry.id);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level + 1);
+		glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		size_t bytes = levelVram(entry.load->image, level);
+		entry.baseLevel = level + 1;
+		entry.vramBytes -= bytes;
+		gpuTrack(GPU_TEXTURE, entry.id, entry.path, entry.vramBytes);
+		cache.streamedBytes -= bytes;
+		cache.stats.evictions++;
+	}
+
+	// A que perde um nível para abrir espaço: entre as que têm mais que o mínimo e não precisam
+	// do que têm (não pedidas neste quadro ou pedidas com menos detalhe), a pedida há mais tempo
+	TextureHandle evictionCandidate(const TextureCache& cache, int frame, TextureHandle keep)
+	{
+		TextureHandle best = -1;
+		for (size_t h = 0; h < cache.entries.size(); h++)
+		{
+			const TextureEntry& entry = cache.entries[h];
+			if ((TextureHandle)h == keep || entry.refs <= 0 || !entry.streamed || entry.state != TEXTURE_RESIDENT ||
+				entry.baseLevel >= streamBaseLevel(entry))
+				continue;
+			if (entry.lastNeeded == frame && entry.baseLevel >= entry.wantedLevel) continue;
+			if (best < 0 || entry.lastNeeded < cache.entries[best].lastNeeded) best = (TextureHandle)h;
+		}
+		return best;
+	}
+
+	// Tira da fila os níveis mapeados de uma entrada que vai ser apagada
+	void cancelStaged(TextureCache& cache, TextureHandle handle)
+	{
+		waitForCounter(cache.copies);
+		for (size_t i = 0; i < cache.staged.size();)
+		{
+			const TextureStagedLevel& staged = cache.staged[i];
+			if (staged.handle != handle) { i++; continue; }
+			if (staged.pbo >= 0)
+			{
+				TexturePBO& pbo = cache.pbos[staged.pbo];
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo.buffer);
+				glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+				pbo.busy = false;
+			}
+			cache.staged.erase(cache.staged.begin() + i);
+		}
+	}
+}
+
+void setTextureCompression(TextureCache& cache, TextureFormat format, CompressionQuality quality)
+{
+	if (!compressedFormatSupported(format))
+	{
+		cout << "Compressao de texturas " << textureFormatName(format) << " nao suportada pelo driver; usando RGBA8" << endl;
+		format = TEXTURE_UNCOMPRESSED;
+	}
+	cache.compression = format;
+	cache.quality = quality;
+}
+
+void setTextureMipSettings(TextureCache& cache, const MipSettings& settings)
+{
+	cache.mips = settings;
+}
+
+string canonicalTexturePath(const string& path)
+{
+	string result;
+#ifdef _WIN32
+	char buffer[_MAX_PATH];
+	if (_fullpath(buffer, path.c_str(), _MAX_PATH)) result = buffer;
+#else
+	char buffer[PATH_MAX];
+	if (realpath(path.c_str(), buffer)) result = buffer;
+#endif
+	if (result.empty()) result = path;
+
+	for (char& c : result)
+	{
+		if (c == '\\') c = '/';
+#ifdef _WIN32
+		c = (char)tolower((unsigned char)c);
+#endif
+	}
+	return result;
+}
+
+TextureHandle acquireTexture(TextureCache& cache, const string& path)
+{
+	double start = nowMs();
+	if (cache.firstRequest < 0.0) cache.firstRequest = start;
+	cache.stats.requests++;
+
+	string canonical = canonicalTexturePath(path);
+	auto byPath = cache.byPath.find(canonical);
+	if (byPath != cache.byPath.end())
+	{
+		cache.stats.pathHits++;
+		return hit(cache, byPath->second);
+	}
+
+	// Lê o arquivo na hora: os bytes servem para o hash (e para achar cópias) e para a decodificação
+	shared_ptr<TextureLoad> load = make_shared<TextureLoad>();
+	if (!readFileBytes(canonical, load->file) || load->file.empty())
+	{
+		cout << "Failed to load texture " << path << endl;
+		cache.stats.failures++;
+		return -1;
+	}
+
+	uint64_t contentHash = hashBytes(load->file.data(), load->file.size());
+	auto byContent = cache.byContent.find(contentHash);
+	if (byContent != cache.byContent.end())
+	{
+		cache.stats.contentHits++;
+		cache.byPath[canonical] = byContent->second;
+		return hit(cache, byContent->second);
+	}
+
+	TextureHandle handle = newEntry(cache);
+	TextureEntry& entry = cache.entries[handle];
+	entry.path = canonical;
+	entry.contentHash = contentHash;
+	entry.id = createPlaceholder();
+	gpuTrack(GPU_TEXTURE, entry.id, canonical, 4);
+	entry.refs = 1;
+	entry.state = TEXTURE_LOADING;
+	entry.load = load;
+	load->path = canonical;
+	load->contentHash = contentHash;
+	load->mips = cache.mips;
+	load->cookKey = mipSettingsHash(cache.mips, contentHash);
+	load->requested = cache.compression;
+	load->quality = cache.quality;
+	load->stream = cache.streamBudget > 0;
+
+	runJob([load]() { decodeTexture(*load); }, &load->decoded, "textura: decodificacao");
+
+	cache.byPath[canonical] = handle;
+	cache.byContent[contentHash] = handle;
+	cache.stats.loads++;
+	cache.loading++;
+	cache.stats.loadMs += nowMs() - start;
+	return handle;
+}
+
+int updateTextureUploads(TextureCache& cache, size_t budget)
+{
+	if (cache.loading == 0 && cache.staged.empty()) return 0;
+	double start = nowMs();
+
+	recyclePBOs(cache);
+
+	// Níveis mapeados no quadro anterior: se as cópias ainda não acabaram, tenta no próximo
+	if (!cache.staged.empty())
+	{
+		if (cache.copies.pending.load(memory_order_acquire) > 0)
+		{
+			cache.stats.loadMs += nowMs() - start;
+			return cache.loading;
+		}
+		for (const TextureStagedLevel& staged : cache.staged)
+			finishLevel(cache, staged);
+		cache.staged.clear();
+		cache.stats.uploadFrames++;
+	}
+
+	// Sem threads de trabalho as decodificações só andam quando alguém espera por elas:
+	// uma por quadro na thread principal
+	bool decodeInline = jobWorkerCount() <= 1;
+
+	size_t bytes = 0;
+	for (size_t h = 0; h < cache.entries.size() && bytes < budget; h++)
+	{
+		TextureEntry& entry = cache.entries[h];
+		if (entry.refs <= 0 || entry.state != TEXTURE_LOADING || !entry.load) continue;
+
+		TextureLoad& load = *entry.load;
+		if (!load.ready)
+		{
+			if (load.decoded.pending.load(memory_order_acquire) > 0)
+			{
+				if (!decodeInline) continue;
+				waitForCounter(load.decoded);
+				decodeInline = false;
+			}
+			takeDecoded(cache, (TextureHandle)h);
+			if (entry.state != TEXTURE_LOADING) continue;
+		}
+
+		while (load.nextLevel >= entry.baseLevel && (bytes == 0 || bytes < budget))
+		{
+			bytes += load.image.offsets[load.nextLevel + 1] - load.image.offsets[load.nextLevel];
+			stageLevel(cache, (TextureHandle)h, load.nextLevel--);
+		}
+	}
+
+	cache.stats.loadMs += nowMs() - start;
+	return cache.loading;
+}
+
+void finishTextureUploads(TextureCache& cache)
+{
+	while (cache.loading > 0 || !cache.staged.empty())
+	{
+		for (TextureEntry& entry : cache.entries)
+			if (entry.load) waitForCounter(entry.load->decoded);
+		waitForCounter(cache.copies);
+		updateTextureUploads(cache, SIZE_MAX);
+	}
+}
+
+void retainTexture(TextureCache& cache, TextureHandle handle)
+{
+	if (handle >= 0 && handle < (int)cache.entries.size() && cache.entries[handle].refs > 0)
+		cache.entries[handle].refs++;
+}
+
+void releaseTexture(TextureCache& cache, TextureHandle handle)
+{
+	if (handle < 0 || handle >= (int)cache.entries.size()) return;
+	TextureEntry& entry = cache.entries[handle];
+	if (entry.refs <= 0 || --entry.refs > 0) return;
+
+	// Carregamento pela metade: espera a decodificação e descarta os níveis já mapeados
+	if (entry.load)
+	{
+		waitForCounter(entry.load->decoded);
+		cancelStaged(cache, handle);
+	}
+	if (entry.state == TEXTURE_LOADING && --cache.loading == 0)
+		cache.stats.residentMs = nowMs() - cache.firstRequest;
+	if (entry.streamed && entry.state == TEXTURE_RESIDENT)
+		cache.streamedBytes -= entry.vramBytes;
+
+	if (entry.array >= 0) releaseLayer(cache, entry);
+	else
+	{
+		gpuUntrack(GPU_TEXTURE, entry.id);
+		glDeleteTextures(1, &entry.id);
+	}
+
+	// Tira dos índices todos os caminhos que apontavam para a entrada
+	for (auto it = cache.byPath.begin(); it != cache.byPath.end();)
+		it = it->second == handle ? cache.byPath.erase(it) : next(it);
+	cache.byContent.erase(entry.contentHash);
+
+	entry = TextureEntry();
+	cache.freeHandles.push_back(handle);
+}
+
+int packTextureArrays(TextureCache& cache)
+{
+	if (!cache.packPending || cache.loading > 0 || !cache.staged.empty()) return 0;
+	cache.packPending = false;
+	double start = nowMs();
+
+	// Residentes ainda soltas, agrupadas por dimensões, níveis e formato
+	map<tuple<int, int, int, int, int>, vector<TextureHandle>> groups;
+	for (size_t h = 0; h < cache.entries.size(); h++)
+	{
+		const TextureEntry& entry = cache.entries[h];
+		if (entry.refs <= 0 || entry.state != TEXTURE_RESIDENT || entry.array >= 0 || entry.streamed) continue;
+		groups[make_tuple(entry.width, entry.height, entry.levels, (int)entry.format, entry.channels)].push_back((TextureHandle)h);
+	}
+
+	GLint maxLayers = 256;
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+	int packed = 0;
+	for (const auto& group : groups)
+	{
+		const vector<TextureHandle>& handles = group.second;
+		TextureEntry first = cache.entries[handles[0]];
+		size_t next = 0;
+
+		// Camadas livres de arrays compatíveis primeiro
+		for (size_t a = 0; a < cache.arrays.size() && next < handles.size(); a++)
+		{
+			const TextureArray& array = cache.arrays[a];
+			if (array.id == 0 || array.width != first.width || array.height != first.height || array.levels != first.levels ||
+				array.format != first.format || array.channels != first.channels)
+				continue;
+			for (int layer = 0; layer < (int)array.owners.size() && next < handles.size(); layer++)
+				if (array.owners[layer] < 0) moveToLayer(cache, handles[next++], (int)a, layer);
+		}
+
+		// O resto em arrays novos, com o nro exato de camadas
+		while (next < handles.size())
+		{
+			int layers = (int)min(handles.size() - next, (size_t)maxLayers);
+			int a = createArray(cache, first, layers);
+			for (int layer = 0; layer < layers; layer++)
+				moveToLayer(cache, handles[next++], a, layer);
+		}
+		packed += (int)handles.size();
+	}
+
+	cache.stats.packed += packed;
+	cache.stats.packMs += nowMs() - start;
+	if (packed > 0) cache.packVersion++;
+	return packed;
+}
+
+void setTextureStreaming(TextureCache& cache, size_t budgetBytes)
+{
+	cache.streamBudget = budgetBytes;
+}
+
+void requestTextureResolution(TextureCache& cache, TextureHandle handle, float screenPixels)
+{
+	if (handle < 0 || handle >= (int)cache.entries.size()) return;
+	TextureEntry& entry = cache.entries[handle];
+	if (!entry.streamed) return;
+
+	// Nível em que um texel cobre cerca de um pixel
+	float texels = (float)max(entry.width, entry.height);
+	int level = 0;
+	if (screenPixels < texels)
+		level = screenPixels > 1.0f ? min(entry.levels - 1, (int)log2(texels / screenPixels)) : entry.levels - 1;
+	if (entry.lastNeeded != cache.frame || level < entry.wantedLevel)
+		entry.wantedLevel = level;
+	entry.lastNeeded = cache.frame;
+}
+
+int updateTextureStreaming(TextureCache& cache, size_t budget)
+{
+	int frame = cache.frame++;
+	if (cache.streamBudget == 0) return 0;
+
+	// Acima do orçamento de GPU (setGpuBudget): as pedidas há mais tempo perdem níveis primeiro
+	int changes = 0;
+	TextureHandle victim;
+	while (gpuHeadroom() < 0 && (victim = evictionCandidate(cache, frame, -1)) >= 0)
+	{
+		dropLevel(cache, cache.entries[victim]);
+		changes++;
+	}
+
+	// Pedidas no quadro com mais detalhe do que têm, as mais longe do pedido primeiro
+	vector<TextureHandle> refine;
+	for (size_t h = 0; h < cache.entries.size(); h++)
+	{
+		const TextureEntry& entry = cache.entries[h];
+		if (entry.refs > 0 && entry.streamed && entry.state == TEXTURE_RESIDENT && entry.lastNeeded == frame &&
+			entry.wantedLevel < entry.baseLevel)
+			refine.push_back((TextureHandle)h);
+	}
+	sort(refine.begin(), refine.end(), [&](TextureHandle a, TextureHandle b)
+	{
+		const TextureEntry& ea = cache.entries[a];
+		const TextureEntry& eb = cache.entries[b];
+		return ea.baseLevel - ea.wantedLevel > eb.baseLevel - eb.wantedLevel;
+	});
+
+	// Um nível por textura por quadro
+	size_t bytes = 0;
+	for (TextureHandle h : refine)
+	{
+		TextureEntry& entry = cache.entries[h];
+		size_t extra = levelVram(entry.load->image, entry.baseLevel - 1);
+		auto overBudget = [&]() { return cache.streamedBytes + extra > cache.streamBudget || (long long)extra > gpuHeadroom(); };
+		while (overBudget() && (victim = evictionCandidate(cache, frame, h)) >= 0)
+		{
+			dropLevel(cache, cache.entries[victim]);
+			changes++;
+		}
+		if (overBudget()) continue; // O orçamento está todo em uso pelo quadro
+
+		bytes += addLevel(cache, entry);
+		changes++;
+		if (bytes >= budget) break;
+	}
+	return changes;
+}
+
+TextureBinding textureBinding(const TextureCache& cache, TextureHandle handle)
+{
+	TextureBinding binding;
+	const TextureEntry* entry = textureEntry(cache, handle);
+	if (!entry) return binding;
+	if (entry->array >= 0)
+	{
+		binding.target = GL_TEXTURE_2D_ARRAY;
+		binding.id = cache.arrays[entry->array].id;
+		binding.layer = entry->layer;
+	}
+	else
+		binding.id = entry->id;
+	return binding;
+}
+
+GLuint textureId(const TextureCache& cache, TextureHandle handle)
+{
+	const TextureEntry* entry = textureEntry(cache, handle);
+	return entry ? entry->id : 0;
+}
+
+const TextureEntry* textureEntry(const TextureCache& cache, TextureHandle handle)
+{
+	if (handle < 0 || handle >= (int)cache.entries.size() || cache.entries[handle].refs <= 0) return nullptr;
+	return &cache.entries[handle];
+}
+
+void reportTextureCache(const TextureCache& cache)
+{
+	const TextureCacheStats& s = cache.stats;
+	size_t live = 0, vram = 0;
+	int refs = 0;
+	for (const TextureEntry& entry : cache.entries)
+	{
+		if (entry.refs <= 0) continue;
+		live++;
+		refs += entry.refs;
+		vram += entry.vramBytes;
+	}
+
+	cout << fixed << setprecision(1);
+	cout << "Texturas: " << live << " carregadas (" << vram / (1024.0 * 1024.0) << " MB de VRAM, " << refs << " referencias), "
+		<< s.requests << " pedidos, " << s.pathHits << " pelo caminho e " << s.contentHits << " pelo conteudo, "
+		<< s.failures << " falhas" << endl;
+	cout << "  residentes em " << s.residentMs << " ms: " << s.decodeMs << " ms decodificando nas threads de trabalho, "
+		<< s.loadMs << " ms na thread do GL, " << s.uploads << " niveis (" << s.uploadedBytes / (1024.0 * 1024.0)
+		<< " MB) em " << s.uploadFrames << " quadros" << endl;
+	cout << "  cache (" << textureFormatName(cache.compression) << "): " << s.cookedLoads << " mapeadas sem decodificar, "
+		<< s.cooks << " decodificadas e gravadas (" << s.cookMs << " ms comprimindo)" << endl;
+	int arrays = 0, layers = 0;
+	for (const TextureArray& array : cache.arrays)
+	{
+		if (array.id == 0) continue;
+		arrays++;
+		layers += (int)array.owners.size();
+	}
+	if (arrays > 0)
+		cout << "  " << s.packed << " empacotadas em " << arrays << " arrays (" << layers << " camadas) em " << s.packMs << " ms" << endl;
+	if (cache.streamBudget > 0)
+		cout << "  streaming: " << s.streamed << " texturas, " << cache.streamedBytes / (1024.0 * 1024.0) << " de "
+			<< cache.streamBudget / (1024.0 * 1024.0) << " MB, " << s.refines << " niveis acrescentados ("
+			<< s.streamUploadedBytes / (1024.0 * 1024.0) << " MB) e " << s.evictions << " tirados" << endl;
+	cout << "  economizados: " << s.decodeBytesSaved / (1024.0 * 1024.0) << " MB de decodificacao, "
+		<< s.vramBytesSaved / (1024.0 * 1024.0) << " MB de VRAM" << endl;
+	cout << defaultfloat;
+}
+
+void deleteTextureCache(TextureCache& cache)
+{
+	for (TextureEntry& entry : cache.entries)
+		if (entry.load) waitForCounter(entry.load->decoded);
+	waitForCounter(cache.copies);
+
+	for (const TextureStagedLevel& staged : cache.staged)
+	{
+		if (staged.pbo < 0) continue;
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, cache.pbos[staged.pbo].buffer);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	for (TexturePBO& pbo : cache.pbos)
+	{
+		if (pbo.fence) glDeleteSync(pbo.fence);
+		gpuUntrack(GPU_STAGING, pbo.buffer);
+		glDeleteBuffers(1, &pbo.buffer);
+	}
+
+	for (TextureEntry& entry : cache.entries)
+	{
+		if (entry.refs <= 0 || !entry.id) continue;
+		gpuUntrack(GPU_TEXTURE, entry.id);
+		glDeleteTextures(1, &entry.id);
+	}
+	for (TextureArray& array : cache.arrays)
+	{
+		if (!array.id) continue;
+		gpuUntrack(GPU_TEXTURE, array.id);
+		glDeleteTextures(1, &array.id);
+	}
+	cache.entries.clear();
+	cache.arrays.clear();
+	cache.byPath.clear();
+	cache.byContent.clear();
+	cache.freeHandles.clear();
+	cache.pbos.clear();
+	cache.staged.clear();
+	cache.loading = 0;
+	cache.packPending = false;
+	cache.streamedBytes = 0;
+}
@@ -0,0 +1,225 @@
+// Gerenciador de texturas: cada imagem é decodificada e enviada à GPU uma vez só
+//
+// As texturas são identificadas pelo caminho canônico (o mesmo arquivo referenciado por caminhos
+// diferentes, como "../Modelos3D/Novos/TexturasOffice.png" e "./../Modelos3D/Novos/..." cai na
+// mesma entrada) e, quando o caminho é novo, pelo hash do conteúdo do arquivo (cópias idênticas
+// em pastas diferentes também). Quem pede uma textura recebe um handle com contagem de
+// referências; a textura da GPU é apagada quando a última referência é liberada.
+//
+// O carregamento é assíncrono: acquireTexture lê o arquivo e devolve na hora uma textura de 1x1
+// cinza, enquanto uma thread de trabalho decodifica a imagem e monta a cadeia de mipmaps (TextureMips.h). A cada
+// quadro updateTextureUploads envia alguns níveis, do menor para o maior, por pixel unpack
+// buffers: o mapeamento é feito na thread do GL, a cópia numa thread de trabalho e, no quadro
+// seguinte, glTexImage2D lê do buffer sem esperar. O nome da textura não muda, então quem guardou
+// o id passa a ver a imagem (cada vez mais nítida) sem fazer nada.
+//
+// A thread de trabalho procura primeiro a textura cozida em ./cache: se o hash da imagem e as opções
+// batem, o arquivo é mapeado e os níveis prontos (crus ou comprimidos, conforme setTextureCompression)
+// vão dele para os buffers, sem decodificar nem gerar mipmaps; senão a imagem é decodificada (e
+// comprimida) e o arquivo é regravado. Com GL 4.2 a textura é alocada uma vez com glTexStorage2D e os
+// níveis são preenchidos com glTexSubImage2D.
+//
+// Quando todas ficam residentes, packTextureArrays move as texturas de mesmo tamanho, formato e nro
+// de níveis para camadas de um GL_TEXTURE_2D_ARRAY (cópia na GPU) e apaga as texturas 2D: quem
+// desenha pega o array e a camada com textureBinding, e objetos com texturas diferentes do mesmo
+// grupo são desenhados sem trocar a textura ligada, só o índice da camada.
+//
+// Com setTextureStreaming as texturas grandes começam só com os níveis de até 64x64 e ficam fora dos
+// arrays. A cada quadro quem desenha diz o tamanho do objeto na tela (requestTextureResolution) e
+// updateTextureStreaming refina, um nível por vez, as que pedem mais detalhe do que têm, dentro do
+// orçamento de VRAM; para abrir espaço, as que não foram pedidas há mais tempo (ou têm mais detalhe
+// do que o pedido) perdem o nível mais fino. Os níveis vêm do arquivo cozido mapeado; a textura não
+// usa armazenamento imutável, GL_TEXTURE_BASE_LEVEL marca o nível mais fino presente e o nível tirado
+// é redefinido com tamanho 0 para liberar a memória (o nome da textura não muda).
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+//GLAD
+#include <glad/glad.h>
+
+#include "Jobs.h"
+#include "TextureCompress.h"
+#include "TextureMips.h"
+
+typedef int TextureHandle; // Índice em TextureCache::entries (-1 = nenhuma)
+
+// Bytes enviados por quadro (o primeiro nível da fila sempre vai, mesmo que passe do limite)
+const size_t TEXTURE_UPLOAD_BUDGET = 8u << 20;
+
+// Com streaming: texturas maiores que isso (em alguma dimensão) são carregadas por demanda, a
+// partir do primeiro nível que cabe em TEXTURE_STREAM_BASE_SIZE
+const int TEXTURE_STREAM_MIN_SIZE = 256;
+const int TEXTURE_STREAM_BASE_SIZE = 64;
+
+enum TextureState
+{
+	TEXTURE_LOADING,  // Decodificando ou enviando os níveis; a textura mostra o que já chegou
+	TEXTURE_RESIDENT, // Cadeia completa na GPU (com streaming, a partir de baseLevel)
+	TEXTURE_FAILED    // Não decodificou: fica a textura cinza
+};
+
+struct TextureLoad; // Dados do carregamento em andamento (Texture.cpp)
+
+struct TextureEntry
+{
+	std::string path;         // Caminho canônico do primeiro arquivo carregado
+	uint64_t contentHash = 0; // FNV-1a dos bytes do arquivo
+	GLuint id = 0;
+	int width = 0, height = 0, channels = 0;
+	int levels = 0;           // Níveis de mipmap
+	TextureFormat format = TEXTURE_UNCOMPRESSED; // Formato na GPU
+	size_t decodedBytes = 0;  // Pixels decodificados (nível 0)
+	size_t vramBytes = 0;     // Na GPU, com a cadeia de mipmaps (exato nos formatos comprimidos)
+	int refs = 0;
+	TextureState state = TEXTURE_LOADING;
+	std::shared_ptr<TextureLoad> load; // Liberado quando a textura fica residente
+	int array = -1, layer = -1;        // Depois de empacotada (id passa a ser 0)
+
+	// Streaming (a carga continua viva: os níveis vêm do arquivo mapeado)
+	bool streamed = false;
+	int baseLevel = 0;                 // Nível da cadeia que está no nível 0 da textura
+	int wantedLevel = 0;               // Nível mais fino pedido no quadro lastNeeded
+	int lastNeeded = -1;
+};
+
+struct TextureCacheStats
+{
+	int requests = 0;        // Chamadas a acquireTexture
+	int pathHits = 0;        // Mesmo caminho canônico
+	int contentHits = 0;     // Caminho novo, conteúdo já carregado
+	int loads = 0;           // Decodificações de fato
+	int cookedLoads = 0;     // Mapeadas do cache, sem decodificar
+	int cooks = 0;           // Decodificadas (e comprimidas) e gravadas no cache
+	double cookMs = 0.0;     // Soma do tempo de compressão (incluso em decodeMs)
+	int packed = 0;          // Texturas movidas para arrays
+	double packMs = 0.0;
+	int streamed = 0;        // Texturas carregadas por demanda
+	int refines = 0;         // Níveis acrescentados pelo streaming
+	int evictions = 0;       // Níveis tirados para caber no orçamento
+	size_t streamUploadedBytes = 0;
+	int failures = 0;
+	size_t decodeBytesSaved = 0;
+	size_t vramBytesSaved = 0;
+	double loadMs = 0.0;     // Tempo da thread do GL em acquireTexture e updateTextureUploads
+	double decodeMs = 0.0;   // Soma do tempo das threads de trabalho (decodificação e mipmaps)
+	double residentMs = 0.0; // Do primeiro pedido até a última textura ficar residente
+	size_t uploadedBytes = 0;
+	int uploads = 0;         // Níveis enviados
+	int uploadFrames = 0;    // Quadros em que algo foi enviado
+};
+
+// Pixel unpack buffer reaproveitado entre envios; fica ocupado até a cerca do glTexImage2D passar
+struct TexturePBO
+{
+	GLuint buffer = 0;
+	size_t capacity = 0;
+	GLsync fence = 0;
+	bool busy = false;
+};
+
+// Nível mapeado, esperando a cópia terminar para ir à GPU
+struct TextureStagedLevel
+{
+	TextureHandle handle;
+	int level;
+	int pbo;
+};
+
+// Texturas de mesmo tamanho, formato e nro de níveis, uma por camada
+struct TextureArray
+{
+	GLuint id = 0;                      // 0 = entrada livre em TextureCache::arrays
+	int width = 0, height = 0, levels = 0, channels = 0;
+	TextureFormat format = TEXTURE_UNCOMPRESSED;
+	std::vector<TextureHandle> owners;  // Textura de cada camada (-1 = livre, reaproveitada no próximo empacotamento)
+	size_t vramBytes = 0;
+};
+
+// Como amostrar uma textura: 2D (layer = -1) ou camada de um array
+struct TextureBinding
+{
+	GLenum target = GL_TEXTURE_2D;
+	GLuint id = 0;
+	int layer = -1;
+};
+
+struct TextureCache
+{
+	std::vector<TextureEntry> entries;
+	std::unordered_map<std::string, TextureHandle> byPath;  // Caminho canônico (e os caminhos dos hits por conteúdo)
+	std::unordered_map<uint64_t, TextureHandle> byContent;
+	std::vector<TextureHandle> freeHandles;                 // Entradas liberadas, reaproveitadas
+	TextureCacheStats stats;
+
+	std::vector<TexturePBO> pbos;
+	std::vector<TextureStagedLevel> staged;
+	JobCounter copies;                                      // Cópias para os buffers mapeados em andamento
+	int loading = 0;                                        // Entradas em TEXTURE_LOADING
+	double firstRequest = -1.0;
+
+	TextureFormat compression = TEXTURE_UNCOMPRESSED;       // Pedido para as próximas texturas
+	CompressionQuality quality = COMPRESS_NORMAL;
+	MipSettings mips;
+
+	std::vector<TextureArray> arrays;
+	bool packPending = false;                               // Alguma textura ficou residente desde o último empacotamento
+	int packVersion = 0;                                    // Muda a cada empacotamento (quem ordena por textura refaz a ordem)
+
+	size_t streamBudget = 0;                                // VRAM das texturas com streaming (0 = carrega tudo)
+	size_t streamedBytes = 0;                               // Na GPU agora, nas texturas com streaming
+	int frame = 0;                                          // Avança a cada updateTextureStreaming
+};
+
+// Na thread do GL, antes de pedir texturas: sem suporte ao formato no contexto, fica sem compressão
+void setTextureCompression(TextureCache& cache, TextureFormat format, CompressionQuality quality);
+
+// Filtro dos mipmaps das próximas texturas decodificadas (as cozidas com outras opções são refeitas)
+void setTextureMipSettings(TextureCache& cache, const MipSettings& settings);
+
+// Orçamento de VRAM das texturas com streaming, antes de pedir texturas (0 = sem streaming)
+void setTextureStreaming(TextureCache& cache, size_t budgetBytes);
+
+// Caminho absoluto sem "." e "..", com separadores '/' (e em minúsculas no Windows)
+std::string canonicalTexturePath(const std::string& path);
+
+// Lê o arquivo e começa a decodificação (ou reaproveita a textura) e adiciona uma referência.
+// Retorna -1 se o arquivo não pôde ser lido
+TextureHandle acquireTexture(TextureCache& cache, const std::string& path);
+// Mais uma referência para um handle já obtido (cópias de um objeto)
+void retainTexture(TextureCache& cache, TextureHandle handle);
+// Remove uma referência; na última a textura é apagada da GPU
+void releaseTexture(TextureCache& cache, TextureHandle handle);
+
+// Uma vez por quadro, na thread do GL: termina os envios mapeados no quadro anterior e mapeia
+// os próximos níveis até budget bytes. Retorna o nro de texturas ainda carregando
+int updateTextureUploads(TextureCache& cache, size_t budget = TEXTURE_UPLOAD_BUDGET);
+// Envia tudo que falta, sem limite por quadro (testes, benchmark de carregamento)
+void finishTextureUploads(TextureCache& cache);
+
+// Diâmetro em pixels de um objeto com a textura, no quadro corrente (supõe a textura cobrindo o
+// objeto uma vez): vale o maior pedido do quadro. Sem pedido a textura vira candidata a perder níveis
+void requestTextureResolution(TextureCache& cache, TextureHandle handle, float screenPixels);
+// Uma vez por quadro, depois dos pedidos: refina e reduz as texturas com streaming até budget bytes
+// enviados. Retorna o nro de níveis acrescentados ou tirados
+int updateTextureStreaming(TextureCache& cache, size_t budget = TEXTURE_UPLOAD_BUDGET);
+
+// Com as texturas todas residentes, move as ainda soltas para arrays (reaproveitando camadas livres
+// de arrays compatíveis). Retorna quantas foram movidas; sem nada novo, não faz nada
+int packTextureArrays(TextureCache& cache);
+TextureBinding textureBinding(const TextureCache& cache, TextureHandle handle);
+
+// Textura 2D (0 depois de empacotada: use textureBinding)
+GLuint textureId(const TextureCache& cache, TextureHandle handle);
+const TextureEntry* textureEntry(const TextureCache& cache, TextureHandle handle);
+
+// Texturas vivas, referências, tempos de carregamento e bytes de decodificação e de VRAM economizados
+void reportTextureCache(const TextureCache& cache);
+// Apaga todas as texturas, com ou sem referências, esperando as decodificações em andamento
+void deleteTextureCache(TextureCache& cache);
@@ -0,0 +1,781 @@
+#include "TextureCompress.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+
+//STB_IMAGE
+#include <stb_image.h>
+
+#include "Cache.h"
+#include "GLExtensions.h"
+#include "Jobs.h"
+#include "TextureMips.h"
+
+using namespace std;
+
+namespace
+{
+	const uint32_t COOKED_TEXTURE_MAGIC = 0x58455443; // "CTEX"
+	const uint32_t COOKED_TEXTURE_VERSION = 1;
+	const uint32_t TEXTURE_MAX_COOKED_SIZE = 16384; // Maior lado aceito ao ler um arquivo cozido
+
+	// Faixas de blocos por job
+	const size_t BLOCK_ROW_GRAIN = 4;
+
+	// Pesos de interpolação dos índices de 4 bits do BC7 (em 64 avos)
+	const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	double elapsedMs(chrono::high_resolution_clock::time_point start)
+	{
+		return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+	}
+
+	inline float clamp255(float v) { return min(max(v, 0.0f), 255.0f); }
+
+	inline int blockBytes(TextureFormat format) { return format == TEXTURE_BC1 ? 8 : 16; }
+
+	// Bloco 4x4 RGBA; nas bordas de imagens que não são múltiplas de 4 repete o último texel
+	void fetchBlock(const unsigned char* rgba, int width, int height, int bx, int by, unsigned char block[64])
+	{
+		for (int y = 0; y < 4; y++)
+		{
+			int sy = min(by * 4 + y, height - 1);
+			for (int x = 0; x < 4; x++)
+			{
+				int sx = min(bx * 4 + x, width - 1);
+				memcpy(block + (y * 4 + x) * 4, rgba + ((size_t)sy * width + sx) * 4, 4);
+			}
+		}
+	}
+
+	void storeBlock(const unsigned char block[64], int width, int height, int bx, int by, unsigned char* rgba)
+	{
+		for (int y = 0; y < 4 && by * 4 + y < height; y++)
+			for (int x = 0; x < 4 && bx * 4 + x < width; x++)
+				memcpy(rgba + ((size_t)(by * 4 + y) * width + bx * 4 + x) * 4, block + (y * 4 + x) * 4, 4);
+	}
+
+	// Extremos iniciais: pontas da projeção no eixo principal (iteração de potência na covariância),
+	// ou a diagonal da caixa no preset rápido. channels = 3 (BC1) ou 4 (BC7)
+	void initialEndpoints(const unsigned char block[64], int channels, CompressionQuality quality, float e0[4], float e1[4])
+	{
+		float lo[4] = { 255, 255, 255, 255 }, hi[4] = { 0, 0, 0, 0 }, mean[4] = { 0, 0, 0, 0 };
+		for (int i = 0; i < 16; i++)
+			for (int c = 0; c < channels; c++)
+			{
+				float v = block[i * 4 + c];
+				lo[c] = min(lo[c], v);
+				hi[c] = max(hi[c], v);
+				mean[c] += v / 16.0f;
+			}
+
+		if (quality == COMPRESS_FAST)
+		{
+			for (int c = 0; c < channels; c++) { e0[c] = hi[c]; e1[c] = lo[c]; }
+			return;
+		}
+
+		float cov[4][4] = {};
+		for (int i = 0; i < 16; i++)
+			for (int a = 0; a < channels; a++)
+				for (int b = a; b < channels; b++)
+					cov[a][b] += (block[i * 4 + a] - mean[a]) * (block[i * 4 + b] - mean[b]);
+		for (int a = 0; a < channels; a++)
+			for (int b = 0; b < a; b++)
+				cov[a][b] = cov[b][a];
+
+		float axis[4];
+		for (int c = 0; c < channels; c++) axis[c] = hi[c] - lo[c];
+		for (int iter = 0; iter < 8; iter++)
+		{
+			float next[4] = { 0, 0, 0, 0 }, len = 0.0f;
+			for (int a = 0; a < channels; a++)
+			{
+				for (int b = 0; b < channels; b++) next[a] += cov[a][b] * axis[b];
+				len = max(len, fabs(next[a]));
+			}
+			if (len < 1e-6f) break;
+			for (int c = 0; c < channels; c++) axis[c] = next[c] / len;
+		}
+		float len2 = 0.0f;
+		for (int c = 0; c < channels; c++) len2 += axis[c] * axis[c];
+		if (len2 < 1e-12f)
+		{
+			for (int c = 0; c < channels; c++) { e0[c] = hi[c]; e1[c] = lo[c]; }
+			return;
+		}
+
+		float tMin = 1e30f, tMax = -1e30f;
+		for (int i = 0; i < 16; i++)
+		{
+			float t = 0.0f;
+			for (int c = 0; c < channels; c++) t += (block[i * 4 + c] - mean[c]) * axis[c];
+			tMin = min(tMin, t);
+			tMax = max(tMax, t);
+		}
+		for (int c = 0; c < channels; c++)
+		{
+			e0[c] = clamp255(mean[c] + axis[c] * tMax / len2);
+			e1[c] = clamp255(mean[c] + axis[c] * tMin / len2);
+		}
+	}
+
+	// Mínimos quadrados dos extremos com os índices fixos: weight[i] é o peso de e1 no texel i
+	bool refineEndpoints(const unsigned char block[64], int channels, const float weight[16], float e0[4], float e1[4])
+	{
+		float aa = 0, ab = 0, bb = 0, x[4] = { 0, 0, 0, 0 }, y[4] = { 0, 0, 0, 0 };
+		for (int i = 0; i < 16; i++)
+		{
+			float b = weight[i], a = 1.0f - b;
+			aa += a * a; ab += a * b; bb += b * b;
+			for (int c = 0; c < channels; c++)
+			{
+				x[c] += a * block[i * 4 + c];
+				y[c] += b * block[i * 4 + c];
+			}
+		}
+		float det = aa * bb - ab * ab;
+		if (fabs(det) < 1e-6f) return false;
+		for (int c = 0; c < channels; c++)
+		{
+			e0[c] = clamp255((bb * x[c] - ab * y[c]) / det);
+			e1[c] = clamp255((aa * y[c] - ab * x[c]) / det);
+		}
+		return true;
+	}
+
+	// ---- BC1 ----------------------------------------------------------------------------------
+
+	inline uint16_t pack565(const float c[3])
+	{
+		int r = (int)(c[0] * 31.0f / 255.0f + 0.5f), g = (int)(c[1] * 63.0f / 255.0f + 0.5f), b = (int)(c[2] * 31.0f / 255.0f + 0.5f);
+		return (uint16_t)((r << 11) | (g << 5) | b);
+	}
+
+	inline void unpack565(uint16_t v, int c[3])
+	{
+		int r = v >> 11, g = (v >> 5) & 63, b = v & 31;
+		c[0] = (r << 3) | (r >> 2);
+		c[1] = (g << 2) | (g >> 4);
+		c[2] = (b << 3) | (b >> 2);
+	}
+
+	// Paleta de 4 cores (c0 > c1): c0, c1, 2/3 c0 + 1/3 c1, 1/3 c0 + 2/3 c1
+	void bc1Palette(uint16_t c0, uint16_t c1, int palette[4][3])
+	{
+		unpack565(c0, palette[0]);
+		unpack565(c1, palette[1]);
+		for (int c = 0; c < 3; c++)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+	}
+
+	int bc1Indices(const unsigned char block[64], uint16_t c0, uint16_t c1, uint8_t indices[16])
+	{
+		int palette[4][3];
+		bc1Palette(c0, c1, palette);
+		int total = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			int best = 0, bestErr = INT32_MAX;
+			for (int k = 0; k < 4; k++)
+			{
+				int dr = block[i * 4] - palette[k][0], dg = block[i * 4 + 1] - palette[k][1], db = block[i * 4 + 2] - palette[k][2];
+				int err = dr * dr + dg * dg + db * db;
+				if (err < bestErr) { bestErr = err; best = k; }
+			}
+			indices[i] = (uint8_t)best;
+			total += bestErr;
+		}
+		return total;
+	}
+
+	void encodeBC1Block(const unsigned char block[64], CompressionQuality quality, unsigned char* out)
+	{
+		static const float BC1_WEIGHTS[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f }; // Peso de c1 por índice
+
+		float e0[4], e1[4];
+		initialEndpoints(block, 3, quality, e0, e1);
+		uint16_t c0 = pack565(e0), c1 = pack565(e1);
+		uint8_t indices[16];
+		int err = bc1Indices(block, c0, c1, indices);
+
+		int iterations = quality == COMPRESS_HIGH ? 3 : quality == COMPRESS_NORMAL ? 1 : 0;
+		for (int iter = 0; iter < iterations && err > 0; iter++)
+		{
+			float weight[16];
+			for (int i = 0; i < 16; i++) weight[i] = BC1_WEIGHTS[indices[i]];
+			if (!refineEndpoints(block, 3, weight, e0, e1)) break;
+			uint16_t r0 = pack565(e0), r1 = pack565(e1);
+			uint8_t refined[16];
+			int refinedErr = bc1Indices(block, r0, r1, refined);
+			if (refinedErr >= err) break;
+			err = refinedErr; c0 = r0; c1 = r1;
+			memcpy(indices, refined, 16);
+		}
+
+		// c0 > c1 seleciona o modo de 4 cores; trocar os extremos troca os índices 0<->1 e 2<->3
+		if (c0 < c1)
+		{
+			swap(c0, c1);
+			for (int i = 0; i < 16; i++) indices[i] ^= 1;
+		}
+		else if (c0 == c1)
+			memset(indices, 0, 16);
+
+		uint32_t bits = 0;
+		for (int i = 0; i < 16; i++) bits |= (uint32_t)indices[i] << (2 * i);
+		out[0] = (unsigned char)(c0 & 0xFF); out[1] = (unsigned char)(c0 >> 8);
+		out[2] = (unsigned char)(c1 & 0xFF); out[3] = (unsigned char)(c1 >> 8);
+		for (int k = 0; k < 4; k++) out[4 + k] = (unsigned char)(bits >> (8 * k));
+	}
+
+	// fourColor: no BC3 a cor usa sempre a paleta de 4 cores
+	void decodeBC1Block(const unsigned char* in, bool fourColor, unsigned char block[64])
+	{
+		uint16_t c0 = (uint16_t)(in[0] | (in[1] << 8)), c1 = (uint16_t)(in[2] | (in[3] << 8));
+		uint32_t bits = in[4] | (in[5] << 8) | (in[6] << 16) | ((uint32_t)in[7] << 24);
+		int palette[4][3];
+		bc1Palette(c0, c1, palette);
+		int alpha[4] = { 255, 255, 255, 255 };
+		if (!fourColor && c0 <= c1)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+			alpha[3] = 0;
+		}
+		for (int i = 0; i < 16; i++)
+		{
+			int k = (bits >> (2 * i)) & 3;
+			for (int c = 0; c < 3; c++) block[i * 4 + c] = (unsigned char)palette[k][c];
+			block[i * 4 + 3] = (unsigned char)alpha[k];
+		}
+	}
+
+	// ---- BC3 (alfa) ---------------------------------------------------------------------------
+
+	// Modo de 8 valores: a0 > a1, a0, a1 e 6 interpolados
+	void alphaPalette(int a0, int a1, int palette[8])
+	{
+		palette[0] = a0;
+		palette[1] = a1;
+		if (a0 > a1)
+			for (int k = 2; k < 8; k++) palette[k] = ((8 - k) * a0 + (k - 1) * a1) / 7;
+		else
+		{
+			for (int k = 2; k < 6; k++) palette[k] = ((6 - k) * a0 + (k - 1) * a1) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	void encodeAlphaBlock(const unsigned char block[64], unsigned char* out)
+	{
+		int a0 = 0, a1 = 255;
+		for (int i = 0; i < 16; i++)
+		{
+			a0 = max(a0, (int)block[i * 4 + 3]);
+			a1 = min(a1, (int)block[i * 4 + 3]);
+		}
+
+		uint64_t bits = 0;
+		if (a0 > a1)
+		{
+			int palette[8];
+			alphaPalette(a0, a1, palette);
+			for (int i = 0; i < 16; i++)
+			{
+				int best = 0, bestErr = INT32_MAX;
+				for (int k = 0; k < 8; k++)
+				{
+					int err = abs(block[i * 4 + 3] - palette[k]);
+					if (err < bestErr) { bestErr = err; best = k; }
+				}
+				bits |= (uint64_t)best << (3 * i);
+			}
+		}
+		out[0] = (unsigned char)a0;
+		out[1] = (unsigned char)a1;
+		for (int k = 0; k < 6; k++) out[2 + k] = (unsigned char)(bits >> (8 * k));
+	}
+
+	void decodeAlphaBlock(const unsigned char* in, unsigned char block[64])
+	{
+		int palette[8];
+		alphaPalette(in[0], in[1], palette);
+		uint64_t bits = 0;
+		for (int k = 0; k < 6; k++) bits |= (uint64_t)in[2 + k] << (8 * k);
+		for (int i = 0; i < 16; i++)
+			block[i * 4 + 3] = (unsigned char)palette[(bits >> (3 * i)) & 7];
+	}
+
+	// ---- BC7 modo 6 ---------------------------------------------------------------------------
+
+	struct BitWriter
+	{
+		uint64_t bits[2] = { 0, 0 };
+		int pos = 0;
+		void put(uint32_t value, int count)
+		{
+			for (int i = 0; i < count; i++, pos++)
+				if ((value >> i) & 1) bits[pos >> 6] |= 1ull << (pos & 63);
+		}
+	};
+
+	struct BitReader
+	{
+		uint64_t bits[2] = { 0, 0 };
+		int pos = 0;
+		uint32_t get(int count)
+		{
+			uint32_t value = 0;
+			for (int i = 0; i < count; i++, pos++)
+				value |= (uint32_t)((bits[pos >> 6] >> (pos & 63)) & 1) << i;
+			return value;
+		}
+	};
+
+	// Extremo de 7 bits + p-bit compartilhado pelos 4 canais
+	inline void quantizeBC7(const float e[4], int p, int q[4])
+	{
+		for (int c = 0; c < 4; c++)
+			q[c] = min(max((int)floor((e[c] - p) / 2.0f + 0.5f), 0), 127);
+	}
+
+	int bc7Indices(const unsigned char block[64], const int q0[4], int p0, const int q1[4], int p1, uint8_t indices[16])
+	{
+		int palette[16][4];
+		for (int c = 0; c < 4; c++)
+		{
+			int a = (q0[c] << 1) | p0, b = (q1[c] << 1) | p1;
+			for (int k = 0; k < 16; k++)
+				palette[k][c] = ((64 - BC7_WEIGHTS[k]) * a + BC7_WEIGHTS[k] * b + 32) >> 6;
+		}
+
+		int total = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			int best = 0, bestErr = INT32_MAX;
+			for (int k = 0; k < 16; k++)
+			{
+				int err = 0;
+				for (int c = 0; c < 4; c++)
+				{
+					int d = block[i * 4 + c] - palette[k][c];
+					err += d * d;
+				}
+				if (err < bestErr) { bestErr = err; best = k; }
+			}
+			indices[i] = (uint8_t)best;
+			total += bestErr;
+		}
+		return total;
+	}
+
+	struct BC7Candidate
+	{
+		int q0[4], q1[4];
+		int p0, p1;
+		uint8_t indices[16];
+		int err = INT32_MAX;
+	};
+
+	// Melhor combinação de p-bits para os extremos (no preset rápido, só as duas iguais)
+	void tryBC7Endpoints(const unsigned char block[64], const float e0[4], const float e1[4], CompressionQuality quality, BC7Candidate& best)
+	{
+		for (int p = 0; p < 4; p++)
+		{
+			BC7Candidate c;
+			c.p0 = p & 1;
+			c.p1 = p >> 1;
+			if (quality == COMPRESS_FAST && c.p0 != c.p1) continue;
+			quantizeBC7(e0, c.p0, c.q0);
+			quantizeBC7(e1, c.p1, c.q1);
+			c.err = bc7Indices(block, c.q0, c.p0, c.q1, c.p1, c.indices);
+			if (c.err < best.err) best = c;
+		}
+	}
+
+	void encodeBC7Block(const unsigned char block[64], CompressionQuality quality, unsigned char* out)
+	{
+		float e0[4], e1[4];
+		initialEndpoints(block, 4, quality, e0, e1);
+		BC7Candidate best;
+		tryBC7Endpoints(block, e0, e1, quality, best);
+
+		int iterations = quality == COMPRESS_HIGH ? 2 : 0;
+		for (int iter = 0; iter < iterations && best.err > 0; iter++)
+		{
+			float weight[16];
+			for (int i = 0; i < 16; i++) weight[i] = BC7_WEIGHTS[best.indices[i]] / 64.0f;
+			if (!refineEndpoints(block, 4, weight, e0, e1)) break;
+			int before = best.err;
+			tryBC7Endpoints(block, e0, e1, quality, best);
+			if (best.err >= before) break;
+		}
+
+		// O índice do texel 0 tem só 3 bits: se passar de 7, troca os extremos e inverte os índices
+		if (best.indices[0] >= 8)
+		{
+			for (int c = 0; c < 4; c++) swap(best.q0[c], best.q1[c]);
+			swap(best.p0, best.p1);
+			for (int i = 0; i < 16; i++) best.indices[i] = (uint8_t)(15 - best.indices[i]);
+		}
+
+		BitWriter w;
+		w.put(1 << 6, 7); // Modo 6
+		for (int c = 0; c < 4; c++)
+		{
+			w.put(best.q0[c], 7);
+			w.put(best.q1[c], 7);
+		}
+		w.put(best.p0, 1);
+		w.put(best.p1, 1);
+		w.put(best.indices[0], 3);
+		for (int i = 1; i < 16; i++) w.put(best.indices[i], 4);
+		for (int k = 0; k < 16; k++) out[k] = (unsigned char)(w.bits[k >> 3] >> (8 * (k & 7)));
+	}
+
+	void decodeBC7Block(const unsigned char* in, unsigned char block[64])
+	{
+		BitReader r;
+		for (int k = 0; k < 16; k++) r.bits[k >> 3] |= (uint64_t)in[k] << (8 * (k & 7));
+		if (r.get(7) != (1 << 6))
+		{
+			// Outros modos não são gerados aqui: magenta, para aparecer no PSNR
+			for (int i = 0; i < 16; i++) { block[i * 4] = 255; block[i * 4 + 1] = 0; block[i * 4 + 2] = 255; block[i * 4 + 3] = 255; }
+			return;
+		}
+		int q0[4], q1[4];
+		for (int c = 0; c < 4; c++) { q0[c] = r.get(7); q1[c] = r.get(7); }
+		int p0 = r.get(1), p1 = r.get(1);
+		for (int i = 0; i < 16; i++)
+		{
+			int k = r.get(i == 0 ? 3 : 4);
+			for (int c = 0; c < 4; c++)
+			{
+				int a = (q0[c] << 1) | p0, b = (q1[c] << 1) | p1;
+				block[i * 4 + c] = (unsigned char)(((64 - BC7_WEIGHTS[k]) * a + BC7_WEIGHTS[k] * b + 32) >> 6);
+			}
+		}
+	}
+
+	// ---- Arquivo ------------------------------------------------------------------------------
+
+	template <typename T>
+	void append(vector<char>& data, const T& value)
+	{
+		data.insert(data.end(), (const char*)&value, (const char*)&value + sizeof(T));
+	}
+
+	template <typename T>
+	bool take(const char*& ptr, const char* end, T& value)
+	{
+		if ((size_t)(end - ptr) < sizeof(T)) return false;
+		memcpy(&value, ptr, sizeof(T));
+		ptr += sizeof(T);
+		return true;
+	}
+
+	bool readCookedTexture(const string& path, uint64_t sourceHash, TextureFormat requested, CompressionQuality quality, CookedTexture& cooked)
+	{
+		shared_ptr<MappedFile> mapped(new MappedFile(), [](MappedFile* m) { unmapFile(*m); delete m; });
+		if (!mapFile(path, *mapped)) return false;
+
+		// Só o cabeçalho é lido aqui; as páginas dos níveis são carregadas por quem copiar
+		const char* ptr = (const char*)mapped->data;
+		const char* end = ptr + mapped->size;
+		uint32_t magic, version, fileRequested, fileQuality, format, width, height, channels, levels;
+		uint64_t hash;
+		if (!take(ptr, end, magic) || !take(ptr, end, version) || !take(ptr, end, hash) ||
+			!take(ptr, end, fileRequested) || !take(ptr, end, fileQuality) || !take(ptr, end, format) ||
+			!take(ptr, end, width) || !take(ptr, end, height) || !take(ptr, end, channels) || !take(ptr, end, levels))
+			return false;
+		// Origem ou opções mudaram: recozinhar
+		if (magic != COOKED_TEXTURE_MAGIC || version != COOKED_TEXTURE_VERSION || hash != sourceHash ||
+			fileRequested != (uint32_t)requested || fileQuality != (uint32_t)quality)
+			return false;
+		// O cache é compartilhado: um arquivo truncado ou de outra versão não pode virar tamanhos absurdos
+		if (format > TEXTURE_BC7 || (channels != 3 && channels != 4) || width == 0 || height == 0 ||
+			width > TEXTURE_MAX_COOKED_SIZE || height > TEXTURE_MAX_COOKED_SIZE ||
+			levels == 0 || levels > (uint32_t)mipLevelCount((int)width, (int)height))
+			return false;
+
+		cooked.format = (TextureFormat)format;
+		cooked.width = (int)width;
+		cooked.height = (int)height;
+		cooked.channels = (int)channels;
+		cooked.offsets.assign(levels + 1, 0);
+		for (uint32_t l = 0; l <= levels; l++)
+		{
+			uint64_t offset;
+			if (!take(ptr, end, offset)) return false;
+			cooked.offsets[l] = (size_t)offset;
+		}
+		// Cada nível com exatamente o tamanho que o formato e as dimensões dão
+		if (cooked.offsets[0] != 0) return false;
+		for (uint32_t l = 0; l < levels; l++)
+		{
+			int w = max((int)width >> l, 1), h = max((int)height >> l, 1);
+			size_t expected = cooked.format == TEXTURE_UNCOMPRESSED ? (size_t)w * h * channels : compressedImageSize(cooked.format, w, h);
+			if (cooked.offsets[l + 1] < cooked.offsets[l] || cooked.offsets[l + 1] - cooked.offsets[l] != expected) return false;
+		}
+		if ((size_t)(end - ptr) < cooked.offsets[levels]) return false;
+		cooked.data.clear();
+		cooked.mapped = mapped;
+		cooked.mappedData = (const unsigned char*)ptr;
+		return true;
+	}
+
+	bool writeCookedTexture(const string& path, uint64_t sourceHash, TextureFormat requested, CompressionQuality quality, const CookedTexture& cooked)
+	{
+		vector<char> data;
+		append(data, COOKED_TEXTURE_MAGIC);
+		append(data, COOKED_TEXTURE_VERSION);
+		append(data, sourceHash);
+		append(data, (uint32_t)requested);
+		append(data, (uint32_t)quality);
+		append(data, (uint32_t)cooked.format);
+		append(data, (uint32_t)cooked.width);
+		append(data, (uint32_t)cooked.height);
+		append(data, (uint32_t)cooked.channels);
+		append(data, (uint32_t)cooked.levels());
+		for (size_t offset : cooked.offsets) append(data, (uint64_t)offset);
+		data.insert(data.end(), (const char*)cooked.pixels(), (const char*)cooked.pixels() + cooked.size());
+		return writeFileBytes(path, data);
+	}
+}
+
+TextureFormat parseTextureFormat(const string& name)
+{
+	if (name == "bc1") return TEXTURE_BC1;
+	if (name == "bc3") return TEXTURE_BC3;
+	if (name == "bc7") return TEXTURE_BC7;
+	if (name == "auto") return TEXTURE_AUTO;
+	return TEXTURE_UNCOMPRESSED;
+}
+
+CompressionQuality parseCompressionQuality(const string& name)
+{
+	if (name == "fast") return COMPRESS_FAST;
+	if (name == "high") return COMPRESS_HIGH;
+	return COMPRESS_NORMAL;
+}
+
+const char* textureFormatName(TextureFormat format)
+{
+	switch (format)
+	{
+	case TEXTURE_BC1: return "BC1";
+	case TEXTURE_BC3: return "BC3";
+	case TEXTURE_BC7: return "BC7";
+	case TEXTURE_AUTO: return "auto";
+	default: return "RGBA8";
+	}
+}
+
+GLenum compressedInternalFormat(TextureFormat format)
+{
+	switch (format)
+	{
+	case TEXTURE_BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	case TEXTURE_BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	case TEXTURE_BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+	default: return 0;
+	}
+}
+
+bool compressedFormatSupported(TextureFormat format)
+{
+	if (format == TEXTURE_UNCOMPRESSED) return true;
+
+	if (format == TEXTURE_AUTO) return compressedFormatSupported(TEXTURE_BC1) && compressedFormatSupported(TEXTURE_BC7);
+	if (format == TEXTURE_BC7 && glContextVersion() >= 42) return true; // BPTC é core no 4.2
+	return hasGLExtension(format == TEXTURE_BC7 ? "GL_ARB_texture_compression_bptc" : "GL_EXT_texture_compression_s3tc");
+}
+
+size_t compressedImageSize(TextureFormat format, int width, int height)
+{
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+}
+
+void compressImage(const unsigned char* rgba, int width, int height, TextureFormat format, CompressionQuality quality, unsigned char* out)
+{
+	int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+	int bytes = blockBytes(format);
+	parallelFor((size_t)blocksY, BLOCK_ROW_GRAIN, [&](size_t begin, size_t end)
+	{
+		unsigned char block[64];
+		for (size_t by = begin; by < end; by++)
+			for (int bx = 0; bx < blocksX; bx++)
+			{
+				fetchBlock(rgba, width, height, bx, (int)by, block);
+				unsigned char* dst = out + ((size_t)by * blocksX + bx) * bytes;
+				if (format == TEXTURE_BC1) encodeBC1Block(block, quality, dst);
+				else if (format == TEXTURE_BC3)
+				{
+					encodeAlphaBlock(block, dst);
+					encodeBC1Block(block, quality, dst + 8);
+				}
+				else encodeBC7Block(block, quality, dst);
+			}
+	}, "textura: compressao");
+}
+
+void decompressImage(const unsigned char* blocks, int width, int height, TextureFormat format, unsigned char* rgba)
+{
+	int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+	int bytes = blockBytes(format);
+	unsigned char block[64];
+	for (int by = 0; by < blocksY; by++)
+		for (int bx = 0; bx < blocksX; bx++)
+		{
+			const unsigned char* src = blocks + ((size_t)by * blocksX + bx) * bytes;
+			if (format == TEXTURE_BC1) decodeBC1Block(src, false, block);
+			else if (format == TEXTURE_BC3)
+			{
+				decodeBC1Block(src + 8, true, block);
+				decodeAlphaBlock(src, block);
+			}
+			else decodeBC7Block(src, block);
+			storeBlock(block, width, height, bx, by, rgba);
+		}
+}
+
+double imagePSNR(const unsigned char* a, const unsigned char* b, int width, int height, int channels)
+{
+	double sum = 0.0;
+	size_t texels = (size_t)width * height;
+	for (size_t i = 0; i < texels; i++)
+		for (int c = 0; c < channels; c++)
+		{
+			double d = (double)a[i * 4 + c] - b[i * 4 + c];
+			sum += d * d;
+		}
+	double mse = sum / ((double)texels * channels);
+	return mse <= 0.0 ? 99.0 : 10.0 * log10(255.0 * 255.0 / mse);
+}
+
+void cookTexture(const unsigned char* rgbaChain, const vector<size_t>& offsets, int width, int height, int channels,
+	TextureFormat format, CompressionQuality quality, CookedTexture& cooked)
+{
+	// Automático: sem alfa (ou com alfa todo opaco) cabe em BC1, a 4 bits por texel
+	if (format == TEXTURE_AUTO)
+	{
+		bool opaque = true;
+		for (size_t i = 3; i < offsets[1] && opaque; i += 4) opaque = rgbaChain[i] == 255;
+		format = opaque ? TEXTURE_BC1 : TEXTURE_BC7;
+	}
+
+	int levels = (int)offsets.size() - 1;
+	cooked.format = format;
+	cooked.width = width;
+	cooked.height = height;
+	cooked.channels = channels;
+	cooked.offsets.assign(levels + 1, 0);
+	for (int l = 0; l < levels; l++)
+		cooked.offsets[l + 1] = cooked.offsets[l] + compressedImageSize(format, max(width >> l, 1), max(height >> l, 1));
+	cooked.data.resize(cooked.offsets[levels]);
+
+	for (int l = 0; l < levels; l++)
+		compressImage(rgbaChain + offsets[l], max(width >> l, 1), max(height >> l, 1), format, quality, &cooked.data[cooked.offsets[l]]);
+}
+
+bool loadCookedTexture(const string& sourcePath, uint64_t sourceHash, TextureFormat requested, CompressionQuality quality, CookedTexture& cooked)
+{
+	return readCookedTexture(cachePath(sourcePath, "ctex"), sourceHash, requested, quality, cooked);
+}
+
+void saveCookedTexture(const string& sourcePath, uint64_t sourceHash, TextureFormat requested, CompressionQuality quality, const CookedTexture& cooked)
+{
+	if (!writeCookedTexture(cachePath(sourcePath, "ctex"), sourceHash, requested, quality, cooked))
+		cout << "Aviso: nao foi possivel salvar a textura cozida de " << sourcePath << endl;
+}
+
+void benchmarkTextureCompression(const string& modelsDir)
+{
+	vector<string> files = listFiles(modelsDir, { ".png", ".jpg", ".jpeg" });
+	sort(files.begin(), files.end());
+
+	cout << fixed << setprecision(2);
+	cout << "==== Compressao de texturas (" << files.size() << " imagens em " << modelsDir << ", " << jobWorkerCount() << " threads) ====" << endl;
+
+	const TextureFormat formats[] = { TEXTURE_BC1, TEXTURE_BC3, TEXTURE_BC7 };
+	size_t totalRaw = 0, totalCompressed[3] = { 0, 0, 0 };
+	for (const string& path : files)
+	{
+		vector<char> file;
+		if (!readFileBytes(path, file)) continue;
+		uint64_t hash = hashBytes(file.data(), file.size());
+
+		// Carregamento de hoje: decodificar e montar os mipmaps
+		auto start = chrono::high_resolution_clock::now();
+		int width, height, channels;
+		unsigned char* data = stbi_load_from_memory((const stbi_uc*)file.data(), (int)file.size(), &width, &height, &channels, 4);
+		if (!data) continue;
+		vector<unsigned char> chain(data, data + (size_t)width * height * 4);
+		stbi_image_free(data);
+		vector<size_t> offsets;
+		buildMipChain(chain, offsets, width, height, 4);
+		double decodeMs = elapsedMs(start);
+
+		bool hasAlpha = false;
+		for (size_t i = 3; i < offsets[1] && !hasAlpha; i += 4) hasAlpha = chain[i] != 255;
+		size_t raw = chain.size(); // RGBA8 com mipmaps, como fica na GPU
+		totalRaw += raw;
+
+		cout << path << " (" << width << "x" << height << (hasAlpha ? ", com alfa" : "") << "): RGBA8 "
+			<< raw / (1024.0 * 1024.0) << " MB, decodificar + mipmaps " << decodeMs << " ms" << endl;
+
+		vector<unsigned char> decoded((size_t)width * height * 4);
+		for (int f = 0; f < 3; f++)
+		{
+			CookedTexture cooked;
+			start = chrono::high_resolution_clock::now();
+			cookTexture(chain.data(), offsets, width, height, channels, formats[f], COMPRESS_NORMAL, cooked);
+			double cookMs = elapsedMs(start);
+
+			string benchPath = cachePath(path, "bench.ctex");
+			writeCookedTexture(benchPath, hash, formats[f], COMPRESS_NORMAL, cooked);
+			// Carregamento cozido: mapear o arquivo e copiar os níveis (como a cópia para o PBO)
+			vector<unsigned char> staging(cooked.size());
+			double loadMs;
+			bool ok;
+			{
+				CookedTexture loaded;
+				start = chrono::high_resolution_clock::now();
+				ok = readCookedTexture(benchPath, hash, formats[f], COMPRESS_NORMAL, loaded);
+				if (ok) memcpy(staging.data(), loaded.pixels(), loaded.size());
+				loadMs = elapsedMs(start);
+			}
+			remove(benchPath.c_str());
+
+			decompressImage(cooked.data.data(), width, height, formats[f], decoded.data());
+			double psnr = imagePSNR(chain.data(), decoded.data(), width, height, hasAlpha ? 4 : 3);
+			totalCompressed[f] += cooked.data.size();
+
+			cout << "  " << textureFormatName(formats[f]) << ": " << cooked.data.size() / (1024.0 * 1024.0) << " MB ("
+				<< (double)raw / cooked.data.size() << "x menor), compressao " << cookMs << " ms, carregamento "
+				<< (ok ? loadMs : -1.0) << " ms (" << decodeMs / loadMs << "x), PSNR " << psnr << " dB" << endl;
+		}
+	}
+
+	if (totalRaw > 0)
+	{
+		cout << "Total: RGBA8 " << totalRaw / (1024.0 * 1024.0) << " MB";
+		for (int f = 0; f < 3; f++)
+			cout << ", " << textureFormatName(formats[f]) << " " << totalCompressed[f] / (1024.0 * 1024.0) << " MB";
+		cout << endl;
+	}
+	cout << defaultfloat;
+}
@@ -0,0 +1,96 @@
+// Compressão de texturas em blocos (BC1, BC3 e BC7) e o arquivo de textura cozida
+//
+// Cada bloco de 4x4 texels é codificado de forma independente, então a imagem é dividida em
+// faixas de blocos entre as threads do sistema de jobs. Os codificadores procuram os extremos
+// pelo eixo principal das cores do bloco (ou pela caixa, no preset rápido), quantizam e escolhem
+// o índice mais próximo de cada texel; os presets melhores refinam os extremos por mínimos
+// quadrados. Do BC7 só é usado o modo 6 (um subconjunto, RGBA 7.7.7.7 + p-bit, índices de 4 bits),
+// que cobre bem texturas sem bordas de cor bruscas dentro do bloco.
+//
+// A textura cozida (./cache/<imagem>-<hash>.ctex) guarda todos os níveis já comprimidos (ou, sem
+// compressão, os pixels crus com os mipmaps prontos), o hash da imagem de origem e o formato pedido.
+// O arquivo é mapeado na memória e os níveis vão para a GPU direto dele, sem decodificar nada.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+//GLAD
+#include <glad/glad.h>
+
+// Enums das extensões (o GLAD do projeto vai até o GL 4.0)
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+
+enum TextureFormat
+{
+	TEXTURE_UNCOMPRESSED, // RGB8 ou RGBA8, conforme a imagem
+	TEXTURE_BC1,          // RGB, 8 bytes por bloco
+	TEXTURE_BC3,          // RGBA (alfa separado), 16 bytes por bloco
+	TEXTURE_BC7,          // RGBA, 16 bytes por bloco
+	TEXTURE_AUTO          // Pedido: BC1 se a imagem é opaca, BC7 se tem alfa
+};
+
+enum CompressionQuality
+{
+	COMPRESS_FAST,   // Extremos pela caixa do bloco
+	COMPRESS_NORMAL, // Eixo principal, todas as combinações de p-bits e um refinamento no BC1
+	COMPRESS_HIGH    // Mais refinamentos por mínimos quadrados (também no BC7)
+};
+
+TextureFormat parseTextureFormat(const std::string& name);
+CompressionQuality parseCompressionQuality(const std::string& name);
+const char* textureFormatName(TextureFormat format);
+
+// Formato interno do GL (0 para TEXTURE_UNCOMPRESSED)
+GLenum compressedInternalFormat(TextureFormat format);
+// Consulta as extensões do contexto atual (S3TC para BC1/BC3, BPTC para BC7)
+bool compressedFormatSupported(TextureFormat format);
+
+size_t compressedImageSize(TextureFormat format, int width, int height);
+// rgba: width * height texels de 4 bytes. Divide as faixas de blocos entre as threads
+void compressImage(const unsigned char* rgba, int width, int height, TextureFormat format, CompressionQuality quality, unsigned char* out);
+// Inverso, para medir o erro (o BC7 só no modo 6)
+void decompressImage(const unsigned char* blocks, int width, int height, TextureFormat format, unsigned char* rgba);
+// PSNR em dB entre duas imagens RGBA (channels = 3 ignora o alfa)
+double imagePSNR(const unsigned char* a, const unsigned char* b, int width, int height, int channels);
+
+struct MappedFile;
+
+struct CookedTexture
+{
+	TextureFormat format = TEXTURE_UNCOMPRESSED;
+	int width = 0, height = 0;
+	int channels = 0;                    // Da imagem de origem (e dos pixels, sem compressão)
+	std::vector<unsigned char> data;     // Níveis, do 0 ao último, quando cozidos agora
+	std::shared_ptr<MappedFile> mapped;  // Ou o arquivo lido do cache, mapeado
+	const unsigned char* mappedData = nullptr;
+	std::vector<size_t> offsets;         // levels + 1 valores
+
+	int levels() const { return offsets.empty() ? 0 : (int)offsets.size() - 1; }
+	const unsigned char* pixels() const { return mapped ? mappedData : data.data(); }
+	size_t size() const { return offsets.empty() ? 0 : offsets.back(); }
+};
+
+// Comprime a cadeia de mipmaps RGBA (níveis contíguos em offsets) no formato pedido
+void cookTexture(const unsigned char* rgbaChain, const std::vector<size_t>& offsets, int width, int height, int channels,
+	TextureFormat format, CompressionQuality quality, CookedTexture& cooked);
+// Mapeia o arquivo (os níveis ficam em cooked.pixels()). Falha (para recozinhar) se a origem ou as
+// opções mudaram
+bool loadCookedTexture(const std::string& sourcePath, uint64_t sourceHash, TextureFormat requested, CompressionQuality quality, CookedTexture& cooked);
+void saveCookedTexture(const std::string& sourcePath, uint64_t sourceHash, TextureFormat requested, CompressionQuality quality, const CookedTexture& cooked);
+
+// Para cada imagem de Modelos3D: VRAM, tempo de carregamento (decodificar + mipmaps contra ler a
+// cozida), tempo de compressão e PSNR do nível 0 em BC1, BC3 e BC7
+void benchmarkTextureCompression(const std::string& modelsDir);
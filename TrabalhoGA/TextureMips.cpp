@@ -0,0 +1,494 @@
+#include "TextureMips.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+//STB_IMAGE
+#include <stb_image.h>
+
+#include "Cache.h"
+#include "Jobs.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIP_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__AVX__)
+#define MIP_AVX
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+	const float PI = 3.14159265358979f;
+	const int SRGB_ENCODE_SIZE = 4096; // Entradas da tabela linear -> sRGB
+	const float KAISER_ALPHA = 4.0f;
+	const float FILTER_RADIUS = 3.0f;  // Kaiser e Lanczos, em texels de saída
+
+	double elapsedMs(chrono::high_resolution_clock::time_point start)
+	{
+		return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+	}
+
+	inline int levelSize(int size, int level) { return max(size >> level, 1); }
+
+	// Tabelas de conversão entre sRGB de 8 bits e linear, montadas uma vez
+	struct SrgbTables
+	{
+		float decode[256];
+		unsigned char encode[SRGB_ENCODE_SIZE];
+
+		SrgbTables()
+		{
+			for (int i = 0; i < 256; i++)
+			{
+				float c = i / 255.0f;
+				decode[i] = c <= 0.04045f ? c / 12.92f : pow((c + 0.055f) / 1.055f, 2.4f);
+			}
+			for (int i = 0; i < SRGB_ENCODE_SIZE; i++)
+			{
+				float l = i / (float)(SRGB_ENCODE_SIZE - 1);
+				float c = l <= 0.0031308f ? l * 12.92f : 1.055f * pow(l, 1.0f / 2.4f) - 0.055f;
+				encode[i] = (unsigned char)min(max((int)(c * 255.0f + 0.5f), 0), 255);
+			}
+		}
+	};
+
+	const SrgbTables& srgbTables()
+	{
+		static SrgbTables tables;
+		return tables;
+	}
+
+	float sinc(float x)
+	{
+		if (fabs(x) < 1e-6f) return 1.0f;
+		x *= PI;
+		return sin(x) / x;
+	}
+
+	float besselI0(float x)
+	{
+		float sum = 1.0f, term = 1.0f;
+		for (int k = 1; k < 20; k++)
+		{
+			float t = x / (2.0f * k);
+			term *= t * t;
+			sum += term;
+		}
+		return sum;
+	}
+
+	// Peso a uma distância d (em texels de saída) do centro
+	float filterWeight(MipFilter filter, float d)
+	{
+		if (fabs(d) >= FILTER_RADIUS) return 0.0f;
+		if (filter == MIP_LANCZOS) return sinc(d) * sinc(d / FILTER_RADIUS);
+		float t = d / FILTER_RADIUS;
+		return sinc(d) * besselI0(KAISER_ALPHA * sqrt(1.0f - t * t)) / besselI0(KAISER_ALPHA);
+	}
+
+	// Pesos de um eixo: para cada texel de saída, os texels de origem (com repetição nas bordas,
+	// como o GL_REPEAT das texturas) e os pesos normalizados
+	struct MipTaps
+	{
+		vector<int> first, count; // Por texel de saída, em index/weight
+		vector<int> index;
+		vector<float> weight;
+	};
+
+	MipTaps buildTaps(int srcSize, int dstSize, MipFilter filter)
+	{
+		MipTaps taps;
+		float scale = srcSize / (float)dstSize;
+		for (int o = 0; o < dstSize; o++)
+		{
+			float center = (o + 0.5f) * scale;
+			float lo, hi;
+			if (filter == MIP_BOX) { lo = center - scale * 0.5f; hi = center + scale * 0.5f; }
+			else { lo = center - FILTER_RADIUS * scale; hi = center + FILTER_RADIUS * scale; }
+
+			int first = (int)taps.index.size();
+			float sum = 0.0f;
+			for (int i = (int)floor(lo); i < (int)ceil(hi); i++)
+			{
+				float w = filter == MIP_BOX ? min(hi, i + 1.0f) - max(lo, (float)i) : filterWeight(filter, (i + 0.5f - center) / scale);
+				if (fabs(w) < 1e-6f) continue;
+				taps.index.push_back(((i % srcSize) + srcSize) % srcSize);
+				taps.weight.push_back(w);
+				sum += w;
+			}
+			for (size_t k = first; k < taps.weight.size(); k++) taps.weight[k] /= sum;
+			taps.first.push_back(first);
+			taps.count.push_back((int)taps.index.size() - first);
+		}
+		return taps;
+	}
+
+	// dst += w * src, em n floats
+	inline void accumulateRow(float* dst, const float* src, float w, size_t n, bool simd)
+	{
+		size_t i = 0;
+		if (simd)
+		{
+#ifdef MIP_AVX
+			__m256 w8 = _mm256_set1_ps(w);
+			for (; i + 8 <= n; i += 8)
+				_mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(w8, _mm256_loadu_ps(src + i))));
+#endif
+#ifdef MIP_SSE2
+			__m128 w4 = _mm_set1_ps(w);
+			for (; i + 4 <= n; i += 4)
+				_mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(w4, _mm_loadu_ps(src + i))));
+#endif
+		}
+		for (; i < n; i++) dst[i] += w * src[i];
+	}
+
+	// Um texel RGBA de saída a partir da linha filtrada na vertical
+	inline void filterTexel(float* dst, const float* row, const int* index, const float* weight, int count, bool simd)
+	{
+#ifdef MIP_SSE2
+		if (simd)
+		{
+			__m128 acc = _mm_setzero_ps();
+			for (int k = 0; k < count; k++)
+				acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weight[k]), _mm_loadu_ps(row + 4 * index[k])));
+			_mm_storeu_ps(dst, acc);
+			return;
+		}
+#endif
+		float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (int k = 0; k < count; k++)
+			for (int c = 0; c < 4; c++) acc[c] += weight[k] * row[4 * index[k] + c];
+		memcpy(dst, acc, sizeof(acc));
+	}
+
+	// Nível 0 em RGBA float (linear nas cores, se sRGB)
+	void decodeLevel(const unsigned char* src, int width, int height, int channels, bool srgb, float* dst)
+	{
+		const SrgbTables& tables = srgbTables();
+		parallelFor((size_t)height, max<size_t>(1, 16384 / width), [&](size_t begin, size_t end)
+		{
+			for (size_t y = begin; y < end; y++)
+				for (int x = 0; x < width; x++)
+				{
+					const unsigned char* s = src + (y * width + x) * channels;
+					float* d = dst + (y * width + x) * 4;
+					for (int c = 0; c < 3; c++) d[c] = srgb ? tables.decode[s[c]] : s[c] / 255.0f;
+					d[3] = channels == 4 ? s[3] / 255.0f : 1.0f;
+				}
+		}, "mipmaps: decodificacao");
+	}
+
+	// Um nível a partir do anterior, separável, com as linhas de saída divididas entre as threads
+	void filterLevel(const float* src, int sw, int sh, float* dst, int w, int h, MipFilter filter, bool simd)
+	{
+		MipTaps horizontal = buildTaps(sw, w, filter), vertical = buildTaps(sh, h, filter);
+		parallelFor((size_t)h, max<size_t>(1, 8192 / sw), [&](size_t begin, size_t end)
+		{
+			vector<float> row((size_t)sw * 4);
+			for (size_t y = begin; y < end; y++)
+			{
+				fill(row.begin(), row.end(), 0.0f);
+				for (int k = 0; k < vertical.count[y]; k++)
+				{
+					int t = vertical.first[y] + k;
+					accumulateRow(row.data(), src + (size_t)vertical.index[t] * sw * 4, vertical.weight[t], row.size(), simd);
+				}
+				for (int x = 0; x < w; x++)
+				{
+					int t = horizontal.first[x];
+					filterTexel(dst + ((size_t)y * w + x) * 4, row.data(), &horizontal.index[t], &horizontal.weight[t], horizontal.count[x], simd);
+				}
+			}
+		}, "mipmaps: filtro");
+	}
+
+	// Caixa com as duas dimensões pares: média direta de 2x2 texels, sem a tabela de pesos
+	void boxLevel(const float* src, int sw, float* dst, int w, int h, bool simd)
+	{
+		parallelFor((size_t)h, max<size_t>(1, 8192 / sw), [&](size_t begin, size_t end)
+		{
+			for (size_t y = begin; y < end; y++)
+			{
+				const float* row0 = src + 2 * y * sw * 4;
+				const float* row1 = row0 + (size_t)sw * 4;
+				float* out = dst + y * w * 4;
+				int x = 0;
+#ifdef MIP_SSE2
+				if (simd)
+				{
+					__m128 quarter = _mm_set1_ps(0.25f);
+					for (; x < w; x++)
+					{
+						__m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(row0 + 8 * x), _mm_loadu_ps(row0 + 8 * x + 4)),
+							_mm_add_ps(_mm_loadu_ps(row1 + 8 * x), _mm_loadu_ps(row1 + 8 * x + 4)));
+						_mm_storeu_ps(out + 4 * x, _mm_mul_ps(sum, quarter));
+					}
+				}
+#endif
+				for (; x < w; x++)
+					for (int c = 0; c < 4; c++)
+						out[4 * x + c] = 0.25f * (row0[8 * x + c] + row0[8 * x + 4 + c] + row1[8 * x + c] + row1[8 * x + 4 + c]);
+			}
+		}, "mipmaps: caixa");
+	}
+
+	// O mesmo para o nível 1, lendo o nível 0 em bytes (sem converter a imagem inteira para float antes)
+	void boxLevelFromBytes(const unsigned char* src, int sw, int channels, bool srgb, float* dst, int w, int h)
+	{
+		const SrgbTables& tables = srgbTables();
+		parallelFor((size_t)h, max<size_t>(1, 8192 / sw), [&](size_t begin, size_t end)
+		{
+			for (size_t y = begin; y < end; y++)
+			{
+				const unsigned char* row0 = src + 2 * y * sw * channels;
+				const unsigned char* row1 = row0 + (size_t)sw * channels;
+				float* out = dst + y * w * 4;
+				for (int x = 0; x < w; x++)
+				{
+					const unsigned char* t[4] = { row0 + 2 * x * channels, row0 + (2 * x + 1) * channels, row1 + 2 * x * channels, row1 + (2 * x + 1) * channels };
+					for (int c = 0; c < 3; c++)
+						out[4 * x + c] = 0.25f * (srgb ? tables.decode[t[0][c]] + tables.decode[t[1][c]] + tables.decode[t[2][c]] + tables.decode[t[3][c]]
+							: (t[0][c] + t[1][c] + t[2][c] + t[3][c]) / 255.0f);
+					out[4 * x + 3] = channels == 4 ? (t[0][3] + t[1][3] + t[2][3] + t[3][3]) / (4.0f * 255.0f) : 1.0f;
+				}
+			}
+		}, "mipmaps: caixa");
+	}
+
+	// Volta para 8 bits (channels por texel), com o alfa escalado para manter a cobertura
+	void encodeLevel(const float* src, int width, int height, int channels, bool srgb, float alphaScale, bool simd, unsigned char* dst)
+	{
+		const SrgbTables& tables = srgbTables();
+		float colorRange = srgb ? SRGB_ENCODE_SIZE - 1.0f : 255.0f;
+		parallelFor((size_t)height, max<size_t>(1, 16384 / width), [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin * width; i < end * width; i++)
+			{
+				int q[4];
+#ifdef MIP_SSE2
+				if (simd)
+				{
+					__m128 v = _mm_mul_ps(_mm_loadu_ps(src + i * 4), _mm_setr_ps(1.0f, 1.0f, 1.0f, alphaScale));
+					v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+					v = _mm_add_ps(_mm_mul_ps(v, _mm_setr_ps(colorRange, colorRange, colorRange, 255.0f)), _mm_set1_ps(0.5f));
+					_mm_storeu_si128((__m128i*)q, _mm_cvttps_epi32(v));
+				}
+				else
+#endif
+				{
+					for (int c = 0; c < 4; c++)
+					{
+						float v = src[i * 4 + c] * (c == 3 ? alphaScale : 1.0f);
+						q[c] = (int)(min(max(v, 0.0f), 1.0f) * (c == 3 ? 255.0f : colorRange) + 0.5f);
+					}
+				}
+				unsigned char* d = dst + i * channels;
+				for (int c = 0; c < 3; c++) d[c] = srgb ? tables.encode[q[c]] : (unsigned char)q[c];
+				if (channels == 4) d[3] = (unsigned char)q[3];
+			}
+		}, "mipmaps: quantizacao");
+	}
+
+	float alphaCoverage(const float* level, size_t texels, float cutoff, float scale)
+	{
+		size_t covered = 0;
+		for (size_t i = 0; i < texels; i++)
+			if (level[i * 4 + 3] * scale > cutoff) covered++;
+		return covered / (float)texels;
+	}
+
+	// Escala do alfa que leva a cobertura do nível à do nível 0, a mais perto de 1 (busca binária; a
+	// cobertura cresce com a escala): se falta cobertura, a menor escala acima de 1 que a alcança; se
+	// sobra, a maior abaixo de 1 que não passa dela. Assim o alfa muda o mínimo, e um nível que já
+	// tem a cobertura certa fica como está
+	float coverageScale(const float* level, size_t texels, float cutoff, float target)
+	{
+		float current = alphaCoverage(level, texels, cutoff, 1.0f);
+		if (current == target) return 1.0f;
+
+		bool grow = current < target;
+		float lo = grow ? 1.0f : 0.0f, hi = grow ? 4.0f : 1.0f;
+		for (int iter = 0; iter < 12; iter++)
+		{
+			float mid = 0.5f * (lo + hi);
+			float c = alphaCoverage(level, texels, cutoff, mid);
+			if (grow ? c < target : c <= target) lo = mid;
+			else hi = mid;
+		}
+		return grow ? hi : lo;
+	}
+
+	// A geração anterior, para o benchmark: média 2x2 dos bytes, sem converter a gama
+	void gammaBoxChain(vector<unsigned char>& pixels, vector<size_t>& offsets, int width, int height, int c)
+	{
+		int levels = mipLevelCount(width, height);
+		offsets.assign(levels + 1, 0);
+		for (int l = 0; l < levels; l++)
+			offsets[l + 1] = offsets[l] + (size_t)levelSize(width, l) * levelSize(height, l) * c;
+		pixels.resize(offsets[levels]);
+		for (int l = 1; l < levels; l++)
+		{
+			int sw = levelSize(width, l - 1), sh = levelSize(height, l - 1);
+			int w = levelSize(width, l), h = levelSize(height, l);
+			const unsigned char* src = &pixels[offsets[l - 1]];
+			unsigned char* dst = &pixels[offsets[l]];
+			for (int y = 0; y < h; y++)
+			{
+				const unsigned char* row0 = src + (size_t)min(2 * y, sh - 1) * sw * c;
+				const unsigned char* row1 = src + (size_t)min(2 * y + 1, sh - 1) * sw * c;
+				for (int x = 0; x < w; x++)
+				{
+					int x0 = min(2 * x, sw - 1) * c, x1 = min(2 * x + 1, sw - 1) * c;
+					for (int k = 0; k < c; k++)
+						dst[((size_t)y * w + x) * c + k] = (unsigned char)((row0[x0 + k] + row0[x1 + k] + row1[x0 + k] + row1[x1 + k] + 2) >> 2);
+				}
+			}
+		}
+	}
+}
+
+MipFilter parseMipFilter(const string& name)
+{
+	if (name == "kaiser") return MIP_KAISER;
+	if (name == "lanczos") return MIP_LANCZOS;
+	return MIP_BOX;
+}
+
+const char* mipFilterName(MipFilter filter)
+{
+	switch (filter)
+	{
+	case MIP_KAISER: return "kaiser";
+	case MIP_LANCZOS: return "lanczos";
+	default: return "box";
+	}
+}
+
+uint64_t mipSettingsHash(const MipSettings& settings, uint64_t seed)
+{
+	uint32_t filter = (uint32_t)settings.filter, srgb = settings.srgb ? 1 : 0;
+	uint64_t hash = hashBytes(&filter, sizeof(filter), seed);
+	hash = hashBytes(&srgb, sizeof(srgb), hash);
+	return hashBytes(&settings.alphaCutoff, sizeof(settings.alphaCutoff), hash);
+}
+
+int mipLevelCount(int width, int height)
+{
+	int levels = 1;
+	while (width > 1 || height > 1)
+	{
+		width = max(width / 2, 1);
+		height = max(height / 2, 1);
+		levels++;
+	}
+	return levels;
+}
+
+void buildMipChain(vector<unsigned char>& pixels, vector<size_t>& offsets, int width, int height, int channels, const MipSettings& settings)
+{
+	int levels = mipLevelCount(width, height);
+	offsets.assign(levels + 1, 0);
+	for (int l = 0; l < levels; l++)
+		offsets[l + 1] = offsets[l] + (size_t)levelSize(width, l) * levelSize(height, l) * channels;
+	pixels.resize(offsets[levels]);
+	if (levels == 1) return;
+
+	bool coverage = channels == 4 && settings.alphaCutoff > 0.0f;
+	float targetCoverage = 0.0f;
+	if (coverage)
+	{
+		size_t covered = 0, texels = (size_t)width * height;
+		for (size_t i = 0; i < texels; i++)
+			if (pixels[i * 4 + 3] / 255.0f > settings.alphaCutoff) covered++;
+		targetCoverage = covered / (float)texels;
+		// Tudo opaco ou tudo transparente: a média mantém a cobertura, não há o que corrigir
+		coverage = covered > 0 && covered < texels;
+	}
+
+	// Dois níveis em float por vez: o anterior (origem) e o atual. A caixa com dimensões pares
+	// parte direto dos bytes do nível 0
+	auto evenBox = [&](int sw, int sh, int w, int h) { return settings.filter == MIP_BOX && sw == 2 * w && sh == 2 * h; };
+	bool fromBytes = evenBox(width, height, levelSize(width, 1), levelSize(height, 1));
+	size_t level1 = (size_t)levelSize(width, 1) * levelSize(height, 1) * 4;
+	vector<float> src(fromBytes ? level1 : (size_t)width * height * 4), dst(level1);
+	if (!fromBytes) decodeLevel(pixels.data(), width, height, channels, settings.srgb, src.data());
+
+	for (int l = 1; l < levels; l++)
+	{
+		int sw = levelSize(width, l - 1), sh = levelSize(height, l - 1);
+		int w = levelSize(width, l), h = levelSize(height, l);
+		if (l == 1 && fromBytes) boxLevelFromBytes(pixels.data(), sw, channels, settings.srgb, dst.data(), w, h);
+		else if (evenBox(sw, sh, w, h)) boxLevel(src.data(), sw, dst.data(), w, h, settings.simd);
+		else filterLevel(src.data(), sw, sh, dst.data(), w, h, settings.filter, settings.simd);
+
+		// O alfa escalado vai só para a saída; o próximo nível é filtrado do alfa original
+		float alphaScale = coverage ? coverageScale(dst.data(), (size_t)w * h, settings.alphaCutoff, targetCoverage) : 1.0f;
+		encodeLevel(dst.data(), w, h, channels, settings.srgb, alphaScale, settings.simd, &pixels[offsets[l]]);
+		src.swap(dst);
+	}
+}
+
+void benchmarkMipGeneration(const string& modelsDir)
+{
+	vector<string> files = listFiles(modelsDir, { ".png", ".jpg", ".jpeg" });
+	sort(files.begin(), files.end());
+
+	cout << fixed << setprecision(2);
+	cout << "==== Geracao de mipmaps (" << files.size() << " imagens, " << jobWorkerCount() << " threads"
+#ifdef MIP_AVX
+		<< ", AVX"
+#elif defined(MIP_SSE2)
+		<< ", SSE2"
+#endif
+		<< ") ====" << endl;
+
+	double totals[5] = { 0, 0, 0, 0, 0 };
+	for (const string& path : files)
+	{
+		int width, height, channels;
+		unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 0);
+		if (!data) continue;
+		channels = channels == 3 ? 3 : 4;
+		stbi_image_free(data);
+		data = stbi_load(path.c_str(), &width, &height, nullptr, channels);
+		vector<unsigned char> base(data, data + (size_t)width * height * channels);
+		stbi_image_free(data);
+
+		double ms[5];
+		vector<unsigned char> pixels;
+		vector<size_t> offsets;
+
+		pixels = base;
+		auto start = chrono::high_resolution_clock::now();
+		gammaBoxChain(pixels, offsets, width, height, channels);
+		ms[0] = elapsedMs(start);
+
+		MipSettings settings;
+		const MipFilter filters[4] = { MIP_BOX, MIP_BOX, MIP_KAISER, MIP_LANCZOS };
+		for (int k = 0; k < 4; k++)
+		{
+			settings.filter = filters[k];
+			settings.simd = k != 0;
+			pixels = base;
+			start = chrono::high_resolution_clock::now();
+			buildMipChain(pixels, offsets, width, height, channels, settings);
+			ms[k + 1] = elapsedMs(start);
+		}
+		for (int k = 0; k < 5; k++) totals[k] += ms[k];
+
+		cout << path << " (" << width << "x" << height << "x" << channels << "): gama 2x2 " << ms[0] << " ms, linear box escalar "
+			<< ms[1] << " ms, SIMD " << ms[2] << " ms (" << ms[1] / ms[2] << "x), kaiser " << ms[3] << " ms, lanczos " << ms[4] << " ms" << endl;
+	}
+	cout << "Total: gama 2x2 " << totals[0] << " ms, linear box escalar " << totals[1] << " ms, SIMD " << totals[2]
+		<< " ms, kaiser " << totals[3] << " ms, lanczos " << totals[4] << " ms" << endl;
+	cout << defaultfloat;
+}
@@ -0,0 +1,50 @@
+// Geração da cadeia de mipmaps na CPU, usada no carregamento das texturas e no cozimento
+//
+// Cada nível é filtrado a partir do anterior em ponto flutuante, em espaço linear quando as cores
+// estão em sRGB (a média de valores com gama escurece e desloca as cores dos mipmaps), e só então
+// quantizado de volta para 8 bits. O filtro é separável: uma passada vertical acumula as linhas de
+// origem numa linha temporária e a horizontal aplica os pesos de cada texel de saída, com um texel
+// RGBA por registrador SSE (e 2 texels por registrador AVX na vertical, quando compilado com AVX).
+// As linhas de saída de cada nível são divididas entre as threads do sistema de jobs.
+//
+// Em recortes (folhas, grades) o teste de alfa faz a cobertura cair nos níveis menores e o objeto
+// "some" de longe; com alphaCutoff o alfa de cada nível é escalado para manter a fração de texels
+// acima do corte igual à do nível 0.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+enum MipFilter
+{
+	MIP_BOX,     // Média da área de cada texel de saída (2x2 nas dimensões pares)
+	MIP_KAISER,  // Sinc com janela de Kaiser (raio de 3 texels de saída, alfa 4)
+	MIP_LANCZOS  // Lanczos 3
+};
+
+struct MipSettings
+{
+	MipFilter filter = MIP_BOX;
+	bool srgb = true;         // Cores em sRGB: filtra em espaço linear (o alfa é sempre linear)
+	float alphaCutoff = 0.0f; // > 0: preserva a cobertura do teste de alfa com esse corte
+	bool simd = true;         // false só para comparação no benchmark
+};
+
+MipFilter parseMipFilter(const std::string& name);
+const char* mipFilterName(MipFilter filter);
+// Combina as opções ao hash da imagem de origem, para invalidar as texturas cozidas com outras opções
+uint64_t mipSettingsHash(const MipSettings& settings, uint64_t seed);
+
+int mipLevelCount(int width, int height);
+
+// Completa pixels (o nível 0, com width * height * channels bytes, channels = 3 ou 4) com os outros
+// níveis; offsets recebe o início de cada nível (levels + 1 valores)
+void buildMipChain(std::vector<unsigned char>& pixels, std::vector<size_t>& offsets, int width, int height, int channels,
+	const MipSettings& settings = MipSettings());
+
+// Tempo de geração dos mipmaps de cada imagem de Modelos3D: a média 2x2 com gama de antes, a caixa
+// em espaço linear escalar e SIMD, Kaiser e Lanczos
+void benchmarkMipGeneration(const std::string& modelsDir);
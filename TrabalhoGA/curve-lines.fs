@@ -0,0 +1,19 @@
+#version 430
+
+in vec2 fragPixel;
+flat in vec2 startPixel;
+flat in vec2 endPixel;
+flat in float halfWidth;
+flat in vec4 lineColor;
+
+out vec4 color;
+
+void main()
+{
+	// Distância em pixels até o segmento: fora da cápsula de raio halfWidth é descartado
+	vec2 ab = endPixel - startPixel;
+	float h = clamp(dot(fragPixel - startPixel, ab) / max(dot(ab, ab), 1e-6), 0.0, 1.0);
+	if (length(fragPixel - startPixel - ab * h) > halfWidth)
+		discard;
+	color = lineColor;
+}
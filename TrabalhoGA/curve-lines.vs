@@ -0,0 +1,59 @@
+#version 430
+// Uma instância por segmento: pointA e pointB são o mesmo buffer de pontos, deslocado de um ponto.
+// w = estilo do segmento que começa no ponto (negativo: fim de poligonal, sem segmento)
+layout (location = 0) in vec4 pointA;
+layout (location = 1) in vec4 pointB;
+
+const int MAX_STYLES = 8;
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform vec2 viewport;
+uniform vec4 styleColor[MAX_STYLES];
+uniform float styleWidth[MAX_STYLES]; // Pixels
+
+out vec2 fragPixel;
+flat out vec2 startPixel;
+flat out vec2 endPixel;
+flat out float halfWidth;
+flat out vec4 lineColor;
+
+void main()
+{
+	int style = int(pointA.w);
+	vec4 clipA = projection * view * vec4(pointA.xyz, 1.0);
+	vec4 clipB = projection * view * vec4(pointB.xyz, 1.0);
+
+	// Recorta no plano próximo antes de dividir por w; inteiro atrás da câmera não desenha
+	const float nearW = 1e-3;
+	if (pointA.w < 0.0 || (clipA.w < nearW && clipB.w < nearW))
+	{
+		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+		return;
+	}
+	if (clipA.w < nearW) clipA = mix(clipA, clipB, (nearW - clipA.w) / (clipB.w - clipA.w));
+	if (clipB.w < nearW) clipB = mix(clipB, clipA, (nearW - clipB.w) / (clipA.w - clipB.w));
+
+	startPixel = (clipA.xy / clipA.w * 0.5 + 0.5) * viewport;
+	endPixel = (clipB.xy / clipB.w * 0.5 + 0.5) * viewport;
+	halfWidth = 0.5 * styleWidth[style];
+	lineColor = styleColor[style];
+
+	// Retângulo em volta do segmento, estendido meia largura nas duas pontas: o fragment shader
+	// recorta a cápsula, então as junções e as pontas saem redondas (e um ponto vira um disco)
+	vec2 dir = endPixel - startPixel;
+	float len = length(dir);
+	dir = len > 1e-4 ? dir / len : vec2(1.0, 0.0);
+	vec2 side = vec2(-dir.y, dir.x);
+
+	// Dois triângulos: cantos (0, 1, 2) e (2, 1, 3); bit 0 = ponta, bit 1 = lado
+	const int corners[6] = int[6](0, 1, 2, 2, 1, 3);
+	int corner = corners[gl_VertexID];
+	float along = float(corner & 1);
+	float across = (corner & 2) != 0 ? 1.0 : -1.0;
+	float margin = halfWidth + 1.0;
+	fragPixel = mix(startPixel - dir * margin, endPixel + dir * margin, along) + side * across * margin;
+
+	float depth = mix(clipA.z / clipA.w, clipB.z / clipB.w, along);
+	gl_Position = vec4(fragPixel / viewport * 2.0 - 1.0, depth, 1.0);
+}
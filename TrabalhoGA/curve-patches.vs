@@ -0,0 +1,8 @@
+#version 430
+layout (location = 0) in vec3 positionC;
+
+// Só repassa o ponto de controle (em coordenadas do mundo) para o shader de controle
+void main()
+{
+	gl_Position = vec4(positionC, 1.0);
+}
@@ -1,8 +1,11 @@
 #version 430 
 layout (location = 0) in vec3 positionC;
+
+uniform mat4 projection;
+uniform mat4 view;
  
 void main()
 {
-    gl_Position = vec4(positionC, 1.0f);
+    gl_Position = projection * view * vec4(positionC, 1.0f);
     
 }
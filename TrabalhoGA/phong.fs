@@ -15,8 +15,10 @@ uniform vec3 lightPos, lightColor;
 uniform vec3 cameraPos;
 
 out vec4 color;
-//Buffer da textura
+//Buffer da textura: 2D ou camada texLayer do array (texLayer = -1 usa texBuffer)
 uniform sampler2D texBuffer;
+uniform sampler2DArray texArray;
+uniform int texLayer = -1;
 
 void main()
 {
@@ -40,7 +42,7 @@ void main()
     spec = pow(spec,q);
     specular = ks * spec * lightColor;
 
-    vec4 texColor = texture(texBuffer,texCoord);
+    vec4 texColor = texLayer >= 0 ? texture(texArray,vec3(texCoord,texLayer)) : texture(texBuffer,texCoord);
     vec3 result = (ambient + diffuse) * vec3(texColor) + specular;
 
     color = vec4(result,1.0);